@@ -0,0 +1,40 @@
+#include "ai_lod.h"
+
+#include <algorithm>
+
+int ai_lod_choose_tier(const AI_Lod_Params &params, int current_tier, float distance_to_player, bool visible) {
+	int last_tier 	= std::max(std::min(params.tier_count, ai_lod_max_tiers), 1) - 1;
+	int tier 		= last_tier;
+	for (int i = 0; i < last_tier; ++i) {
+		// Border we are on is moved away from us, so we leave our tier a bit later than we entered it.
+		float max_distance = params.tiers[i].max_distance;
+		if (i >= current_tier) {
+			max_distance += params.hysteresis;
+		} else {
+			max_distance -= params.hysteresis;
+		}
+
+		if (distance_to_player <= max_distance) {
+			tier = i;
+			break;
+		}
+	}
+
+	if (visible) {
+		tier = std::min(tier, params.visible_tier);
+	}
+	return tier;
+}
+
+bool ai_lod_should_update(AI_Lod_State *state, const AI_Lod_Params &params, uint64_t frame, float dt, float *out_dt) {
+	state->accumulated_dt += dt;
+
+	int interval = std::max(params.tiers[state->tier].frame_interval, 1);
+	if ((frame + (uint64_t)state->phase) % (uint64_t)interval != 0) {
+		return false;
+	}
+
+	*out_dt 				= std::min(state->accumulated_dt, params.max_dt);
+	state->accumulated_dt 	= 0;
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// AI level of detail. Bots far from the player think and move less often, with bigger dt, and bots
+// of the same tier are spread over frames (every bot has its own phase), so their updates don't land in one tick.
+// Bots on screen are never below visible_tier, so we don't see them stutter.
+//
+// 	if (ai_lod_should_update(&ai_lod, ai_lod_params, frame, dt, &lod_dt)) { think and move with lod_dt }
+
+#include <stdint.h>
+
+const int ai_lod_max_tiers = 4;
+
+struct AI_Lod_Tier {
+	float 	max_distance 	= 0; // Bots up to this distance are in this tier, last tier takes everyone.
+	int 	frame_interval 	= 1; // Update every Nth frame.
+};
+
+struct AI_Lod_Params {
+	AI_Lod_Tier tiers[ai_lod_max_tiers] = {
+		{2000.0f, 	1},
+		{6000.0f, 	3},
+		{15000.0f, 	8},
+		{0.0f, 		16},
+	};
+	int 	tier_count 		= ai_lod_max_tiers;
+	int 	visible_tier 	= 1; 		// On screen bots are at most this far down.
+	float 	hysteresis 		= 300.0f; 	// So bots on tier border don't switch every frame.
+	float 	max_dt 			= 0.25f; 	// Movement gets unstable with bigger steps, the rest is dropped.
+};
+
+struct AI_Lod_State {
+	int 	tier 			= 0;
+	int 	phase 			= 0; // Frame offset, give every bot a different one.
+	float 	accumulated_dt 	= 0; // Time since last update.
+};
+
+int ai_lod_choose_tier(const AI_Lod_Params &params, int current_tier, float distance_to_player, bool visible);
+
+// Adds dt and says if bot updates this frame. If it does, out_dt is time since its last update.
+bool ai_lod_should_update(AI_Lod_State *state, const AI_Lod_Params &params, uint64_t frame, float dt, float *out_dt);
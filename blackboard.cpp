@@ -0,0 +1,104 @@
+#include "blackboard.h"
+
+Blackboard blackboard;
+
+namespace {
+	Blackboard_Frame *write_frame(Blackboard *board) {
+		return &board->frames[board->write_index];
+	}
+
+	Blackboard_Entity *find_written(Blackboard *board, Blackboard_Handle handle) {
+		Blackboard_Frame *frame = write_frame(board);
+		if (handle.generation == 0 || handle.index >= frame->entities.size() || frame->entities[handle.index].generation != handle.generation) {
+			return nullptr;
+		}
+		return &frame->entities[handle.index];
+	}
+}
+
+Blackboard_Handle blackboard_add(Blackboard *board, Blackboard_Kind kind) {
+	Blackboard_Handle handle;
+	if (!board->free_indices.empty()) {
+		handle.index = board->free_indices.back();
+		board->free_indices.pop_back();
+	} else {
+		handle.index = (uint32_t)board->generations.size();
+		board->generations.push_back(0);
+	}
+
+	uint32_t &generation = board->generations[handle.index];
+	generation 			= generation + 1 == 0 ? 1 : generation + 1;
+	handle.generation 	= generation;
+
+	Blackboard_Frame *frame = write_frame(board);
+	if (frame->entities.size() <= handle.index) {
+		frame->entities.resize(handle.index + 1);
+	}
+	frame->entities[handle.index] 				= Blackboard_Entity();
+	frame->entities[handle.index].generation 	= handle.generation;
+	frame->entities[handle.index].kind 			= kind;
+
+	if (kind == BLACKBOARD_PLAYER) {
+		frame->player = handle;
+	}
+	return handle;
+}
+
+void blackboard_remove(Blackboard *board, Blackboard_Handle handle) {
+	Blackboard_Entity *entity = find_written(board, handle);
+	if (!entity) {
+		return;
+	}
+
+	entity->generation = 0;
+	board->free_indices.push_back(handle.index);
+
+	Blackboard_Frame *frame = write_frame(board);
+	if (frame->player.index == handle.index && frame->player.generation == handle.generation) {
+		frame->player = Blackboard_Handle();
+	}
+}
+
+void blackboard_write_entity(Blackboard *board, Blackboard_Handle handle, Vec3 position, Vec3 velocity) {
+	Blackboard_Entity *entity = find_written(board, handle);
+	if (!entity) {
+		return;
+	}
+	entity->position = position;
+	entity->velocity = velocity;
+}
+
+void blackboard_write_objective(Blackboard *board, Vec3 objective) {
+	write_frame(board)->objective = objective;
+}
+
+bool blackboard_begin_frame(Blackboard *board, uint64_t engine_frame) {
+	if (board->frame == engine_frame) {
+		return false;
+	}
+	board->frame = engine_frame;
+
+	int 				read 		= board->read_index.load(std::memory_order_relaxed);
+	int 				write 		= board->write_index;
+	Blackboard_Frame 	&written 	= board->frames[write];
+	written.engine_frame 	= engine_frame;
+	written.published 		= board->frames[read].published + 1;
+	board->read_index.store(write, std::memory_order_release);
+
+	// Next we write the third frame, nobody took it since the begin_frame before this one (see @note in blackboard.h).
+	// It starts from what we published. Vector keeps its memory, so this doesn't allocate once everybody was added.
+	board->write_index 					= 3 - read - write;
+	board->frames[board->write_index] 	= written;
+	return true;
+}
+
+const Blackboard_Frame &blackboard_read(const Blackboard &board) {
+	return board.frames[board.read_index.load(std::memory_order_acquire)];
+}
+
+const Blackboard_Entity *blackboard_find(const Blackboard_Frame &frame, Blackboard_Handle handle) {
+	if (handle.generation == 0 || handle.index >= frame.entities.size() || frame.entities[handle.index].generation != handle.generation) {
+		return nullptr;
+	}
+	return &frame.entities[handle.index];
+}
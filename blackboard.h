@@ -0,0 +1,78 @@
+#pragma once
+
+// Blackboard: facts about the world (where player and bots are, how fast they go, where bots go) published
+// once per frame, so AI on game thread and jobs on planner workers read the same world whoever ticked first.
+//
+// 	blackboard_begin_frame(&blackboard, GFrameCounter); 					// First thing in every Tick, once per frame.
+// 	blackboard_write_entity(&blackboard, handle, position, velocity); 		// Game thread, goes out next frame.
+//
+// 	const Blackboard_Frame &frame = blackboard_read(blackboard); 			// Any thread.
+// 	if (const Blackboard_Entity *player = blackboard_find(frame, frame.player)) { ... }
+//
+// There are three frames. Game thread writes one while everybody reads another, begin_frame publishes the written
+// one and copies it into the one we write next, so facts nobody wrote this frame stay as they were. Frame we write
+// next is never the one that was read until now, readers that took it just before begin_frame can still be on it.
+// What is read is what the world was at the end of last frame, it doesn't change in the middle of this one.
+//
+// Entities are known by handles: index and generation. Removing an entity bumps its generation, so a
+// handle of somebody who is gone finds nothing instead of somebody else or freed memory.
+//
+// @note: Frame we read is good until the second begin_frame after we took it, after that it's written again.
+// Jobs that live longer than a frame copy what they need, like path requests do.
+
+#include "cd_math.h"
+
+#include <atomic>
+#include <stdint.h>
+#include <vector>
+
+enum Blackboard_Kind : uint32_t {
+	BLACKBOARD_PLAYER,
+	BLACKBOARD_BOT,
+};
+
+struct Blackboard_Handle {
+	uint32_t index 		= 0;
+	uint32_t generation = 0; // Zero is never given out, default handle finds nothing.
+};
+
+struct Blackboard_Entity {
+	uint32_t 		generation 	= 0; // Of the handle it belongs to, zero when nobody has it.
+	Blackboard_Kind kind 		= BLACKBOARD_BOT;
+	Vec3 			position; 	// Collision, not where it is drawn.
+	Vec3 			velocity;
+};
+
+struct Blackboard_Frame {
+	uint64_t 		engine_frame 	= 0; // Published at the start of it.
+	uint64_t 		published 		= 0; // How many frames were published before, readers can check nobody wrote over it.
+	Blackboard_Handle player;
+	Vec3 			objective; 		// Newest objective a bot took, A_Bot::objective_vector.
+	std::vector<Blackboard_Entity> entities; // By handle index.
+};
+
+struct Blackboard {
+	Blackboard_Frame 	frames[3];
+	std::atomic<int> 	read_index{0};
+	int 				write_index = 1; 	// Game thread only.
+	uint64_t 			frame = UINT64_MAX; // Engine frame we published on.
+
+	// Game thread only.
+	std::vector<uint32_t> generations; // Last generation given out for every index.
+	std::vector<uint32_t> free_indices;
+};
+
+extern Blackboard blackboard;
+
+// Game thread. New entity goes out with the next frame, player is also frame.player.
+Blackboard_Handle 	blackboard_add(Blackboard *board, Blackboard_Kind kind);
+void 				blackboard_remove(Blackboard *board, Blackboard_Handle handle);
+void 				blackboard_write_entity(Blackboard *board, Blackboard_Handle handle, Vec3 position, Vec3 velocity);
+void 				blackboard_write_objective(Blackboard *board, Vec3 objective);
+
+// Publishes what was written since last time. Only the first call in a frame does it, returns if it was us.
+bool blackboard_begin_frame(Blackboard *board, uint64_t engine_frame);
+
+// Any thread.
+const Blackboard_Frame 	&blackboard_read(const Blackboard &board);
+const Blackboard_Entity *blackboard_find(const Blackboard_Frame &frame, Blackboard_Handle handle);
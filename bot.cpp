@@ -8,7 +8,31 @@
 #include "EngineUtils.h" // For TActorIterator.
 #include "DrawDebugHelpers.h"
 #include "vector" // For dynamic arrays.
+#include "deque" // Bots keep pointers to their stats.
 #include "Kismet/GameplayStatics.h" // To get real time.
+#include "Engine/LevelBounds.h" // For navigation layers bounds.
+#include "HAL/IConsoleManager.h" // For console commands.
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h" // To make snapshot folder.
+
+#include "blackboard.h"
+#include "collision_query_unreal.h"
+#include "debug_draw_unreal.h"
+#include "determinism.h"
+#include "fixed_step.h"
+#include "kinematic_mover.h"
+#include "lag_compensation.h"
+#include "movement_kernel.h"
+#include "path_search.h"
+#include "path_planner.h"
+#include "search_stats.h"
+#include "trace_recorder.h"
+#include "world_snapshot.h"
+#include "replay.h"
+#include "nav_layers.h"
+#include "nav_jump_links.h"
+#include "objective_prediction.h"
+#include "nav_change_log.h"
 
 #include "cd_core/log.h"
 
@@ -30,40 +54,166 @@ namespace {
 	AActor 					*point_b;
 	FCollisionQueryParams 	collision_parameters_for_path_search;
 
-	FVector 				new_final_point(0);
-	FVector 				current_final_point(0);
-	
-	std::vector<FVector> 	path_point_array;
-
-	bool found_new_final_point 					= false;
-	bool found_path 							= false;
-	bool search_right 							= false;
-	bool rotation_side_direction_was_randomized = false;
-	bool failed_one_side_search					= false;
-
-	struct Walking_Path_Info {
-		// Zero is starting point (bot location), we want to count from 1 (first path point).
-		int 	target_path_point 			= 1;
-		FVector	current_path_point 			= FVector(0);
-		FVector point_forward				= FVector(0);
-		float 	initial_distance_to_point 	= 0;
-		bool 	rotation_direction_right 	= false;
-	} walking_path_info;
-
-	bool ready_to_go_to_path_point 				= false;
-	bool can_simulate_rotation 					= false;
-	bool can_simulate_walking 					= false;
-
-	struct AI_Error_Info {
-		FVector	saved_bot_position					= FVector(0);
-		float 	walking_error_timer 				= 1.0f;
-		float 	walking_error_timer_count 			= 0.0f;
-		bool	position_saved 						= false;
-		int 	failed_to_search_in_some_direction 	= 0;
-	} ai_error_info;
-	
+	// Objective is predicted from player velocity, see objective_prediction.h. How player moves is estimated
+	// once per step for everybody, every bot intercepts it from where it is (A_Bot::objective_prediction).
+	Objective_Estimate 			objective_estimate;
+	Objective_Prediction_Params objective_prediction_params;
+	
+	// Path search itself lives in path_search.h, so it can run without Unreal. Every bot has its own search
+	// and ticket (A_Bot::path_search), config is shared. Random numbers are seeded from our random stream by planner.
+	Path_Search_Config 		path_search_config;
+	Collision_Query_Unreal 	path_search_collision;
+
+	// Searches run on planner workers, bot only submits and takes finished paths.
+	// Every request traces with its own copy of path_search_collision, so bots that spawn later can change it.
+	Path_Planner 	path_planner;
+
+	// All bots together don't trace more than this per frame for path search, nearest and visible bots go first.
+	// Zero turns budget off, then every search runs to the end at once.
+	int32 	ai_traces_per_frame 	= 4000;
+	uint64 	path_planner_frame 		= 0;
+
+	// Far bots think and move less often, see ai_lod.h.
+	AI_Lod_Params 	ai_lod_params;
+	bool 			ai_lod_enabled 		= true;
+	int32 			ai_lod_bot_count 	= 0; // Every bot gets next phase, so bots of one tier are spread over frames.
+
+	FAutoConsoleVariableRef ai_lod_enabled_variable(
+		TEXT("cd.ai_lod"),
+		ai_lod_enabled,
+		TEXT("Update far bots less often. Zero updates every bot every frame."));
+
+	FAutoConsoleVariableRef deterministic_variable(
+		TEXT("cd.deterministic"),
+		determinism.enabled,
+		TEXT("Same input gives the same simulation: no AI LOD, no trace budget, path searches finish before next step. See determinism.h."));
+
+	FAutoConsoleVariableRef ai_traces_per_frame_variable(
+		TEXT("cd.ai_traces_per_frame"),
+		ai_traces_per_frame,
+		TEXT("Path search trace budget per frame, shared by all bots. Zero means no budget."));
+
+	// Layered navigation is shared by all bots and built once per world.
+	Nav_Layer_Grid 	nav_layer_grid;
+	Nav_Blocked_Flags nav_blocked_published; // What planner workers see, grid's own flags change under them.
+	UWorld 			*nav_layer_grid_world 		= nullptr;
+	float 			nav_layer_cell_size 		= 50.0f;
+	int32 			nav_layer_max_cells 		= 512 * 512; // Big levels get bigger cells, so memory and bake time stay sane.
+
+	// Dynamic obstacles. Navigation layers are baked without them, their moves go to the change log,
+	// and bots replan only if their path crosses a dirty region.
+	FCollisionQueryParams 							nav_bake_parameters;
+	Nav_Change_Log 									nav_change_log;
+	Nav_Obstacle_Tracker 							nav_obstacle_tracker;
+	std::vector<TWeakObjectPtr<UPrimitiveComponent>> dynamic_obstacle_components;
+	uint64 											dynamic_obstacles_update_frame 	= 0;
+	uint32 											nav_layers_revision 			= 0; // Change log revision navigation layers are up to date with.
+	std::vector<Box3> 								dirty_regions;
+	std::vector<Box3> 								obstacles_in_region;
+
+	// Path search counters per bot, by actor name. See search_stats.h.
+	// Deque, so bots' pointers stay good when new bots add theirs. Stats of bots that left stay for reports.
+	std::deque<Search_Stats> bot_search_stats;
+
+	Search_Stats *find_bot_search_stats(const FString &name) {
+		std::string bot_name = TCHAR_TO_UTF8(*name);
+		for (Search_Stats &stats : bot_search_stats) {
+			if (stats.name == bot_name) {
+				return &stats;
+			}
+		}
+
+		bot_search_stats.push_back(Search_Stats());
+		bot_search_stats.back().name = bot_name;
+		return &bot_search_stats.back();
+	}
+
+	// cd.bot_search_stats 		- print stats of every bot,
+	// cd.bot_search_stats reset 	- forget everything,
+	// cd.bot_search_stats csv 	- write Saved/bot_search_stats.csv and Saved/bot_search_histograms.csv.
+	void bot_search_stats_command(const TArray<FString> &arguments) {
+		if (arguments.Num() > 0 && arguments[0] == TEXT("reset")) {
+			for (Search_Stats &stats : bot_search_stats) {
+				search_stats_reset(&stats);
+			}
+			UE_LOG(Log_CD_Core, Log, TEXT("Bot search stats were reset."));
+			return;
+		}
+
+		if (arguments.Num() > 0 && arguments[0] == TEXT("csv")) {
+			std::vector<const Search_Stats *> all_stats;
+			for (const Search_Stats &stats : bot_search_stats) {
+				all_stats.push_back(&stats);
+			}
+
+			FString summary_path 	= FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("bot_search_stats.csv"));
+			FString histogram_path 	= FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("bot_search_histograms.csv"));
+			if (search_stats_write_csv(all_stats, TCHAR_TO_UTF8(*summary_path), TCHAR_TO_UTF8(*histogram_path))) {
+				UE_LOG(Log_CD_Core, Log, TEXT("Bot search stats were written to %s and %s"), *summary_path, *histogram_path);
+			} else {
+				UE_LOG(Log_CD_Core, Log, TEXT("Couldn't write bot search stats to %s"), *summary_path);
+			}
+			return;
+		}
+
+		std::vector<std::string> lines;
+		for (const Search_Stats &stats : bot_search_stats) {
+			search_stats_report(stats, &lines);
+		}
+		lines.push_back(TCHAR_TO_UTF8(*FString::Printf(TEXT("Planner last frame: %d traces given, %d deferred requests, %llu traces used before it."),
+			path_planner.frame_traces_given, path_planner.frame_deferred, (unsigned long long)path_planner.frame_traces_used)));
+		for (const std::string &line : lines) {
+			UE_LOG(Log_CD_Core, Log, TEXT("%s"), UTF8_TO_TCHAR(line.c_str()));
+		}
+	}
+
+	FAutoConsoleCommand bot_search_stats_console_command(
+		TEXT("cd.bot_search_stats"),
+		TEXT("Path search counters per bot. No arguments prints them, \"reset\" clears them, \"csv\" writes them to Saved folder."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&bot_search_stats_command));
+
+	// cd.determinism_hashes 			- write Saved/determinism_hashes.csv,
+	// cd.determinism_hashes compare file - first step where this run differs from hashes in that file.
+	void determinism_hashes_command(const TArray<FString> &arguments) {
+		if (arguments.Num() > 1 && arguments[0] == TEXT("compare")) {
+			Determinism_Log other;
+			if (!determinism_log_read_csv(&other, TCHAR_TO_UTF8(*arguments[1]))) {
+				UE_LOG(Log_CD_Core, Log, TEXT("Couldn't read %s"), *arguments[1]);
+				return;
+			}
+
+			int64_t step = determinism_log_first_divergence(determinism.log, other);
+			if (step < 0) {
+				UE_LOG(Log_CD_Core, Log, TEXT("Same hashes in all %d steps both runs have."), (int32)FMath::Min(determinism.log.step_hashes.size(), other.step_hashes.size()));
+			} else {
+				UE_LOG(Log_CD_Core, Log, TEXT("Runs diverged at step %lld."), (long long)step);
+			}
+			return;
+		}
+
+		FString path = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("determinism_hashes.csv"));
+		if (determinism_log_write_csv(determinism.log, TCHAR_TO_UTF8(*path))) {
+			UE_LOG(Log_CD_Core, Log, TEXT("%d step hashes were written to %s"), (int32)determinism.log.step_hashes.size(), *path);
+		} else {
+			UE_LOG(Log_CD_Core, Log, TEXT("Couldn't write step hashes to %s"), *path);
+		}
+	}
+
+	FAutoConsoleCommand determinism_hashes_console_command(
+		TEXT("cd.determinism_hashes"),
+		TEXT("Step state hashes of cd.deterministic run. No arguments writes them to Saved folder, \"compare file\" finds first step that differs."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&determinism_hashes_command));
+
+	// Workers can't draw, so path is drawn when it arrives.
+	void draw_planned_path(const Path_Search &search, float collision_height) {
+		for (size_t i = 1; i < search.path_points.size(); ++i) {
+			Vec3 point = search.path_points[i];
+			debug_line(DEBUG_DRAW_PATH, Vec3(point.x, point.y, point.z - collision_height), Vec3(point.x, point.y, point.z + collision_height), 0xE450A2, true);
+			debug_line(DEBUG_DRAW_PATH, search.path_points[i - 1], point, 0x47E2EF, true);
+		}
+	}
+
 	// Camera move variables.
-	FBodyInstance 	*collision_physics;
 	FVector 		camera_offset(0.0f, 0.0f, 70.0f);
 	FVector 		camera_forward_vector;
 	FVector 		camera_backward_vector;
@@ -79,33 +229,162 @@ namespace {
 	float 						mouse_user_sensitivity_x		= 1.0f;
 	float 						mouse_user_sensitivity_y		= 1.0f;
 	float 						mouse_camera_smoothness			= 1.0f; // @note: I don't use camera smoothing. Works without delta time, 1.0 means no smoothing.
-	FRotator 					camera_euler_rotation(0);
 	FRotationConversionCache 	camera_rotation_conversion;	// @note: This is for optimization, I probably don't use it fully.
 	
 	// Bot move variables.
 	FRotationConversionCache 	collision_rotation_conversion; // @note: This is for optimization, I probably don't use it fully.
 	
-	// @todo: rename these to speed.
-	float			max_walking_speed		= 2400.0f;
-	float 			forward_force 			= 2400.0f;
-	float 			backward_force 			= 2400.0f;
-	float 			right_force 			= 2400.0f;
-	float 			left_force 				= 2400.0f;
-	float 			jump_force 				= 3700.0f; 	// Default gravity Z is -980.0
-	float 			gravity_extra_force 	= 1077.0f; 	// I make gravity stronger by adding extra force.
+	// Walking speeds, jump, extra gravity and drags, see movement_kernel.h.
+	// @todo: rename forces to speed.
+	Movement_Params movement_params;
 	
-	float 			drag_walking_force		= 1.3f; // Drag walking should be less than stopping.
-	float 			drag_stop_walking_force = 3.2f;
-	
-	bool 			is_walking = false;	// Right now I control this by key input and not by checking bot velocity.
-	
-	bool 			mass_has_no_effect = true;
-	
-	// @note: Hardcoded vectors for move input keys on unit circle.
-	FVector			move_forward_xy		(0,1,0);
-	FVector			move_backward_xy	(0,-1,0);
-	FVector			move_right_xy		(1,0,0);
-	FVector			move_left_xy		(-1,0,0);
+	float 			max_jump_hold_time = 0.3f; // Bot doesn't hold jump longer than this, jump links are baked with it.
+
+	// Bot collision is kinematic, every bot keeps its own mover state (A_Bot::mover), sweeps ignore only that bot.
+	Kinematic_Mover_Params 	mover_params;
+	Collision_Query_Unreal 	mover_collision;
+
+	// Every bot that moved this step has a slot here. Impulses are made for all of them at once, then everybody is moved.
+	Movement_Batch 		movement_batch;
+	TArray<A_Bot *> 	movement_bots; // Bot of every slot.
+
+	void apply_bot_movement() {
+		movement_batch_run(movement_params, &movement_batch);
+		for (int i = 0; i < movement_batch.count; ++i) {
+			A_Bot *bot = movement_bots[i];
+			bot->mover.velocity += Vec3(movement_batch.impulse_x[i], movement_batch.impulse_y[i], movement_batch.impulse_z[i]);
+
+			mover_collision.parameters = FCollisionQueryParams(FName(TEXT("bot_mover")), false, bot);
+			kinematic_mover_move(mover_collision, mover_params, &bot->mover, movement_batch.dt[i]);
+			bot->collision_box->SetRelativeLocation(to_fvector(bot->mover.position));
+		}
+
+		movement_batch_clear(&movement_batch);
+		movement_bots.Reset();
+	}
+
+	// Bots think and move in fixed steps (fixed_step.h). First bot that ticks in a frame runs this frame's steps
+	// for all of them, every step is one movement batch, so next step starts from where the last one moved us.
+	TArray<A_Bot *> bots;
+	uint64 			bots_simulated_frame = 0;
+	uint64_t 		thinking_step 		 = 0; // Step simulate_step() runs, replay keeps objectives by it.
+
+	// Everything bots decide with.
+	uint64_t hash_bots() {
+		State_Hash hash;
+		for (A_Bot *bot : bots) {
+			state_hash_int(&hash, (int64_t)bot->determinism_id);
+			state_hash_vec3(&hash, bot->mover.position);
+			state_hash_vec3(&hash, bot->mover.velocity);
+			state_hash_int(&hash, bot->mover.grounded);
+			state_hash_int(&hash, (int64_t)bot->random.state);
+			state_hash_int(&hash, bot->is_move_forward_pressed | bot->is_move_backward_pressed << 1 | bot->is_move_right_pressed << 2 | bot->is_move_left_pressed << 3 | bot->is_jump_pressed << 4);
+
+			state_hash_int(&hash, bot->path_search.found_path);
+			state_hash_int(&hash, (int64_t)bot->path_search.path_points.size());
+			for (Vec3 point : bot->path_search.path_points) {
+				state_hash_vec3(&hash, point);
+			}
+			state_hash_int(&hash, bot->walking_path_info.target_path_point);
+			state_hash_float(&hash, bot->walking_path_info.jump_hold_time_left);
+			state_hash_int(&hash, bot->ready_to_go_to_path_point | bot->can_simulate_rotation << 1 | bot->can_simulate_walking << 2 | bot->is_walking << 3);
+			state_hash_vec3(&hash, to_vec3(bot->current_final_point));
+			state_hash_vec3(&hash, to_vec3(bot->objective));
+			state_hash_float(&hash, bot->camera_euler_rotation.Yaw);
+			state_hash_float(&hash, bot->camera_euler_rotation.Pitch);
+		}
+		return hash.value;
+	}
+
+	// Player as everybody sees it this frame: where it was at the end of last one, see blackboard.h.
+	// Zero while there is no player, like before one spawned.
+	Blackboard_Entity published_player() {
+		const Blackboard_Frame &frame 	= blackboard_read(blackboard);
+		const Blackboard_Entity *player = blackboard_find(frame, frame.player);
+		return player ? *player : Blackboard_Entity();
+	}
+
+	void simulate_bots(int steps) {
+		trace_scope("simulate_bots");
+
+		for (int i = 0; i < steps; ++i) {
+			uint64_t step = simulation_clock.first_step_this_frame + i;
+			objective_estimate_update(&objective_estimate, objective_prediction_params, published_player().velocity, simulation_clock.params.step_dt);
+			for (A_Bot *bot : bots) {
+				bot->simulate_step(step);
+			}
+
+			apply_bot_movement();
+
+			for (A_Bot *bot : bots) {
+				interpolated_position_push(&bot->interpolation, bot->mover.position);
+				lag_history_add(&lag_history, step, bot->determinism_id, bot->mover.position, mover_params.half_extents);
+				blackboard_write_entity(&blackboard, bot->blackboard_handle, bot->mover.position, bot->mover.velocity);
+			}
+
+			if (determinism.enabled) {
+				// Paths are taken on next step whatever workers' timing was.
+				path_planner_wait(&path_planner);
+				determinism_log_add(&determinism.log, step, hash_bots());
+			}
+		}
+	}
+
+	// World snapshot (world_snapshot.h): player, every bot, path all bots follow and dynamic obstacles.
+	uint64_t prop_id(UPrimitiveComponent *component) {
+		FString name = component->GetOwner() ? component->GetOwner()->GetName() + TEXT(".") + component->GetName() : component->GetName();
+		return determinism_id_from_name(TCHAR_TO_UTF8(*name));
+	}
+
+	FString snapshot_path(const TArray<FString> &arguments) {
+		FString name = arguments.Num() > 0 ? arguments[0] : TEXT("checkpoint");
+		return FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("Snapshots") / name + TEXT(".snapshot"));
+	}
+
+	// cd.snapshot_save [name] 	- write Saved/Snapshots/name.snapshot, "checkpoint" if there is no name,
+	// cd.snapshot_load [name] 	- put the world back to it.
+	void snapshot_save_command(const TArray<FString> &arguments) {
+		double start = FPlatformTime::Seconds();
+
+		World_Snapshot snapshot;
+		A_Bot::save_world_snapshot(&snapshot);
+
+		FString path = snapshot_path(arguments);
+		IFileManager::Get().MakeDirectory(*FPaths::GetPath(path), true);
+		if (!world_snapshot_write(snapshot, TCHAR_TO_UTF8(*path))) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Couldn't write snapshot to %s"), *path);
+			return;
+		}
+
+		UE_LOG(Log_CD_Core, Log, TEXT("Snapshot of step %llu with %d bots and %d props was written to %s in %.3f ms."),
+			(unsigned long long)snapshot.step, (int32)snapshot.pawns.size(), (int32)snapshot.props.size(), *path, (FPlatformTime::Seconds() - start) * 1000.0);
+	}
+
+	void snapshot_load_command(const TArray<FString> &arguments) {
+		double start = FPlatformTime::Seconds();
+
+		FString path = snapshot_path(arguments);
+		World_Snapshot_File file;
+		if (!world_snapshot_open(&file, TCHAR_TO_UTF8(*path))) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Couldn't load snapshot %s: %s"), *path, UTF8_TO_TCHAR(file.view.error));
+			return;
+		}
+
+		A_Bot::load_world_snapshot(file.view);
+		world_snapshot_close(&file);
+
+		UE_LOG(Log_CD_Core, Log, TEXT("Snapshot %s of step %llu was loaded in %.3f ms."), *path, (unsigned long long)simulation_clock.step_index, (FPlatformTime::Seconds() - start) * 1000.0);
+	}
+
+	FAutoConsoleCommand snapshot_save_console_command(
+		TEXT("cd.snapshot_save"),
+		TEXT("Write player, bots, their path and dynamic obstacles to Saved/Snapshots/name.snapshot. See world_snapshot.h."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&snapshot_save_command));
+
+	FAutoConsoleCommand snapshot_load_console_command(
+		TEXT("cd.snapshot_load"),
+		TEXT("Put the world back to Saved/Snapshots/name.snapshot."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&snapshot_load_command));
 	
 	struct Bot_State {
 		FVector position = FVector(0);
@@ -114,6 +393,168 @@ namespace {
 	} bot_state;
 }
 
+void A_Bot::save_world_snapshot(World_Snapshot *snapshot) {
+	*snapshot 		= World_Snapshot();
+	snapshot->step 	= simulation_clock.step_index;
+	snapshot->seed 	= determinism.seed;
+
+	if (A_Player *hero = Cast<A_Player>(A_Player::player.Get())) {
+		hero->save_snapshot(snapshot);
+	}
+
+	for (A_Bot *bot : bots) {
+		Snapshot_Pawn pawn;
+		pawn.id 				= bot->determinism_id;
+		pawn.random_state 		= bot->random.state;
+		pawn.position 			= bot->mover.position;
+		pawn.velocity 			= bot->mover.velocity;
+		pawn.ground_normal 		= bot->mover.ground_normal;
+		pawn.grounded 			= bot->mover.grounded;
+		pawn.yaw 				= bot->camera_euler_rotation.Yaw;
+		pawn.pitch 				= bot->camera_euler_rotation.Pitch;
+		pawn.lod_tier 			= bot->ai_lod.tier;
+		pawn.lod_phase 			= bot->ai_lod.phase;
+		pawn.lod_accumulated_dt = bot->ai_lod.accumulated_dt;
+		pawn.objective 			= (int32_t)snapshot->objectives.size();
+		if (bot->is_walking) {
+			pawn.flags |= SNAPSHOT_WALKING;
+		}
+		if (bot->is_move_forward_pressed) 	pawn.buttons |= MOVEMENT_FORWARD;
+		if (bot->is_move_backward_pressed) 	pawn.buttons |= MOVEMENT_BACKWARD;
+		if (bot->is_move_right_pressed) 	pawn.buttons |= MOVEMENT_RIGHT;
+		if (bot->is_move_left_pressed) 		pawn.buttons |= MOVEMENT_LEFT;
+		if (bot->is_jump_pressed) 			pawn.buttons |= MOVEMENT_JUMP;
+		snapshot->pawns.push_back(pawn);
+		snapshot->objectives.push_back({to_vec3(bot->objective), to_vec3(bot->objective)});
+
+		std::vector<Snapshot_Path_Jump> jumps;
+		for (const Path_Jump &jump : bot->path_search.jumps) {
+			jumps.push_back({jump.path_point_index, jump.hold_time});
+		}
+		Snapshot_Path *path = world_snapshot_add_path(snapshot, bot->path_search.path_points.data(), (int)bot->path_search.path_points.size(),
+			bot->path_search.goal_points.data(), (int)bot->path_search.goal_points.size(), jumps.data(), (int)jumps.size());
+		path->pawn_id 				= bot->determinism_id;
+		path->target_point 			= bot->walking_path_info.target_path_point;
+		path->goal 					= to_vec3(bot->current_final_point);
+		path->jump_hold_time_left 	= bot->walking_path_info.jump_hold_time_left;
+		if (bot->path_search.found_path) {
+			path->flags |= SNAPSHOT_PATH_FOUND;
+		}
+	}
+
+	for (const TWeakObjectPtr<UPrimitiveComponent> &weak_component : dynamic_obstacle_components) {
+		UPrimitiveComponent *component = weak_component.Get();
+		if (!component) {
+			continue;
+		}
+
+		Snapshot_Prop prop;
+		prop.id 				= prop_id(component);
+		prop.position 			= to_vec3(component->GetComponentLocation());
+		prop.rotation 			= to_quat(component->GetComponentQuat());
+		prop.linear_velocity 	= to_vec3(component->GetPhysicsLinearVelocity());
+		prop.angular_velocity 	= to_vec3(component->GetPhysicsAngularVelocityInDegrees());
+		snapshot->props.push_back(prop);
+	}
+}
+
+// Bots that are not in the snapshot stay where they are, like props.
+void A_Bot::load_world_snapshot(const World_Snapshot_View &view) {
+	if (A_Player *hero = Cast<A_Player>(A_Player::player.Get())) {
+		hero->load_snapshot(view);
+	}
+
+	// How player moves is learned again, bots' predictions start again in reset_ai_logic().
+	objective_estimate = Objective_Estimate();
+	if (view.objective_count > 0) {
+		A_Bot::objective_vector = to_fvector(view.objectives[0].position);
+		blackboard_write_objective(&blackboard, view.objectives[0].position);
+	}
+
+	for (A_Bot *bot : bots) {
+		const Snapshot_Pawn *pawn = world_snapshot_find_pawn(view, bot->determinism_id);
+		if (!pawn) {
+			continue;
+		}
+
+		// Walking to the target point starts again from the bot's position (simulate_input()).
+		// Snapshots from before bots had their own paths have one path with pawn_id 0, everybody takes it.
+		bot->reset_ai_logic();
+		bot->objective = pawn->objective >= 0 && pawn->objective < view.objective_count ? to_fvector(view.objectives[pawn->objective].position) : A_Bot::objective_vector;
+		const Snapshot_Path *path = world_snapshot_find_path(view, bot->determinism_id);
+		if (!path) {
+			path = world_snapshot_find_path(view, 0);
+		}
+		if (path) {
+			Path_Search &search = bot->path_search;
+			search.path_points.assign(view.path_points + path->first_point, view.path_points + path->first_point + path->point_count);
+			search.goal_points.assign(view.path_points + path->first_goal_point, view.path_points + path->first_goal_point + path->goal_point_count);
+			for (uint32_t i = 0; i < path->jump_count; ++i) {
+				Path_Jump jump;
+				jump.path_point_index 	= view.path_jumps[path->first_jump + i].path_point_index;
+				jump.hold_time 			= view.path_jumps[path->first_jump + i].hold_time;
+				search.jumps.push_back(jump);
+			}
+
+			search.found_path 		= (path->flags & SNAPSHOT_PATH_FOUND) != 0 && path->target_point >= 1 && path->target_point < (int)search.path_points.size();
+			bot->current_final_point 	= to_fvector(path->goal);
+			bot->new_final_point 		= bot->current_final_point;
+			bot->walking_path_info.target_path_point 	= search.found_path ? path->target_point : 1;
+			bot->walking_path_info.jump_hold_time_left 	= path->jump_hold_time_left;
+		}
+
+		bot->mover.position 		= pawn->position;
+		bot->mover.velocity 		= pawn->velocity;
+		bot->mover.ground_normal 	= pawn->ground_normal;
+		bot->mover.grounded 		= pawn->grounded != 0;
+		blackboard_write_entity(&blackboard, bot->blackboard_handle, bot->mover.position, bot->mover.velocity);
+		bot->random.state 			= pawn->random_state;
+		bot->ai_lod.tier 			= pawn->lod_tier;
+		bot->ai_lod.phase 			= pawn->lod_phase;
+		bot->ai_lod.accumulated_dt 	= pawn->lod_accumulated_dt;
+
+		bot->is_move_forward_pressed 	= (pawn->buttons & MOVEMENT_FORWARD) != 0;
+		bot->is_move_backward_pressed 	= (pawn->buttons & MOVEMENT_BACKWARD) != 0;
+		bot->is_move_right_pressed 		= (pawn->buttons & MOVEMENT_RIGHT) != 0;
+		bot->is_move_left_pressed 		= (pawn->buttons & MOVEMENT_LEFT) != 0;
+		bot->is_jump_pressed 			= (pawn->buttons & MOVEMENT_JUMP) != 0;
+
+		bot->camera_euler_rotation 	= FRotator(pawn->pitch, pawn->yaw, 0);
+		bot->is_walking 			= (pawn->flags & SNAPSHOT_WALKING) != 0;
+
+		bot->collision_box->SetRelativeLocation(to_fvector(bot->mover.position));
+		interpolated_position_reset(&bot->interpolation, bot->mover.position);
+	}
+
+	for (const TWeakObjectPtr<UPrimitiveComponent> &weak_component : dynamic_obstacle_components) {
+		UPrimitiveComponent *component = weak_component.Get();
+		if (!component) {
+			continue;
+		}
+
+		uint64_t id = prop_id(component);
+		for (int i = 0; i < view.prop_count; ++i) {
+			const Snapshot_Prop &prop = view.props[i];
+			if (prop.id != id) {
+				continue;
+			}
+
+			component->SetWorldLocationAndRotation(to_fvector(prop.position), to_fquat(prop.rotation), false, nullptr, ETeleportType::TeleportPhysics);
+			if (component->IsSimulatingPhysics()) {
+				component->SetPhysicsLinearVelocity(to_fvector(prop.linear_velocity));
+				component->SetPhysicsAngularVelocityInDegrees(to_fvector(prop.angular_velocity));
+			}
+			break;
+		}
+	}
+
+	// Simulation goes on from the step it was saved after, histories of the world we left are gone.
+	fixed_step_reset(&simulation_clock);
+	simulation_clock.step_index = view.header->step;
+	determinism_log_clear(&determinism.log);
+	lag_history_init(&lag_history, 64);
+}
+
 A_Bot::A_Bot(const FObjectInitializer &ObjectInitializer) : Super(ObjectInitializer) {
 	root = ObjectInitializer.CreateDefaultSubobject<USceneComponent>(this, TEXT("Root Component"));
 	SetRootComponent(root);
@@ -130,25 +571,17 @@ A_Bot::A_Bot(const FObjectInitializer &ObjectInitializer) : Super(ObjectInitiali
 	
 	bool is_registered_and_collides = true;
 	collision_box->SetBoxExtent(collision_bounds, is_registered_and_collides);
-	collision_box->SetSimulatePhysics(true);
-	
-	// Get adress of a struct that we can use for physical manipulations. 
-	collision_physics = collision_box->GetBodyInstance();
-	
-	// We will lock X and Y rotation of collision, so that our collision
-	// box wouldn't fall on the ground.
-	collision_physics->bLockYRotation = 1;
-	collision_physics->bLockXRotation = 1;
-	
-	collision_physics->LinearDamping = 0; // I use my own drag forces.
 
-	// @hack: I use this so that my collision wouldn't rotate after given it a walking impulse.
-	collision_physics->InertiaTensorScale = FVector(10000.0f);
+	// We move collision ourselves with sweeps (kinematic_mover.h), physics doesn't simulate it.
+	// Location is absolute, so relative location is world location, like it was with simulated body.
+	collision_box->SetSimulatePhysics(false);
+	collision_box->SetUsingAbsoluteLocation(true);
 
-	collision_box->SetCollisionProfileName(UCollisionProfile::PhysicsActor_ProfileName);
+	collision_box->SetCollisionProfileName(UCollisionProfile::Pawn_ProfileName);
 	collision_box->SetShouldUpdatePhysicsVolume(true);
-	//collision_box->bDynamicObstacle = true;
-	//collision_box->SetCanEverAffectNavigation(false);
+	// We are moving collision, so we don't want to be baked into navigation.
+	collision_box->bDynamicObstacle = true;
+	collision_box->SetCanEverAffectNavigation(false);
 	//collision_box->CanCharacterStepUpOn = ECB_No;
 	
 	camera = ObjectInitializer.CreateDefaultSubobject<UCameraComponent>(this, TEXT("Camera"));
@@ -195,6 +628,8 @@ void A_Bot::BeginPlay() {
 	// Reset this camera vector cache for now.
 	camera_euler_rotation = FRotator(0);
 
+	search_stats = find_bot_search_stats(GetName());
+
 	for (TActorIterator<AActor> actor_iterator(GetWorld()); actor_iterator; ++actor_iterator) {
 		//AActor *actor = *actor_iterator;
 
@@ -217,23 +652,240 @@ void A_Bot::BeginPlay() {
 	// AI stuff:
 	// Ignore some collisions.
 	collision_parameters_for_path_search.AddIgnoredActor(this); // Ignore bot collision.
-	collision_parameters_for_path_search.AddIgnoredActor(A_Player::player); 
+	if (A_Player::player.IsValid()) {
+		collision_parameters_for_path_search.AddIgnoredActor(A_Player::player.Get());
+	}
 	reset_ai_logic();
+
+	ai_lod 			= AI_Lod_State();
+	ai_lod.phase 	= ai_lod_bot_count++;
+
+	// Same bots update in the same order every run.
+	determinism_id 	= determinism_id_from_name(TCHAR_TO_UTF8(*GetName()));
+	random 			= random_stream_make(determinism.seed, determinism_id);
+	bots.Add(this);
+	blackboard_handle = blackboard_add(&blackboard, BLACKBOARD_BOT);
+	bots.Sort([](const A_Bot &a, const A_Bot &b) { return a.determinism_id < b.determinism_id; });
+
+	mover_collision.world 		= GetWorld();
+	mover_collision.channel 	= ECC_Pawn;
+	mover_params.half_extents 	= to_vec3(collision_bounds);
+	mover_params.gravity 		= GetWorld()->GetGravityZ();
+
+	mover 			= Kinematic_Mover_State();
+	mover.position 	= to_vec3(collision_box->GetComponentLocation());
+	mover_collision.parameters = FCollisionQueryParams(FName(TEXT("bot_mover")), false, this);
+	kinematic_mover_snap_to_ground(mover_collision, mover_params, &mover, mover_params.ground_snap_distance);
+	collision_box->SetRelativeLocation(to_fvector(mover.position));
+	interpolated_position_reset(&interpolation, mover.position);
+
+	path_search_collision.world 		= GetWorld();
+	path_search_collision.parameters 	= collision_parameters_for_path_search;
+	path_search_collision.lock_scene 	= true; // Planner workers trace while we move collision, see collision_query_unreal.h.
+
+	path_search_config.collision_size 	= collision_size;
+	path_search_config.collision_height = collision_height;
+	path_search_config.layers 			= &nav_layer_grid;
+	path_search_config.user 			= GetWorld();
+
+	// Config is copied into every request, so it's fine that every bot sets it again.
+	path_planner.config = path_search_config;
+	if (!path_planner_running(path_planner)) {
+		path_planner_start(&path_planner, 0);
+	}
+
+	collect_dynamic_obstacles();
+
+	// Speed bot really walks with: walking impulse is balanced by drag.
+	objective_prediction_params.bot_speed = FMath::Min(movement_params.forward_force, movement_params.max_walking_speed) / movement_params.drag_walking_force;
+
+	build_navigation_layers();
+}
+
+void A_Bot::EndPlay(const EEndPlayReason::Type end_play_reason) {
+	// Steps are run inside one tick, so we are never left in movement batch.
+	bots.Remove(this);
+	blackboard_remove(&blackboard, blackboard_handle);
+	blackboard_handle = Blackboard_Handle();
+
+	if (path_ticket != 0) {
+		path_planner_cancel(&path_planner, path_ticket);
+		path_ticket = 0;
+	}
+
+	// Workers trace this world, so they are stopped when the last bot leaves it, whatever the reason.
+	// Bots that are left keep planning.
+	if (bots.Num() == 0 && path_planner_running(path_planner)) {
+		path_planner_stop(&path_planner);
+	}
+
+	Super::EndPlay(end_play_reason);
+}
+
+void A_Bot::build_navigation_layers() {
+	// First bot in the world bakes layers for everyone.
+	// @note: Global variables survive map restart in editor, so we compare the world too.
+	if (nav_layer_grid.built && nav_layer_grid_world == GetWorld()) {
+		return;
+	}
+
+	FBox level_bounds = ALevelBounds::CalculateLevelBounds(GetWorld()->PersistentLevel);
+	if (!level_bounds.IsValid) {
+		UE_LOG(Log_CD_Core, Log, TEXT("Level has no bounds, navigation layers were not built."));
+		return;
+	}
+
+	FVector level_size 	= level_bounds.GetSize();
+	float 	cell_size 	= nav_layer_cell_size;
+	float 	cell_count 	= (level_size.X / cell_size) * (level_size.Y / cell_size);
+	if (cell_count > nav_layer_max_cells) {
+		cell_size *= FMath::Sqrt(cell_count / nav_layer_max_cells);
+	}
+
+	Nav_Agent agent;
+	agent.radius = collision_size;
+	agent.height = collision_height * 2;
+
+	// Layers are baked without dynamic obstacles.
+	Collision_Query_Unreal bake_collision;
+	bake_collision.world 		= GetWorld();
+	bake_collision.parameters 	= nav_bake_parameters;
+
+	// Jump arcs are baked from the same constants move_bot() uses.
+	Nav_Jump_Params jump_params;
+	jump_params.walk_acceleration 	= FMath::Min(movement_params.forward_force, movement_params.max_walking_speed);
+	jump_params.walk_drag 			= movement_params.drag_walking_force;
+	jump_params.jump_acceleration 	= movement_params.jump_force;
+	jump_params.gravity 			= -GetWorld()->GetGravityZ() + movement_params.gravity_extra_force;
+	jump_params.max_hold_time 		= max_jump_hold_time;
+
+	double start_time = FPlatformTime::Seconds();
+	nav_layers_build(&nav_layer_grid, bake_collision, Box3{to_vec3(level_bounds.Min), to_vec3(level_bounds.Max)}, cell_size, agent);
+	int jump_link_count = nav_jump_links_build(&nav_layer_grid, bake_collision, jump_params);
+	nav_layer_grid_world = GetWorld();
+	nav_blocked_published = nav_layers_publish_blocked(nav_layer_grid);
+
+	UE_LOG(Log_CD_Core, Log, TEXT("Navigation layers: %d x %d cells of %.1f cm, %d surfaces, %d links (%d jumps), took %.3f seconds."),
+		nav_layer_grid.size_x, nav_layer_grid.size_y, cell_size, (int32)nav_layer_grid.surfaces.size(), (int32)nav_layer_grid.links.size(), jump_link_count, FPlatformTime::Seconds() - start_time);
+}
+
+void A_Bot::collect_dynamic_obstacles() {
+	// Same world check as in build_navigation_layers(), first bot collects for everyone.
+	if (nav_layer_grid.built && nav_layer_grid_world == GetWorld()) {
+		return;
+	}
+
+	dynamic_obstacle_components.clear();
+	nav_obstacle_tracker 	= Nav_Obstacle_Tracker();
+	nav_change_log 			= Nav_Change_Log();
+	nav_layers_revision 	= 0;
+	nav_bake_parameters 	= collision_parameters_for_path_search;
+
+	// Anything movable that blocks our rays and is not a pawn is a dynamic obstacle: doors, crates, platforms.
+	// Pawns are ignored by path search anyway.
+	for (TActorIterator<AActor> actor_iterator(GetWorld()); actor_iterator; ++actor_iterator) {
+		if (actor_iterator->IsA<APawn>()) {
+			continue;
+		}
+
+		TArray<UPrimitiveComponent *> components;
+		actor_iterator->GetComponents<UPrimitiveComponent>(components);
+
+		for (UPrimitiveComponent *component : components) {
+			if (component->Mobility != EComponentMobility::Movable || !component->IsQueryCollisionEnabled()
+				|| component->GetCollisionResponseToChannel(ECC_Visibility) != ECR_Block) {
+				continue;
+			}
+
+			dynamic_obstacle_components.push_back(component);
+			nav_bake_parameters.AddIgnoredComponent(component);
+		}
+	}
+
+	UE_LOG(Log_CD_Core, Log, TEXT("Dynamic obstacles: %d."), (int32)dynamic_obstacle_components.size());
+}
+
+void A_Bot::update_dynamic_obstacles() {
+	trace_scope("A_Bot::update_dynamic_obstacles");
+
+	// All bots share obstacles, so it's done once per frame by whoever ticks first.
+	if (dynamic_obstacles_update_frame == GFrameCounter) {
+		return;
+	}
+	dynamic_obstacles_update_frame = GFrameCounter;
+
+	for (size_t i = 0; i < dynamic_obstacle_components.size(); ++i) {
+		UPrimitiveComponent *component 	= dynamic_obstacle_components[i].Get();
+		uint64 				id 			= (uint64)i;
+
+		if (!component || !component->IsQueryCollisionEnabled()) {
+			nav_obstacle_tracker_remove(&nav_obstacle_tracker, &nav_change_log, id);
+			continue;
+		}
+
+		FBox bounds = component->Bounds.GetBox();
+		nav_obstacle_tracker_update(&nav_obstacle_tracker, &nav_change_log, id, Box3{to_vec3(bounds.Min), to_vec3(bounds.Max)});
+	}
+
+	// Update only parts of navigation layers that changed.
+	if (nav_layer_grid.built && nav_layers_revision != nav_change_log.revision) {
+		nav_change_log_collect(nav_change_log, nav_layers_revision, &dirty_regions);
+		int changed = 0;
+		for (const Box3 &region : dirty_regions) {
+			nav_obstacle_tracker_query(nav_obstacle_tracker, region, &obstacles_in_region);
+			changed += nav_layers_update_blocked(&nav_layer_grid, region, obstacles_in_region);
+		}
+		nav_layers_revision = nav_change_log.revision;
+
+		// Workers may be reading the copy we published before, they keep it until their search is done.
+		if (changed > 0) {
+			nav_blocked_published = nav_layers_publish_blocked(nav_layer_grid);
+		}
+	}
+}
+
+void A_Bot::check_path_against_changes() {
+	trace_scope("A_Bot::check_path_against_changes");
+
+	if (path_revision == nav_change_log.revision) {
+		return;
+	}
+
+	// Path we didn't walk yet: from where we are, through the rest of path points, and goal side points
+	// if bidirectional search is not finished.
+	std::vector<Vec3> remaining_path;
+	remaining_path.push_back(to_vec3(collision_box->GetComponentLocation()));
+
+	int first_point = path_search.found_path ? walking_path_info.target_path_point : 1;
+	for (int i = first_point; i < (int)path_search.path_points.size(); ++i) {
+		remaining_path.push_back(path_search.path_points[i]);
+	}
+	for (int i = path_search.goal_points.size() - 1; i >= 0; --i) {
+		remaining_path.push_back(path_search.goal_points[i]);
+	}
+
+	bool path_is_dirty = nav_change_log_crosses_path(nav_change_log, path_revision, remaining_path.data(), remaining_path.size(), to_vec3(collision_bounds));
+	path_revision = nav_change_log.revision;
+
+	if (path_is_dirty && path_search.path_points.size() > 0) {
+		UE_LOG(Log_CD_Core, Log, TEXT("Something moved on bot's path. Replanning. Bot position: %s"), *collision_box->GetComponentLocation().ToString());
+		reset_ai_logic();
+	}
 }
 
 void A_Bot::reset_ai_logic() {
-	// Bunch of global variables.
-	// @todo: Would be great if you could reduce number of global variables
-	// and start to structure your data more wisely :) 
+	// Our path, where we are on it, where we look and where we predict player goes.
 	new_final_point		= FVector(0);
 	current_final_point	= FVector(0);
 	
-	path_point_array.clear();
+	path_search_reset(&path_search);
+
+	if (path_ticket != 0) {
+		path_planner_cancel(&path_planner, path_ticket);
+		path_ticket = 0;
+	}
 	
 	found_new_final_point					= false;
-	found_path 								= false;
-	search_right							= false;
-	rotation_side_direction_was_randomized	= false;
 	failed_one_side_search					= false;
 	
 	//Walking_Path_Info walking_path_info_reset;
@@ -243,15 +895,33 @@ void A_Bot::reset_ai_logic() {
 	ready_to_go_to_path_point				= false;
 	can_simulate_rotation 					= false;
 	can_simulate_walking 					= false;
+	is_jump_pressed 						= false;
 
 	ai_error_info = AI_Error_Info();
+
+	objective_prediction = Objective_Prediction();
 }
 
 void A_Bot::Tick(float dt_from_tick) {
+	trace_scope("A_Bot::Tick");
+
 	Super::Tick(dt_from_tick);
 
+	// What player and bots wrote last frame goes out, whoever ticks first does it. Same for debug lines.
+	blackboard_begin_frame(&blackboard, GFrameCounter);
+	debug_draw_flush(GetWorld(), GFrameCounter);
+
+	// Replay playback gives frame time it recorded, see replay.h.
+	dt_from_tick = replay_play_frame(&replay.playback, GFrameCounter, dt_from_tick, FPlatformTime::Seconds());
 	dt = dt_from_tick;
 
+	// Bots share the planner, so whoever ticks first gives out this frame's trace budget.
+	if (path_planner_frame != GFrameCounter) {
+		path_planner_frame = GFrameCounter;
+		path_planner.budget.traces_per_frame = determinism.enabled ? 0 : ai_traces_per_frame; // Budget depends on frames, not steps.
+		path_planner_begin_frame(&path_planner);
+	}
+
 	//UE_LOG(Log_CD_Core, Log, TEXT("Bot position: %s"), *GetActorLocation().ToString());
 
 	// @note: Use this for timer measuring.
@@ -259,33 +929,45 @@ void A_Bot::Tick(float dt_from_tick) {
 	//float partial_seconds;
 	//UGameplayStatics::GetAccurateRealTime(GetWorld(), seconds, partial_seconds);
 	//UE_LOG(Log_CD_Core, Log, TEXT("Time passed and frame time:\n%.24f\n%.24f"), new_time - current_time, dt);
-	
-	static bool		want_ai_timer	= false;	
-	static float 	ai_timer 		= 5.0f;
-	static float 	ai_timer_count 	= 0.0f;
-	
-	if (want_ai_timer) {
-		ai_timer_count += dt;
 
-		if (ai_timer_count >= ai_timer) {
-			ai_timer_count = 0.0f;
-			simulate_intelligence();
-		}
-	} else {
-		simulate_intelligence();
+	int steps = fixed_step_advance(&simulation_clock, GFrameCounter, dt_from_tick);
+	if (bots_simulated_frame != GFrameCounter) {
+		bots_simulated_frame = GFrameCounter;
+		simulate_bots(steps);
 	}
 
-	move_camera();
-	move_bot();
-	//raycast();
-
 	//UE_LOG(Log_CD_Core, Log, TEXT("Velocity: %s"), *collision_velocity.ToString());
 
-	// @todo: Move this to post update maybe?
-	root->SetWorldLocation(collision_box->GetRelativeLocation());
+	// We are drawn between last two steps, so we move smoothly when frame rate isn't step rate.
+	root->SetWorldLocation(to_fvector(interpolated_position_get(interpolation, fixed_step_alpha(simulation_clock))));
+}
+
+void A_Bot::simulate_step(uint64_t step) {
+	thinking_step = step;
+
+	// Far bots skip steps and then think and move with all the time they skipped.
+	float distance_to_player = FVector::Dist(collision_box->GetComponentLocation(), to_fvector(published_player().position));
+	// Visibility comes from rendering, so deterministic mode updates everybody every step.
+	ai_lod.tier = ai_lod_enabled && !determinism.enabled ? ai_lod_choose_tier(ai_lod_params, ai_lod.tier, distance_to_player, WasRecentlyRendered(0.2f)) : 0;
+
+	float lod_dt;
+	if (ai_lod_should_update(&ai_lod, ai_lod_params, step, simulation_clock.params.step_dt, &lod_dt)) {
+		dt = lod_dt;
+
+		simulate_intelligence();
+
+		move_camera();
+		move_bot();
+		//raycast();
+	}
 }
 
 void A_Bot::simulate_intelligence() {
+	trace_scope("A_Bot::simulate_intelligence");
+
+	update_dynamic_obstacles();
+	check_path_against_changes();
+
 	search_rotation();
 	//search_height();
 	simulate_input();
@@ -294,62 +976,46 @@ void A_Bot::simulate_intelligence() {
 }
 
 void A_Bot::search_rotation() {
-	// @todo: What should we do, when we set last path point and we found the finish point?
-	// Right now, we could find finish point, but if we found it at awkward angle, we can't
-	// go to it, because we will not have enough space.
+	trace_scope("A_Bot::search_rotation");
 
-	// @todo: What about dead ends? We need to save them and start to search from first bot position
-	// before dead end?
-	// Or should we continue searching from dead end?
-	
-	// @todo: What if we found finish point, but can't actually go to it?
-	// Mark this area unreachable and search the other way? Define "mark this area", haha.
-
-	// @todo: Bot will fall, because I don't check ground. This problem is for search_height()?
-
-	// @todo: Consider using capsule collision for bot, instead of cuboid.
-
-	// @note: Right now the farther away the bot is (or point) from finish,
-	// the less accurate the rays are.
-
-	// @todo: I can try to profile this by counting how many raycasts I launched to
-	// find final_point. I need measure how much time it takes to make one raycast.
-	// After that I can count approximate time it took to find final_point:
-	// sum_of_raycasts * time_for_one_raycast = time_took_to_find_final_point
-
-	// @speed: To get extra speed I can count how many cycles I made in find_path_point(),
-	// and if we didn't anything after some number of turns, save current turn degrees, and
-	// continue doing different stuff. After that, he will comeback on next frame and
-	// continue searching for path from saved turn degrees.
-
-	// @todo: If we are not that far away from final_point and we need to pass one last wall,
-	// we can choose for bot to decide, if he will go into different direction.
-	// For example: We're searching right. final_point is near, but still behind the wall.
-	// 				Start searching left from last path_point.
-
-	// @todo: We can make two arrays of path points.
-	// One will contain newly found path.
-	// Second will contain the same path, but with reduced points. It will be a shorter path.
-	// To find shorter path, I can iterate between n and n+2, if theres no obstacles,
-	// I can remove n+1 and shift n+2 to the place of n+1.
-	// Of course I can compare n with n+(2+x) to find the shortest path, but this
-	// probably will be expansive.
-
-	// @todo: If I set final point as something that is within collision, like
-	// player position, this code will work wrong, because it will consider player collision
-	// as wall, which we are not. If you want to make proper "follow me" feature,
-	// I think you need to ignore player collision in search raycasts.
-	
 	// Check if we got new objective vector.
 	// Objective vector is a signal that comes from somewhere else.
 	// @note: 	What if there are bunch of objectives? Maybe we will need some
 	// 			kind of objective queue (array)?
 	//objective_vector = point_b->GetActorLocation(); // @hack: Remove this later.
-	objective_vector = A_Player::player_position; // @hack: Remove this later.
-	new_final_point = objective_vector;
+	
+	// We don't chase where player is right now, we go where player will be when we get there.
+	// Prediction also decides when objective changes, so we don't replan every time player moves a little.
+	// Replay playback gives objectives bots got when it was recorded, on the same steps, already traced.
+	Blackboard_Entity 	player 			= published_player();
+	FVector 			player_position = to_fvector(player.position);
+	Vec3 predicted_objective;
+	bool objective_changed;
+	if (replay.playback.playing) {
+		objective_changed = replay_take_objective(&replay.playback, thinking_step, determinism_id, &predicted_objective);
+	} else {
+		objective_changed = objective_prediction_update(&objective_prediction, objective_prediction_params, objective_estimate,
+			to_vec3(collision_box->GetComponentLocation()), player.position, dt, &predicted_objective);
+	}
+
+	if (objective_changed) {
+		// Player can't walk through walls, so prediction can't either.
+		FVector 	predicted_point = to_fvector(predicted_objective);
+		FHitResult 	out_hit_objective;
+		if (!replay.playback.playing && GetWorld()->LineTraceSingleByChannel(out_hit_objective, player_position, predicted_point, ECC_Visibility, collision_parameters_for_path_search)) {
+			FVector back_off = (player_position - predicted_point).GetSafeNormal() * whole_collision_size;
+			predicted_point = out_hit_objective.Location + back_off;
+		}
+
+		objective 			= predicted_point;
+		objective_vector 	= predicted_point; // @hack: Remove this later. Newest objective any bot took, for HUI.
+		replay_record_objective(&replay.recorder, thinking_step, determinism_id, to_vec3(objective));
+		blackboard_write_objective(&blackboard, to_vec3(objective));
+	}
+	new_final_point = objective;
 	
 	// If we didn't start searching or we reached final point, path point array will be empty.
-	if (path_point_array.size() == 0) {
+	if (path_search.path_points.size() == 0) {
 		if (current_final_point != new_final_point) {
 			found_new_final_point 	= true;
 			current_final_point 	= new_final_point;
@@ -358,443 +1024,52 @@ void A_Bot::search_rotation() {
 		}
 	}
 
-	if (!found_path && found_new_final_point) {
-		// If it's the first time we are searching the path, start position will be bot's position.
-		// If not, start from last point we found.
-		FVector start_point;
-
-		if (path_point_array.size() == 0) {
-			path_point_array.push_back(collision_box->GetComponentLocation());
+	if (path_ticket != 0) {
+		float distance_to_player = FVector::Dist(collision_box->GetComponentLocation(), to_fvector(published_player().position));
+		path_planner_update_priority(&path_planner, path_ticket, distance_to_player, WasRecentlyRendered(0.2f));
 
-			start_point = path_point_array[0];
-		} else {
-			start_point = path_point_array[path_point_array.size() - 1];
-		}
-		
-		// @note: What will happen if final point will change mid path finding?
-		FVector final_point 			= current_final_point;
-				final_point.Z			= start_point.Z;
-		FVector start_to_final			= final_point - start_point;
-		float 	start_to_final_distance	= start_to_final.Size2D();
-
-		// Raycast from start to final point.
-		FHitResult 	out_hit_main;
-		bool 		found_final_point;
-		bool 		got_hit_main = GetWorld()->LineTraceSingleByChannel(out_hit_main, start_point, final_point, ECC_Visibility, collision_parameters_for_path_search);
-		
-		// If we found obstacle between start and final_point, search where to go.
-		if (got_hit_main) {
-			found_final_point = false;
-			find_path_point(start_point, start_to_final, start_to_final_distance, found_final_point);
-		} else { // No obstacles found and we are "looking" straight at final_point.
-			// We didn't actually found path, we just found (saw) final point.
-			// We will do extra logic to know that we can actually reach final point and
-			// declare that we found path.
-			found_final_point = true;
-			
-			// We need to perform last check to see if bot can actually reach final_point
-			// using two raycasts from cuboid collision of bot.
-			FVector last_point 				= start_point;
-			FVector last_to_final			= final_point - last_point;
-			//float 	last_to_final_distance	= last_to_final.Size2D();
-
-			// Find angle between last path point and final_point and cosine vector on trigonometric circle for
-			// two raycasts from cuboid collision of bot.
-			FVector last_to_final_search 	= last_to_final;
-					last_to_final_search.Z 	= 0;
-			last_to_final_search.Normalize();
-			
-			float last_to_final_angle = FMath::Acos(FVector::DotProduct(last_to_final_search, FVector(1,0,0)));
-			if (last_to_final_search.Y < 0) {
-				last_to_final_angle = tau - last_to_final_angle;
-			}
-			
-			// Find front corners of cuboid bot collision (front is looking at final_point direction from new extra path_point).
-			// We use this to know that we could actually reach final_point.
-			float length_of_hypotenuse_from_center_of_bot_collision = FMath::Sqrt(2) * collision_size;
-			
-			// Find front left corner of cuboid.
-			float 	front_left_corner_angle = last_to_final_angle - pi/4; // Minus degrees on trig circle is left for Unreal top-down view.
-			FVector front_left_corner(0,0,0);
-			
-			FMath::SinCos(&front_left_corner.Y, &front_left_corner.X, front_left_corner_angle);
-			front_left_corner 	*= length_of_hypotenuse_from_center_of_bot_collision;
-			front_left_corner 	+= last_point;
-						
-			// Find front right edge.
-			float 	front_right_corner_angle = last_to_final_angle + pi/4; // Plus degrees on trig circle is right for Unreal top-down view.
-			FVector front_right_corner(0,0,0);
-			
-			FMath::SinCos(&front_right_corner.Y, &front_right_corner.X, front_right_corner_angle);
-			front_right_corner 	*= length_of_hypotenuse_from_center_of_bot_collision;
-			front_right_corner 	+= last_point;
-						
-			// Find vector for side shifting in corner trace cycle.
-			// If we are serching right side, shift will be to the right relative to the final_point.
-			// And vice versa.
-			float side_shift_angle;
-			if (search_right) {
-				side_shift_angle = last_to_final_angle + pi/2; // Plus degrees on trig circle is right for Unreal top-down view.
-			} else {
-				side_shift_angle = last_to_final_angle - pi/2; // Minus degrees on trig circle is left for Unreal top-down view.
-			}
-			
-			FVector side_shift_vector(0,0,0);
-			FMath::SinCos(&side_shift_vector.Y, &side_shift_vector.X, side_shift_angle);
-			
-			// We will shift by 1.5 of whole cuboid collision.
-			side_shift_vector *= collision_size * 3;
-
-			// Corner trace cycle. Find if we can actually reach final_point.
-			// If not, shift number of times and if we can actually reach final_point,
-			// set new path_point. If shifting was not successful,
-			// do not set new path_point and just leave.
-			FVector 	new_path_point 				= last_point;
-			FVector 	new_to_final				= last_to_final;
-			FVector 	final_point_for_left(0);
-			FVector 	final_point_for_right(0);
-			FHitResult 	out_hit_left;
-			FHitResult 	out_hit_right;
-			bool		made_side_shift				= false;
-			bool 		path_is_clear 				= false;
-			
-			// @note: On what this number depends? On bot collision?
-			// Will it stay as magic number?
-			int times_to_shift_to_the_side = 1;
-			
-			// @todo: Raycast to the side to see that we can actually side shift.
-			for (int i = 1; i <= times_to_shift_to_the_side + 1; ++i) {
-				if (i > 1) {
-					front_left_corner 	+= side_shift_vector;
-					front_right_corner	+= side_shift_vector;
-					new_path_point		+= side_shift_vector;
-					new_to_final		= final_point - new_path_point;
-				}
-				
-				// Raycast from left and right side of cuboid collision straight at final point direction.
-				// @note: If it's first iteration new_to_final is just last_to_final.
-				final_point_for_left 	= front_left_corner + new_to_final;
-				final_point_for_right 	= front_right_corner + new_to_final;
-				
-				bool got_hit_left 	= GetWorld()->LineTraceSingleByChannel(out_hit_left, front_left_corner, final_point_for_left, ECC_Visibility, collision_parameters_for_path_search);
-				bool got_hit_right 	= GetWorld()->LineTraceSingleByChannel(out_hit_right, front_right_corner, final_point_for_right, ECC_Visibility, collision_parameters_for_path_search);
-				
-				// Draw forward vector from corners to final_point direction.
-				//DrawDebugLine(GetWorld(), front_left_corner, final_point_for_left, FColor::Black, false, 10000.0f, 0, 1.2f);
-				//DrawDebugLine(GetWorld(), front_right_corner, final_point_for_right, FColor::Black, false, 10000.0f, 0, 1.2f);
-				
-				// If traces weren't colliding with anything, path is clear.
-				if (!got_hit_left && !got_hit_right) {
-					if (i > 1)
-						made_side_shift = true;
-					
-					path_is_clear = true;
-					break;
-				}
-			}
-
-			// We need to set new path point and rewrite start point if we made a shift.
-			if (made_side_shift) {
-				set_path_point(start_point, new_path_point);
-				start_point = new_path_point;
-			}
-
-			// If both rays didn't hit anything - we have finally found the path!
-			if (path_is_clear) {
-				found_path = true;
-
-				// Put final point at the end of array to use it for movement logic.
-				path_point_array.push_back(final_point);
-
-				// Draw line from last path_point to final_point to indicate that we can reach final_point.
-				DrawDebugLine(GetWorld(), start_point, final_point, FColor::Green, false, 10000.0f, 0, 1.2f);
-			} else {
-				// Draw line from last path_point to final_point to indicate that we saw final_point,
-				// but we can't reach.
-				DrawDebugLine(GetWorld(), start_point, final_point, FColor::Red, false, 10000.0f, 0, 1.2f);
+		take_planned_path();
+	}
 
-				// We got some obstacles, find new point with found_final_point exception
-				// and on to the next frame.
-				find_path_point(start_point, start_to_final, start_to_final_distance, found_final_point);
-			}
-		}
+	if (!path_search.found_path && found_new_final_point && path_ticket == 0 && path_search.path_points.size() == 0) {
+		Path_Request request;
+		request.start 			= to_vec3(collision_box->GetComponentLocation());
+		request.goal 			= to_vec3(current_final_point);
+		request.half_extents 	= Vec3(collision_size, collision_size, collision_height);
+		request.collision_owner = std::make_shared<Collision_Query_Unreal>(path_search_collision);
+		request.collision 		= request.collision_owner.get();
+		request.distance_to_player 	= FVector::Dist(collision_box->GetComponentLocation(), to_fvector(published_player().position));
+		request.visible 			= WasRecentlyRendered(0.2f);
+		request.seed 				= random_stream_next(&random) | 1; // Zero would mean planner picks one.
+		request.stats 				= search_stats; // Planner records our search into them when we take it.
+		request.surface_blocked 	= nav_blocked_published;
+
+		path_ticket 			= path_planner_submit(&path_planner, request);
+		path_ticket_final_point = current_final_point;
+		path_revision 			= nav_change_log.revision; // Everything that changed before this is already in the world we trace.
 	}
 }
 
-void A_Bot::find_path_point(FVector start_point, FVector start_to_final, float start_to_final_distance, bool found_final_point) {	
-	FVector path_point(0);
-	
-	// @todo: 	Make sure to make implementation, when we don't hit any collision
-	// 			from A to B.
-	// Also, if we found straight path, there is no guarantee that we can fit into this
-	// straight passage.
-	
-	// @todo: 	What if there is an obstacle at the bottom or at the top of bot collision?
-	// 			We need something like this: check_height_for_collision(dt);
-	// We will need this to know if collision can fit into found passage.
-	
-	// @hack: To find if we can fit into passage, right now I'll some big width number.
-	// 		Maybe I can use more than twice of collision, before I implement something
-	// like check_height_for_collision(), so that bot wouldn't stuck at some
-	// obstacles or tricky wall angles, because I don't use Z axes in rotation search.
-	// 		Yeah, seems like we need to use more than twice of the collision.
-	// Right now my trace precision is only 360 degrees. Sometimes there is more wall
-	// collision left and we need to account for that.
-	// Will think about it when I'll test extreme cases like corridor with same width
-	// as bot collision. Guess right now I'll hack my way through that.
-	// -- Richard Chirkin 22.01.2022
-	float safe_distance_to_pass = whole_collision_size * 3;
-	
-	// Point B is like the center of a circle. start_to_final_distance is radius of a circle.
-	// But we will use diameter of this imaginary B circle for our path search.
-	// @todo: 	What if target is near and passage to target is very far?
-	// 			Will this still work? Think not.
-	float search_length = start_to_final_distance * 2;
-	
-	// We are searching only in XY plane, we don't need Z.
-	FVector start_to_final_search 	= start_to_final;
-	start_to_final_search.Z 		= 0;
-	start_to_final_search.Normalize();
-	
-	// Prepare everything for raycast cycle.
-	FVector	new_search_vector(0);
-	FVector	first_success_trace_vector(0);
-	
-	float 	new_trace_distance 		= 0;
-	float 	last_hit_distance 		= 0;
-	//float 	new_normal_angle	= 0; // I'm not using normal angles for now... Maybe never?
-	//float 	old_normal_angle	= 0;
-	int 	success_traces_count 	= 0;
-	
-	bool 	found_passage = false;
-	
-	// Randomize decision in what direction to go.
-	if (!rotation_side_direction_was_randomized) {
-		rotation_side_direction_was_randomized = true;
-		
-		int random_number = FMath::RandRange(0, 1);
-		
-		if (random_number == 0) {
-			search_right = false;
-		} else {
-			search_right = true;
+void A_Bot::take_planned_path() {
+	Path_Result result;
+	if (!path_planner_take(&path_planner, path_ticket, &result)) {
+		// Objective moved while we were waiting, that path is not needed anymore.
+		if (path_ticket_final_point != current_final_point) {
+			path_planner_cancel(&path_planner, path_ticket);
+			path_ticket = 0;
 		}
+		return;
 	}
-	
-	// Find angle between start_to_final_search and cosine vector on trigonometric circle, to know
-	// where to rotate in search cycle.
-	float start_to_final_search_angle = FMath::Acos(FVector::DotProduct(start_to_final_search, FVector(1,0,0)));
-	if (start_to_final_search.Y < 0) {
-		start_to_final_search_angle = tau - start_to_final_search_angle;
-	}
-	
-	int maximum_to_rotate = 360;
-	
-	for (int i = 0; i <= maximum_to_rotate; ++i) {
-		// If we add degrees it's rotation to the right in Unreal, if we substract - it's rotation to the left.
-		float search_angle = start_to_final_search_angle * (180/pi);
-		
-		// We rotate and search by one degree, not radians.
-		if (search_right) {
-			search_angle += i;
-		} else {
-			search_angle -= i;
-		}
-		
-		search_angle *= pi/180; // Convert back to radians.
-		
-		//UE_LOG(Log_CD_Core, Log, TEXT("Angle: %.2f"), start_to_final_search_angle * (180.f/pi));
-		
-		FVector search_vector(0,0,0);
-		FMath::SinCos(&search_vector.Y, &search_vector.X, search_angle);
-		new_search_vector 	= search_vector;
-		search_vector 		*= search_length;
-		
-		// We move found vector to start_point to use for raycast.
-		search_vector += start_point;
-		
-		// Line trace search.
-		FHitResult 	out_hit_search;
-		FVector 	point_hit(0);
-		FVector 	point_hit_normal(0);
-		bool		found_empty_space = false;
+	path_ticket = 0;
 
-		bool got_hit_search = GetWorld()->LineTraceSingleByChannel(out_hit_search, start_point, search_vector, ECC_Visibility, collision_parameters_for_path_search);
-		
-		if (got_hit_search) {
-			if (out_hit_search.bBlockingHit) {
-				point_hit 			= out_hit_search.ImpactPoint;
-				point_hit_normal 	= out_hit_search.ImpactNormal;
-				/*	
-					// We don't need Z for angle search.
-					point_hit_normal.Z = 0;
-					
-					// Find angle for current line.
-					new_normal_angle = FMath::Acos(FVector::DotProduct(point_hit_normal, FVector(1,0,0)));
-					if (point_hit_normal.Y < 0) {
-					new_normal_angle = tau - new_normal_angle;
-					}
-					*/	
-				// Distance of current line.
-				new_trace_distance = out_hit_search.Distance;
-			}
-		} else { // Found empty space (no walls were hit).
-			found_empty_space 	= true;
-			new_trace_distance 	= search_length;
-		}
-		
-		// If this is initial trace, just save information and continue.
-		if (i == 0) {
-			// If we are looking at final_point, take twice of whole collision
-			// as distance for first trace, to compare it against success traces.
-			if (found_final_point) {
-				last_hit_distance = whole_collision_size * 2;
-			} else {
-				last_hit_distance = new_trace_distance;
-			}
-			
-			new_trace_distance 	= 0.0f;
-			
-			// If first trace, draw line towards point b location.
-			DrawDebugLine(GetWorld(), start_point, point_hit, FColor::Yellow, false, dt + 0.0001f, 0, 1.2f);
-			
-			continue;
-		}
-		
-		// Find out if our trace was successful to meet requirements on how to be successful or
-		// if it failed miserably.
-		bool success_trace = false;
-		if (new_trace_distance > last_hit_distance) {
-			// New wall is further.
-			// If this is an opening we fit in 1D, than it's a success trace.
-			if (new_trace_distance - last_hit_distance >= safe_distance_to_pass) {
-				// @todo: There is probably passage between walls. Should I do normal angle checking?
-				success_trace = true;
-			} else {
-				success_trace = false;
-			}
-		} else {
-			// New wall is nearer or the same. No opening, sadge. 
-			success_trace = false;
-			
-			// If we move in space, we need to find depth (opening) to go through.
-			// But even if the wall seems nearer with no opening in 1D (in 1D wall = dot),
-			// there is still can be opening in 2D between last_hit_distance's wall and new wall.
-			if (new_trace_distance - last_hit_distance <= -safe_distance_to_pass) {
-				// @todo: There is probably passage between walls. Should I do normal angle checking?
-			}
-		}
-		
-		if (success_trace) {
-			// We are hoping that we get successful sequence of traces and we don't
-			// care how far away new success traces are from last_hit_distance
-			// (or more like how longer are they from last_hit_distance).
-			// If we fulfill passage width with continues success traces, we will use
-			// last_hit_distance to find where we should place path point.
-			// That's why we don't overwrite last_hit_distance in success_trace.
-			FVector new_trace_vector = new_search_vector * last_hit_distance;
-			
-			// We count success traces to know when was the first one and save it's search vector
-			// to use for point finding. We are finding the point in between the first and the last success trace.
-			++success_traces_count;
-			if (success_traces_count == 1) {
-				first_success_trace_vector = new_trace_vector;
-			}
-			
-			float distance_between_line_traces = FVector::Distance(new_trace_vector, first_success_trace_vector);
-			
-			if (!found_empty_space) {
-				// Draw success trace.
-				DrawDebugLine(GetWorld(), start_point, point_hit, FColor::Green, false, dt + 0.0001f, 0, 1.2f);
-				
-				// Draw normal of success trace. If there's no wall, no normal will be drawn. Remember, normal's Z is zero.
-				//DrawDebugLine(GetWorld(), point_hit, point_hit + point_hit_normal * 200.0f, FColor::White, false, dt + 0.0001f, 0, 1.2f);
-			} else {
-				// Draw success trace with the length of search_vector.
-				DrawDebugLine(GetWorld(), start_point, search_vector, FColor::Green, false, dt + 0.0001f, 0, 1.2f);
-			}
-			
-			// If opening is wide enough to go through, guess we found the passage!
-			// @todo: 	If wall is very near and we traced more than 180 degrees (if 180 is max), path point will not be set,
-			// 			because we are setting it using last_hit_distance that is very near us, and
-			// 			distance_between_line_traces will always be smaller than safe_distance_to_pass,
-			// 			but nevertheless there is actually enough space to set a point.
-			// Is this because safe_distance_to_pass is not actual bot collision and just a hack,
-			// or I need to set path point differently? Or just use 360 degrees?
-			if (distance_between_line_traces >= safe_distance_to_pass) {
-				found_passage = true;
-				
-				// We want half of perpendicular vector from first_success_trace_vector to new_trace_vector.
-				float half_distance_between_new_trace_and_last_hit = distance_between_line_traces / 2;
-				FVector vector_to_set_point = new_trace_vector - first_success_trace_vector;
-				vector_to_set_point.Normalize();
-				vector_to_set_point *= half_distance_between_new_trace_and_last_hit;
-				
-				path_point = start_point + first_success_trace_vector + vector_to_set_point;
-				
-				break;
-			}
-		} else {
-			if (i > 0) { // If not first trace.
-				// Save info for next success_trace comparison.
-				last_hit_distance = new_trace_distance;
-				
-				// Reset success traces count.
-				success_traces_count = 0;
-				
-				// Draw fail trace.
-				DrawDebugLine(GetWorld(), start_point, point_hit, FColor::Red, false, dt + 0.0001f, 0, 1.2f);
-				
-				// Draw wall normal of failed trace. Remember, normal's Z is zero.
-				//DrawDebugLine(GetWorld(), point_hit, point_hit + point_hit_normal * 200.0f, FColor::Blue, false, dt + 0.0001f, 0, 1.2f);
-			}
-		}
-
-		// If we didn't find the passage, for now just rotate search other side and
-		// hope that someday we will find the passage.
-		if (i == maximum_to_rotate) {
-			search_right = !search_right;
-
-			// Save info that we failed to do rotation search in one direction.
-			++ai_error_info.failed_to_search_in_some_direction;
-
-			//UE_LOG(Log_CD_Core, Log, TEXT("Bot rotated 360 degrees and found nothing! search_right was: %d"), search_right);
-			
-			// @note: Stop searching if we didn't found anything in right and left turns?
-			// @note: If we failed searching in both directions, we never stop searching.
-			// Do we actually need to stop? EZ
-			// 360 degrees of raycasts will make your CPU very happy every frame! GIGACHAD
-
-			// @todo: This looks like the case where we actually found a dead end!
-
-			// @todo: 	If you place a point, that bot can't actually go to (not just Z height in 3D),
-			// bot will do rotation search forever.
-			// This is caused by safe_distance_to_pass being too high that results in
-			// bot being stuck forever.
-			// There is just not enough space for bot to get to our final point Sadge
-			// @note: 	Guess you can mark final point unreachable and just wait for another
-			// objective or maybe find new objective that you can reach.
-		}
-	}
-	
-	if (found_passage) {
-		set_path_point(start_point, path_point);
+	if (!result.search.found_path) {
+		UE_LOG(Log_CD_Core, Log, TEXT("Planner didn't find the path in %d steps! Resetting bot's AI. Bot position: %s"), result.steps, *collision_box->GetComponentLocation().ToString());
+		reset_ai_logic();
+		return;
 	}
-}
 
-void A_Bot::set_path_point(FVector start_point, FVector path_point) {
-	path_point_array.push_back(path_point);
-	
-	FColor pinkish(228, 80, 162); // Pinkish.
-	FColor turquoise(71, 226, 239); // Victory turquoise.
-	
-	// Draw where point is.
-	FVector path_point_ground(path_point.X, path_point.Y, start_point.Z - collision_height);
-	FVector path_point_ceiling(path_point.X, path_point.Y, start_point.Z + collision_height);
-	DrawDebugLine(GetWorld(), path_point_ground, path_point_ceiling, pinkish, false, 10000.0f, 0, 1.2f);
-	
-	// Draw line from point to point.
-	DrawDebugLine(GetWorld(), start_point, path_point, turquoise, false, 10000.0f, 0, 1.2f);
+	path_search = std::move(result.search);
+	draw_planned_path(path_search, collision_height);
 }
 
 void A_Bot::search_height() {
@@ -805,12 +1080,14 @@ void A_Bot::search_height() {
 }
 
 void A_Bot::simulate_input() {
+	trace_scope("A_Bot::simulate_input");
+
 	// @todo: Start moving when we found at least one path point and not just whole path.
-	if (found_path && !ready_to_go_to_path_point) {
+	if (path_search.found_path && !ready_to_go_to_path_point) {
 		// Initialize stuff before doing rotation and walking.
 		FVector bot_position 	= collision_box->GetRelativeLocation();
 		FVector bot_forward 	= collision_box->GetForwardVector();
-		FVector path_point		= path_point_array[walking_path_info.target_path_point];
+		FVector path_point		= to_fvector(path_search.path_points[walking_path_info.target_path_point]);
 		FVector bot_to_point	= path_point - bot_position;
 		
 		walking_path_info.current_path_point 		= path_point;
@@ -838,7 +1115,7 @@ void A_Bot::simulate_input() {
 			if (dot_product < 0.0f)
 			{
 				direction_was_randomized 	= true;
-				int random_number 			= FMath::RandRange(0, 1);
+				int random_number 			= random_stream_range(&random, 0, 1);
 
 				if (random_number == 0) {
 					rotation_direction_right = false;
@@ -878,29 +1155,35 @@ void A_Bot::simulate_input() {
 }
 
 void A_Bot::simulate_rotation() {
-	bool 	rotation_direction_right 	= walking_path_info.rotation_direction_right;
-	float 	rotation_speed				= 3.0f;
+	// Degrees per second, what rotation speed 3 gave through mouse sensitivity before.
+	float rotation_speed = 300.0f;
 
-	// We are rotating only horizontally for now.
-	if (rotation_direction_right) {
-		mouse_input_x = rotation_speed;
-	} else {
-		mouse_input_x = -rotation_speed;
-	}
+	// We are rotating only horizontally for now. Yaw is turned here and not through mouse input,
+	// far bots think with long dt (ai_lod.h) and one step could turn past the point and never look at it.
+	FVector point_forward 	= walking_path_info.point_forward;
+	float 	target_yaw 		= FMath::RadiansToDegrees(FMath::Atan2(point_forward.Y, point_forward.X));
+	float 	yaw_step 		= rotation_speed * dt;
 
-	FVector bot_forward 	= collision_box->GetForwardVector();
-	FVector point_forward	= walking_path_info.point_forward;
-	float 	dot_product		= FVector::DotProduct(bot_forward, point_forward);
-	float	epsilon 		= 0.001f;
+	float 	yaw_delta 		= FMath::FindDeltaAngleDegrees(camera_euler_rotation.Yaw, target_yaw);
+
+	// Keep turning in the direction we chose in simulate_input() (right is positive yaw) until this step reaches the point.
+	if (FMath::Abs(yaw_delta) > yaw_step) {
+		camera_euler_rotation.Yaw = FRotator::NormalizeAxis(camera_euler_rotation.Yaw + (walking_path_info.rotation_direction_right ? yaw_step : -yaw_step));
+		return;
+	}
 
-	//UE_LOG(Log_CD_Core, Log, TEXT("dot_product: %.2f"), dot_product);
+	// Step would pass the path point, so we look straight at it and can walk to it.
+	camera_euler_rotation.Yaw = target_yaw;
 
-	// If bot is looking straight at path point, we can walk to it.
-	if (FMath::IsNearlyEqual(dot_product, 1.0f, epsilon)) {
-		can_simulate_rotation 	= false;
-		can_simulate_walking 	= true;
+	can_simulate_rotation 	= false;
+	can_simulate_walking 	= true;
 
-		mouse_input_x = 0.0f;
+	// If we get to this point with a jump, we jump right away, jump link was baked from standstill.
+	walking_path_info.jump_hold_time_left = 0;
+	for (const Path_Jump &path_jump : path_search.jumps) {
+		if (path_jump.path_point_index == walking_path_info.target_path_point) {
+			walking_path_info.jump_hold_time_left = path_jump.hold_time;
+		}
 	}
 }
 
@@ -912,6 +1195,14 @@ void A_Bot::simulate_walking() {
 	FVector bot_forward 	= collision_box->GetForwardVector();
 	FVector path_point		= walking_path_info.current_path_point;
 	float 	epsilon 		= 0.001f;
+
+	// Hold jump for the time jump link needs.
+	if (walking_path_info.jump_hold_time_left > 0) {
+		is_jump_pressed = true;
+		walking_path_info.jump_hold_time_left -= dt;
+	} else {
+		is_jump_pressed = false;
+	}
 	
 	// Eсли у бота есть полуугол зрения по горизонтали fov, то бот видит тебя
 	// -- Mr_indieperson
@@ -928,37 +1219,36 @@ void A_Bot::simulate_walking() {
 		|| FVector::DotProduct(bot_forward, path_point - bot_position) < 0.0f) {
 		is_walking 					= false;
 		is_move_forward_pressed 	= false;
+		is_jump_pressed 			= false;
 		
 		can_simulate_walking 		= false;
 		ready_to_go_to_path_point 	= false;
 		
 		++walking_path_info.target_path_point;
 		
-		if (walking_path_info.target_path_point > path_point_array.size() - 1) {
+		if (walking_path_info.target_path_point > path_search.path_points.size() - 1) {
 			// We reached final point! You can now wait for new objective!
 			
 			// Reset path.
 			walking_path_info.target_path_point = 1; // Count from one in next walking simulation.
 
-			// @note: If level changes dynamically we do not want to save found path.
-			path_point_array.clear();
-
-			found_path 								= false;
-			rotation_side_direction_was_randomized	= false;
+			path_search_finish(&path_search);
 		}
 	}
 }
 
 void A_Bot::process_exceptions() {
+	trace_scope("A_Bot::process_exceptions");
+
 	FVector bot_position = collision_box->GetRelativeLocation();
 
 	// As a precaution, if we failed to find path point in both direction, just reset.
-	if (ai_error_info.failed_to_search_in_some_direction == 2) {
+	if (path_search_failed(path_search, path_search_config)) {
 		UE_LOG(Log_CD_Core, Log, TEXT("Bot searched right and left and didn't found the passage! Path point was not set! Resetting bot's AI. Bot position: %s"), *bot_position.ToString());
 		reset_ai_logic();
 	}
 
-	if (found_path) {
+	if (path_search.found_path) {
 		// We want to check for case, when bot stopped moving for some unknown reason.
 		// Maybe he stuck at the wall, or something moved him at awkward spot.
 		// Just test if we are still moving after 1 second, and if we are not - reset AI.
@@ -1023,131 +1313,40 @@ void A_Bot::move_camera() {
 }
 
 void A_Bot::move_bot() {
+	trace_scope("A_Bot::move_bot");
+
 	// We rotate box collision by Z axes with the camera.
 	FRotator collision_box_rotation = collision_box->GetRelativeRotation();
 	collision_box_rotation.Yaw 		= camera_euler_rotation.Yaw;
 	FQuat new_collision_rotation 	= collision_rotation_conversion.RotatorToQuat(collision_box_rotation);
 	collision_box->SetRelativeRotation(new_collision_rotation);
 	
-	// Get direction vectors of collision for movement.
-	FVector collision_forward_vector 	= collision_box->GetForwardVector();
-	FVector collision_up_vector 		= collision_box->GetUpVector();
+	// Get direction vector of collision for movement.
+	FVector collision_forward_vector = collision_box->GetForwardVector();
 
 	// If we are not pressing any walking buttons, we are not walking.
 	if (!is_move_forward_pressed && !is_move_backward_pressed && !is_move_right_pressed && !is_move_left_pressed) {
 		is_walking = false;
 	}
 
+	uint32_t buttons = 0;
 	if (is_walking) {
-		FVector current_walking_vector(0, 0, 0);
-		float current_speed = 0;
-
-		// @note: Right now I do not use gamepad stick XY inputs.
-		if (is_move_forward_pressed) {
-			current_walking_vector += move_forward_xy;
-			current_speed += forward_force;
-		}
-		
-		if (is_move_backward_pressed) {
-			current_walking_vector += move_backward_xy;
-			current_speed += backward_force;
-		}
-		
-		if (is_move_right_pressed){
-			current_walking_vector += move_right_xy;
-			current_speed += right_force;
-		}
-		
-		if (is_move_left_pressed) {
-			current_walking_vector += move_left_xy;
-			current_speed += left_force;
-		}
-
-		// Normalize walking vector to fit into unit circle.
-		current_walking_vector.Normalize();
-		
-		// We find angle through dot product and we use found number in arccosine (or inverse cosine) to get angle in radians,
-		// between our vector and (as I call it) sine vector.
-		// If our vector is poiting at negative X axis, we need compensate that this angle to get past 180 degrees.
-		// I do that to bot collision so that it perfectly translates from Unreal XY bottom-up view to my XY top-down unit circle.
-		float collision_angle = FMath::Acos(FVector::DotProduct(collision_forward_vector, FVector(0,1,0)));
-		if (collision_forward_vector.X < 0) {
-			collision_angle = tau - collision_angle;
-		}
-		
-		// For inputs we are comparing to cosine vector.
-		// If our vector is poiting at negative Y axis, then we turned past pi, and we need to subtract found angle from full circle to get correct angle.
-		// We do this for correcting XY input interpretation to place it on unit circle from 0 degrees (x=1,y=0) to 360 degrees (x=1,y=0).
-		float input_angle = FMath::Acos(FVector::DotProduct(current_walking_vector, FVector(1,0,0)));
-		if (current_walking_vector.Y < 0) {
-			input_angle = tau - input_angle;
-		}
-
-		// Correct collision angle. It's like turning trig circle on 90 degrees to the left.
-		// Think about it as if input angle has sine relationship and collision angle has cosine relationship,
-		// and final angle for world space would have sine relationship.
-		// I found this pattern by investigating unit circle; I think I understand it,
-		// but for now I can't reason this idea quite well into words. -- r.chirkin 12.01.2022
-		collision_angle -= half_pi;
-
-		// We add corrected bot collision angle to input angle on unit circle and we get correct angle for bot walking direction.
-		float direction_angle = collision_angle + input_angle;
-		
-		// Because Unreal Engine XY axis are placed underneath Z axis (look at XY from bottom-up view),
-		// we need to translate direction angle from unit circle (XY top-down) to Unreal YX top-down view (right is Y = 1 and forward is X = 1).
-		direction_angle = tau - (direction_angle - half_pi);
-
-		//UE_LOG(Log_CD_Core, Log, TEXT("angle: %.2f"), direction_angle * (180/pi));
-		
-		// Finally, we find the right normalized XY coordinates from cosine and sine angle. 
-		FVector direction_vector(0,0,0);
-		FMath::SinCos(&direction_vector.Y, &direction_vector.X, direction_angle);
-
-		// If we got several directions - clamp speed;
-		// @note: 	We can use input_angle to find the difference between forward and right speed, etc.,
-		// 			for example like adding to perpendicular speeds (forward and left) if they are different.
-		// 			Formula is something like: (right_speed / 2) + (forward_speed / 2). Should be useful for stick input.
-		if (current_speed > max_walking_speed) {
-			current_speed = max_walking_speed;
-		}
-
-		// Tell physics system in what direction should we move with our constracted walking direction vector.
-		collision_physics->AddImpulse(direction_vector * (current_speed * dt), mass_has_no_effect);
+		if (is_move_forward_pressed) 	buttons |= MOVEMENT_FORWARD;
+		if (is_move_backward_pressed) 	buttons |= MOVEMENT_BACKWARD;
+		if (is_move_right_pressed) 		buttons |= MOVEMENT_RIGHT;
+		if (is_move_left_pressed) 		buttons |= MOVEMENT_LEFT;
 	}
-
 	if (is_jump_pressed) {
-		collision_physics->AddImpulse(collision_up_vector * (jump_force * dt), mass_has_no_effect);
+		buttons |= MOVEMENT_JUMP;
 	}
-	
-	// Add force to gravity.
-	collision_physics->AddImpulse(-collision_up_vector * (gravity_extra_force * dt), mass_has_no_effect);
-	
-	// We are clamping our walking velocity through drag forces.
-	// If were are not walking, we are initiating more powerfull drag force.
-
-	// @note: You can set instant velocity to collision with SetPhysicsLinearVelocity in PrimitiveComponent.
-
-	// @todo: This drag method will also try to stop you if you are not pressing any buttons and in air.
-	// I need moving states for this one, because I also moving very fast while falling.
-	// For example, if I move in air I should constraint magnitude of move_input vectors.
-
-	collision_velocity = collision_physics->GetUnrealWorldVelocity();
 
-	// Debug velocity.
-	//UE_LOG(Log_CD_Core, Log, TEXT("Velocity: %s"), *collision_velocity.ToString());
-
-	collision_velocity.Z = 0; // We do not use gravity, this is only for XY axes.
-	
-	// I'm taking current bot velocity, inverse it and multiply it by desired drag force.
-	if (!is_walking) {
-		collision_physics->AddImpulse(-collision_velocity * (drag_stop_walking_force * dt), mass_has_no_effect);
-	} else {
-		collision_physics->AddImpulse(-collision_velocity * (drag_walking_force * dt), mass_has_no_effect);
-	}
+	// Impulse comes from movement_batch_run() in apply_bot_movement(), together with other bots, and mover moves us there.
+	collision_velocity = to_fvector(mover.velocity);
+	movement_batch_add(&movement_batch, movement_params, collision_forward_vector.X, collision_forward_vector.Y, mover.velocity.x, mover.velocity.y, buttons, dt);
+	movement_bots.Add(this);
 
 	// We can know bot speed by finding magnitude (length, e.g. speed) in velocity vector.
 	// This speed includes Z height velocity.
-	collision_velocity = collision_physics->GetUnrealWorldVelocity();
 	bot_speed = collision_velocity.Size();
 }
 
@@ -1171,7 +1370,7 @@ void A_Bot::raycast() {
 			FVector point_hit_normal 	= out_hit.ImpactNormal;
 			
 			// Draw vector of the first collision that we hit.
-			DrawDebugLine(GetWorld(), start, point_hit, FColor::Black, false, dt + 0.0001f, 0, 1.2f);
+			debug_line(DEBUG_DRAW_RAYCAST, to_vec3(start), to_vec3(point_hit), 0x000000, false);
 			
 			//UE_LOG(Log_CD_Core, Log, TEXT("Vector Z of hit: %.8f"), point_hit.Z);
 
@@ -1186,7 +1385,7 @@ void A_Bot::raycast() {
 		}
 	} else {
 		// If no hit, trace a line with a different color.
-		DrawDebugLine(GetWorld(), start, end, FColor::Red, false, dt + 0.0001f, 0, 1.2f);
+		debug_line(DEBUG_DRAW_RAYCAST, to_vec3(start), to_vec3(end), 0xFF0000, false);
 	}
 }
 
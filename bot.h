@@ -5,6 +5,14 @@
 #include "GameFramework/Pawn.h"
 #include "Engine/EngineTypes.h" // For Player control.
 
+#include "ai_lod.h"
+#include "blackboard.h"
+#include "determinism.h"
+#include "fixed_step.h"
+#include "kinematic_mover.h"
+#include "objective_prediction.h"
+#include "path_search.h"
+
 #include "bot.generated.h"
 
 // @todo: Will need to move them in another file later and using them through namespace.
@@ -13,6 +21,23 @@
 #define half_pi	pi/2
 #define one_km	100000.0f // Unreal's 1.0 float = 1.0 centimeter
 
+struct Walking_Path_Info {
+	// Zero is starting point (bot location), we want to count from 1 (first path point).
+	int 	target_path_point 			= 1;
+	FVector	current_path_point 			= FVector(0);
+	FVector point_forward				= FVector(0);
+	float 	initial_distance_to_point 	= 0;
+	float 	jump_hold_time_left 		= 0;
+	bool 	rotation_direction_right 	= false;
+};
+
+struct AI_Error_Info {
+	FVector	saved_bot_position					= FVector(0);
+	float 	walking_error_timer 				= 1.0f;
+	float 	walking_error_timer_count 			= 0.0f;
+	bool	position_saved 						= false;
+};
+
 UCLASS()
 class A_Bot : public APawn {
 	GENERATED_BODY()
@@ -31,20 +56,73 @@ public:
 	static float 	bot_speed;
 	static FVector 	objective_vector;
 
+	// Player, every bot, path they follow and dynamic obstacles, see world_snapshot.h.
+	static void save_world_snapshot(struct World_Snapshot *snapshot);
+	static void load_world_snapshot(const struct World_Snapshot_View &view);
+
 	A_Bot(const FObjectInitializer &ObjectInitializer);
 	virtual void PostLoad() override;
 	virtual void BeginPlay() override;
 	virtual void Tick(float dt_from_tick) override;
+	virtual void EndPlay(const EEndPlayReason::Type end_play_reason) override;
 
 	// Inputs are set in project setting in Input category and also you can add and edit inputs in Config->DefaultInput.ini
 	virtual void SetupPlayerInputComponent(UInputComponent *input_component) override;
 	void reset_ai_logic();
 
+	// How often this bot thinks and moves, see ai_lod.h.
+	AI_Lod_State ai_lod;
+
+	// Position, velocity and ground of our collision, see kinematic_mover.h.
+	Kinematic_Mover_State mover;
+
+	// Stays the same every run, bots update in this order, see determinism.h.
+	uint64_t 		determinism_id = 0;
+
+	Random_Stream 	random;
+
+	// Where we are for others, see blackboard.h.
+	Blackboard_Handle blackboard_handle;
+
+	// Our own path: search that runs on planner workers for us (path_planner.h), and where we walk on it.
+	// Every bot's request gets budget by its own distance and visibility.
+	Path_Search 		path_search;
+	uint64_t 			path_ticket 			= 0; // Zero when nothing is being planned.
+	FVector 			path_ticket_final_point = FVector(0);
+	uint32 				path_revision 			= 0; // Change log revision our path was checked against.
+	FVector 			new_final_point 		= FVector(0);
+	FVector 			current_final_point 	= FVector(0);
+	bool 				found_new_final_point 	= false;
+	bool 				failed_one_side_search 	= false;
+	Walking_Path_Info 	walking_path_info;
+	AI_Error_Info 		ai_error_info;
+	Search_Stats 		*search_stats = nullptr; // Our searches are added when we take them, see search_stats.h.
+
+	// Where we go: player's position predicted from where we are, see objective_prediction.h.
+	Objective_Prediction 	objective_prediction;
+	FVector 				objective = FVector(0);
+
+	bool 		ready_to_go_to_path_point 	= false;
+	bool 		can_simulate_rotation 		= false;
+	bool 		can_simulate_walking 		= false;
+	bool 		is_walking 					= false; // Right now I control this by key input and not by checking bot velocity.
+	FRotator 	camera_euler_rotation 		= FRotator(0);
+
+	// Mover positions of last two fixed steps, root is drawn between them.
+	Interpolated_Position interpolation;
+
+	// One fixed step of thinking and moving. Movement itself is applied for all bots together after the step.
+	void simulate_step(uint64_t step);
+
 	void simulate_intelligence();
 	
-	void search_rotation();
-	void find_path_point(FVector start_point, FVector start_to_final, float start_to_final_distance, bool found_final_point);
-	void set_path_point(FVector start_point, FVector path_point);
+	void search_rotation(); // Path search itself is in path_search.h, it runs on path_planner.h workers.
+	void take_planned_path();
+
+	void build_navigation_layers();
+	void collect_dynamic_obstacles();
+	void update_dynamic_obstacles();
+	void check_path_against_changes();
 
 	void search_height();
 	
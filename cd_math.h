@@ -0,0 +1,159 @@
+#pragma once
+
+// Small engine-independent math for code that doesn't need Unreal types (navigation data, planners).
+// @note: Don't use names like pi or tau here, hero.h and bot.h define them as macros.
+
+#include <cmath>
+
+struct Vec3 {
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+
+	Vec3() = default;
+	Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+};
+
+inline Vec3 operator+(Vec3 a, Vec3 b) { return Vec3(a.x + b.x, a.y + b.y, a.z + b.z); }
+inline Vec3 operator-(Vec3 a, Vec3 b) { return Vec3(a.x - b.x, a.y - b.y, a.z - b.z); }
+inline Vec3 operator-(Vec3 a) 			{ return Vec3(-a.x, -a.y, -a.z); }
+inline Vec3 operator*(Vec3 a, float s) 	{ return Vec3(a.x * s, a.y * s, a.z * s); }
+inline Vec3 operator*(float s, Vec3 a) 	{ return Vec3(a.x * s, a.y * s, a.z * s); }
+inline Vec3 operator/(Vec3 a, float s) 	{ return Vec3(a.x / s, a.y / s, a.z / s); }
+inline Vec3 &operator+=(Vec3 &a, Vec3 b) { a.x += b.x; a.y += b.y; a.z += b.z; return a; }
+inline Vec3 &operator-=(Vec3 &a, Vec3 b) { a.x -= b.x; a.y -= b.y; a.z -= b.z; return a; }
+inline Vec3 &operator*=(Vec3 &a, float s) { a.x *= s; a.y *= s; a.z *= s; return a; }
+inline bool operator==(Vec3 a, Vec3 b) { return a.x == b.x && a.y == b.y && a.z == b.z; }
+inline bool operator!=(Vec3 a, Vec3 b) { return !(a == b); }
+
+inline float vec3_dot(Vec3 a, Vec3 b) 		{ return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3  vec3_cross(Vec3 a, Vec3 b) 	{ return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x); }
+inline float vec3_length(Vec3 a) 			{ return std::sqrt(vec3_dot(a, a)); }
+inline float vec3_length_squared(Vec3 a) 	{ return vec3_dot(a, a); }
+inline float vec3_length_2d(Vec3 a) 		{ return std::sqrt(a.x * a.x + a.y * a.y); }
+inline float vec3_distance(Vec3 a, Vec3 b) 	{ return vec3_length(b - a); }
+inline float vec3_distance_2d(Vec3 a, Vec3 b) { return vec3_length_2d(b - a); }
+inline Vec3  vec3_lerp(Vec3 a, Vec3 b, float t) { return a + (b - a) * t; }
+inline Vec3  vec3_min(Vec3 a, Vec3 b) { return Vec3(std::fmin(a.x, b.x), std::fmin(a.y, b.y), std::fmin(a.z, b.z)); }
+inline Vec3  vec3_max(Vec3 a, Vec3 b) { return Vec3(std::fmax(a.x, b.x), std::fmax(a.y, b.y), std::fmax(a.z, b.z)); }
+
+// Returns zero vector if length is too small, like FVector::GetSafeNormal().
+inline Vec3 vec3_normalize(Vec3 a) {
+	float length = vec3_length(a);
+	if (length < 1.e-8f) {
+		return Vec3();
+	}
+	return a / length;
+}
+
+// Normalized XY part of the vector, Z is dropped.
+inline Vec3 vec3_normalize_2d(Vec3 a) {
+	a.z = 0.0f;
+	return vec3_normalize(a);
+}
+
+// Rotation quaternion, same conventions as FQuat: a * b rotates by b first, then by a.
+struct Quat {
+	float x = 0.0f;
+	float y = 0.0f;
+	float z = 0.0f;
+	float w = 1.0f;
+
+	Quat() = default;
+	Quat(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+};
+
+inline Quat operator*(Quat a, Quat b) {
+	return Quat(
+		a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+		a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+		a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+		a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+}
+
+// Axis must be normalized.
+inline Quat quat_from_axis_angle(Vec3 axis, float radians) {
+	float s = std::sin(radians * 0.5f);
+	return Quat(axis.x * s, axis.y * s, axis.z * s, std::cos(radians * 0.5f));
+}
+
+inline Quat quat_normalize(Quat q) {
+	float length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+	if (length < 1.e-8f) {
+		return Quat();
+	}
+	return Quat(q.x / length, q.y / length, q.z / length, q.w / length);
+}
+
+inline Vec3 quat_rotate(Quat q, Vec3 v) {
+	Vec3 axis(q.x, q.y, q.z);
+	Vec3 t = vec3_cross(axis, v) * 2.0f;
+	return v + t * q.w + vec3_cross(axis, t);
+}
+
+// Axis aligned box.
+struct Box3 {
+	Vec3 min;
+	Vec3 max;
+};
+
+inline Box3 box3_from_center(Vec3 center, Vec3 half_extents) {
+	return Box3{center - half_extents, center + half_extents};
+}
+
+inline Box3 box3_union(Box3 a, Box3 b) {
+	return Box3{vec3_min(a.min, b.min), vec3_max(a.max, b.max)};
+}
+
+inline Box3 box3_expand(Box3 a, Vec3 amount) {
+	return Box3{a.min - amount, a.max + amount};
+}
+
+inline bool box3_overlaps(Box3 a, Box3 b) {
+	return a.min.x <= b.max.x && a.max.x >= b.min.x
+		&& a.min.y <= b.max.y && a.max.y >= b.min.y
+		&& a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+inline bool box3_contains(Box3 a, Vec3 p) {
+	return p.x >= a.min.x && p.x <= a.max.x
+		&& p.y >= a.min.y && p.y <= a.max.y
+		&& p.z >= a.min.z && p.z <= a.max.z;
+}
+
+// Slab test of segment from a to b against the box. Optionally returns entry fraction along the segment.
+inline bool segment_hits_box3(Vec3 a, Vec3 b, Box3 box, float *out_fraction = nullptr) {
+	float t_min = 0.0f;
+	float t_max = 1.0f;
+	float origin[3] 	= {a.x, a.y, a.z};
+	float direction[3] 	= {b.x - a.x, b.y - a.y, b.z - a.z};
+	float box_min[3] 	= {box.min.x, box.min.y, box.min.z};
+	float box_max[3] 	= {box.max.x, box.max.y, box.max.z};
+
+	for (int axis = 0; axis < 3; ++axis) {
+		if (std::fabs(direction[axis]) < 1.e-8f) {
+			if (origin[axis] < box_min[axis] || origin[axis] > box_max[axis]) {
+				return false;
+			}
+			continue;
+		}
+
+		float inverse = 1.0f / direction[axis];
+		float t0 = (box_min[axis] - origin[axis]) * inverse;
+		float t1 = (box_max[axis] - origin[axis]) * inverse;
+		if (t0 > t1) {
+			float swap = t0; t0 = t1; t1 = swap;
+		}
+
+		t_min = std::fmax(t_min, t0);
+		t_max = std::fmin(t_max, t1);
+		if (t_min > t_max) {
+			return false;
+		}
+	}
+
+	if (out_fraction) {
+		*out_fraction = t_min;
+	}
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// Narrow collision query interface the planner is written against.
+// In game it's Collision_Query_Unreal (UWorld traces), outside of the editor it's Headless_World,
+// so pathfinding can be built, tested and benchmarked without Unreal.
+//
+// All queries are const, implementations must be safe to call from several threads at once.
+
+#include "cd_math.h"
+
+struct Collision_Ray {
+	Vec3 from;
+	Vec3 to;
+};
+
+struct Collision_Hit {
+	bool 	blocking 	= false;
+	Vec3 	point; 			// Impact point. For box sweep it's where the box center stopped.
+	Vec3 	normal;
+	float 	fraction 	= 1.0f; // Where along the ray we hit, from 0 to 1.
+	float 	distance 	= 0.0f;
+};
+
+class Collision_Query {
+public:
+	virtual ~Collision_Query() {}
+
+	// Returns true if ray hit something that blocks it.
+	virtual bool ray(Vec3 from, Vec3 to, Collision_Hit *out_hit) const = 0;
+
+	// Several rays at once. Default is just a loop, backends can do better with coherent rays.
+	virtual void ray_batch(const Collision_Ray *rays, int count, Collision_Hit *out_hits) const {
+		for (int i = 0; i < count; ++i) {
+			ray(rays[i].from, rays[i].to, &out_hits[i]);
+		}
+	}
+
+	// Moves axis aligned box from one center to another, returns true if it hit something on the way.
+	virtual bool box_sweep(Vec3 from, Vec3 to, Vec3 half_extents, Collision_Hit *out_hit) const = 0;
+};
@@ -0,0 +1,55 @@
+#include "collision_query_unreal.h"
+
+#include "Physics/PhysicsInterfaceCore.h" // For scene read lock.
+
+namespace {
+	void fill_hit(const FHitResult &out_hit, bool got_hit, Collision_Hit *hit) {
+		hit->blocking = got_hit && out_hit.bBlockingHit;
+		if (!hit->blocking) {
+			hit->fraction = 1.0f;
+			return;
+		}
+
+		hit->point 		= to_vec3(out_hit.ImpactPoint);
+		hit->normal 	= to_vec3(out_hit.ImpactNormal);
+		hit->fraction 	= out_hit.Time;
+		hit->distance 	= out_hit.Distance;
+	}
+
+	// Runs query under physics scene read lock if we need it, game thread takes write lock when it moves collision.
+	template <typename Query>
+	bool run_query(UWorld *world, bool lock_scene, const Query &query) {
+		FPhysScene *scene = world->GetPhysicsScene();
+		if (!lock_scene || !scene) {
+			return query();
+		}
+
+		bool got_hit = false;
+		FPhysicsCommand::ExecuteRead(scene, [&]() { got_hit = query(); });
+		return got_hit;
+	}
+}
+
+bool Collision_Query_Unreal::ray(Vec3 from, Vec3 to, Collision_Hit *out_hit) const {
+	FHitResult 	hit_result;
+	bool 		got_hit = run_query(world, lock_scene, [&]() {
+		return world->LineTraceSingleByChannel(hit_result, to_fvector(from), to_fvector(to), channel, parameters);
+	});
+	
+	fill_hit(hit_result, got_hit, out_hit);
+	return out_hit->blocking;
+}
+
+bool Collision_Query_Unreal::box_sweep(Vec3 from, Vec3 to, Vec3 half_extents, Collision_Hit *out_hit) const {
+	FHitResult 	hit_result;
+	bool 		got_hit = run_query(world, lock_scene, [&]() {
+		return world->SweepSingleByChannel(hit_result, to_fvector(from), to_fvector(to), FQuat::Identity, channel, FCollisionShape::MakeBox(to_fvector(half_extents)), parameters);
+	});
+	
+	fill_hit(hit_result, got_hit, out_hit);
+	if (out_hit->blocking) {
+		// For sweeps we want where box stopped, impact point is on the surface we hit.
+		out_hit->point = to_vec3(hit_result.Location);
+	}
+	return out_hit->blocking;
+}
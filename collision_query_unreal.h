@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+
+#include "collision_query.h"
+
+inline Vec3 to_vec3(const FVector &vector) {
+	return Vec3(vector.X, vector.Y, vector.Z);
+}
+
+inline FVector to_fvector(Vec3 vector) {
+	return FVector(vector.x, vector.y, vector.z);
+}
+
+inline FQuat to_fquat(Quat quat) {
+	return FQuat(quat.x, quat.y, quat.z, quat.w);
+}
+
+inline Quat to_quat(const FQuat &quat) {
+	return Quat(quat.X, quat.Y, quat.Z, quat.W);
+}
+
+// Collision queries through UWorld traces.
+// @note: Game thread moves, adds and removes collision every step. Queries from other threads (path planner workers)
+// need lock_scene, then every query holds physics scene read lock and collision doesn't change in the middle of it.
+// Game thread waits for the lock only while one query runs. Different queries of one search can still see
+// collision moved between them, like traces on different frames do.
+class Collision_Query_Unreal : public Collision_Query {
+public:
+	UWorld 					*world 		= nullptr;
+	FCollisionQueryParams 	parameters;
+	ECollisionChannel 		channel 	= ECC_Visibility;
+	bool 					lock_scene 	= false;
+
+	virtual bool ray(Vec3 from, Vec3 to, Collision_Hit *out_hit) const override;
+	virtual bool box_sweep(Vec3 from, Vec3 to, Vec3 half_extents, Collision_Hit *out_hit) const override;
+};
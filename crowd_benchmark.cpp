@@ -0,0 +1,694 @@
+// Headless crowd stress benchmark, our reference for how many bots a frame can hold.
+// Spawns thousands of agents on a large city map, every agent chases one of several moving objectives:
+// it asks Path_Planner for a path (with the same per frame trace budget bots use), turns to the next path point
+// and walks there with A_Bot's movement model, under the same AI LOD scheduler as A_Bot::Tick().
+// For every agent count and planner thread count it reports:
+// 	- frame time percentiles (game thread work plus waiting for this frame's path searches),
+// 	- memory per agent (our own structures and process resident memory),
+// 	- paths found and objectives caught, so we see that agents are actually doing something.
+//
+// Movement is the same as A_Bot::move_bot(): impulses come from the movement kernel (movement_kernel.h),
+// for all agents that update this frame in one batch, and kinematic mover (kinematic_mover.h) sweeps them there.
+//
+// With --determinism every agent count also runs twice, with one planner thread and with all of them,
+// hashes every agent every frame (determinism.h) and says at what frame runs went apart, if they did.
+// Those runs have no trace budget, like cd.deterministic in game: shares of the budget depend on workers' timing.
+//
+// With --snapshot file every run starts from that world snapshot (world_snapshot.h) instead of fresh agents, so
+// we measure a crowd that is already spread over the map and following paths. If file is not there, crowd of
+// the first --agents count runs --snapshot-frames frames and is saved there first.
+// @note: Objectives walk on with a generator seeded from snapshot step, not where saved run's generator was.
+//
+// Build (no Unreal needed):
+// 	g++ -O2 -std=c++17 -I. crowd_benchmark.cpp determinism.cpp world_snapshot.cpp movement_kernel.cpp kinematic_mover.cpp path_search.cpp search_stats.cpp debug_draw.cpp trace_recorder.cpp worker_pool.cpp path_planner.cpp query_budget.cpp ai_lod.cpp headless_world.cpp headless_bvh.cpp nav_layers.cpp -pthread -o crowd_benchmark
+//
+// Usage:
+// 	crowd_benchmark [--agents 100,1000,10000] [--threads N] [--frames N] [--budget traces] [--seed N] [--no-lod] [--determinism] [--snapshot file] [--snapshot-frames N] [--csv file] [--trace file.json]
+
+#include "headless_world.h"
+#include "headless_bvh.h"
+#include "path_planner.h"
+#include "movement_kernel.h"
+#include "kinematic_mover.h"
+#include "ai_lod.h"
+#include "determinism.h"
+#include "debug_draw.h"
+#include "trace_recorder.h"
+#include "world_snapshot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+	#include <unistd.h>
+#endif
+
+namespace {
+	// Same as A_Bot.
+	float 	collision_size 			= 20.0f;
+	float 	collision_height 		= 92.0f;
+	float 	rotation_speed 			= 300.0f; // Degrees per second, simulate_rotation() input times mouse_design_sensitivity.
+
+	float 	frame_dt 				= 1.0f / 60.0f;
+
+	// City: streets every cell_size, one building in every cell.
+	float 	map_half_size 			= 20000.0f;
+	float 	cell_size 				= 2500.0f;
+	float 	building_height 		= 800.0f;
+
+	int 	objective_count 		= 8;
+	float 	objective_speed 		= 500.0f;
+	float 	replan_distance 		= 1000.0f; 	// Objective moved this far from the goal of our path, ask for a new one.
+	float 	catch_distance 			= 300.0f;
+	float 	retry_time 				= 1.0f; 	// After failed search, so failing agents don't eat the whole budget.
+	float 	stuck_time 				= 2.0f; 	// Walking without getting anywhere, path is no good.
+	float 	view_distance 			= 4000.0f; 	// Agents this close to the player count as visible for LOD and budget.
+
+	struct Objective {
+		Vec3 position;
+		Vec3 target; // Next street crossing.
+	};
+
+	struct Crowd_Agent {
+		Kinematic_Mover_State 	mover; // Position and velocity.
+		float 					yaw = 0; // Degrees, like camera yaw.
+
+		int 	objective 			= 0;
+		bool 	walking 			= false;
+		float 	retry_time_left 	= 0;
+		float 	stuck_time_left 	= 0;
+
+		uint64_t 			ticket 				= 0;
+		Vec3 				ticket_goal;
+		std::vector<Vec3> 	path_points;
+		Vec3 				path_goal;
+		int 				target_path_point 	= 1; // First point is where search started.
+
+		AI_Lod_State lod;
+	};
+
+	struct Crowd_Result {
+		int 	agents 				= 0;
+		int 	threads 			= 0;
+		int 	frames 				= 0;
+		double 	p50 				= 0;
+		double 	p90 				= 0;
+		double 	p99 				= 0;
+		double 	max 				= 0;
+		double 	average_wait 		= 0; // Part of the frame spent waiting for planner workers.
+		double 	agent_bytes 		= 0; // sizeof(Crowd_Agent) and path points, per agent.
+		double 	resident_bytes 		= 0; // Process resident memory growth, per agent. Includes planner jobs.
+		int 	paths_found 		= 0;
+		int 	paths_failed 		= 0;
+		int 	catches 			= 0;
+		int 	updates_per_frame 	= 0;
+	};
+
+	uint64_t resident_memory_bytes() {
+#if defined(__linux__)
+		FILE *file = fopen("/proc/self/statm", "r");
+		if (!file) {
+			return 0;
+		}
+		unsigned long long size = 0, resident = 0;
+		int read_count = fscanf(file, "%llu %llu", &size, &resident);
+		fclose(file);
+		return read_count == 2 ? resident * (uint64_t)sysconf(_SC_PAGESIZE) : 0;
+#else
+		return 0;
+#endif
+	}
+
+	//
+	// Map.
+	//
+
+	int street_count() {
+		return (int)(map_half_size * 2 / cell_size) + 1;
+	}
+
+	float street_position(int index) {
+		return -map_half_size + index * cell_size;
+	}
+
+	void make_city(Headless_World *world, unsigned seed) {
+		world->add_box(Vec3(0, 0, -10), Vec3(map_half_size, map_half_size, 10));
+
+		std::mt19937 level_generator(seed);
+		std::uniform_real_distribution<float> size(500, 850);
+		std::uniform_real_distribution<float> yaw(0, 20);
+
+		// Rotated buildings stay inside their cell, so streets are always free.
+		int cells = street_count() - 1;
+		for (int y = 0; y < cells; ++y) {
+			for (int x = 0; x < cells; ++x) {
+				Vec3 center(street_position(x) + cell_size / 2, street_position(y) + cell_size / 2, building_height / 2);
+				world->add_oriented_box(center, Vec3(size(level_generator), size(level_generator), building_height / 2), yaw(level_generator), 0, 0);
+			}
+		}
+	}
+
+	// Random crossing that is not on the map border.
+	Vec3 random_crossing(std::mt19937 *generator) {
+		std::uniform_int_distribution<int> street(1, street_count() - 2);
+		return Vec3(street_position(street(*generator)), street_position(street(*generator)), collision_height);
+	}
+
+	// Random point on a street.
+	Vec3 random_street_point(std::mt19937 *generator) {
+		std::uniform_int_distribution<int> 		street(1, street_count() - 2);
+		std::uniform_real_distribution<float> 	along(-map_half_size + cell_size, map_half_size - cell_size);
+		if ((*generator)() & 1) {
+			return Vec3(street_position(street(*generator)), along(*generator), collision_height);
+		}
+		return Vec3(along(*generator), street_position(street(*generator)), collision_height);
+	}
+
+	// Objectives walk from crossing to a neighbouring crossing.
+	void move_objective(Objective *objective, std::mt19937 *generator, float dt) {
+		Vec3 	to_target 	= objective->target - objective->position;
+		float 	distance 	= vec3_length_2d(to_target);
+		float 	step 		= objective_speed * dt;
+
+		if (distance > step) {
+			objective->position += to_target * (step / distance);
+			return;
+		}
+
+		objective->position = objective->target;
+
+		int 	direction 	= (*generator)() % 4;
+		Vec3 	offset 		= direction == 0 ? Vec3(cell_size, 0, 0) : direction == 1 ? Vec3(-cell_size, 0, 0) : direction == 2 ? Vec3(0, cell_size, 0) : Vec3(0, -cell_size, 0);
+		Vec3 	next 		= objective->position + offset;
+		float 	limit 		= map_half_size - cell_size;
+		if (std::fabs(next.x) > limit || std::fabs(next.y) > limit) {
+			next = objective->position - offset;
+		}
+		objective->target = next;
+	}
+
+	//
+	// Agent.
+	//
+
+	Vec3 yaw_forward(float yaw) {
+		float radians = yaw * 3.14159265f / 180.0f;
+		return Vec3(std::cos(radians), std::sin(radians), 0);
+	}
+
+	// Impulse from movement kernel, then the same kinematic mover pawns use in game.
+	void move_agent(Crowd_Agent *agent, const Collision_Query &collision, const Kinematic_Mover_Params &mover_params, Vec3 impulse, float dt) {
+		agent->mover.velocity += impulse;
+		kinematic_mover_move(collision, mover_params, &agent->mover, dt);
+	}
+
+	void submit_path(Path_Planner *planner, Crowd_Agent *agent, const Collision_Query *collision, Vec3 goal, uint32_t seed, float distance_to_player) {
+		if (agent->ticket != 0) {
+			path_planner_cancel(planner, agent->ticket);
+		}
+
+		Path_Request request;
+		request.start 				= agent->mover.position;
+		request.goal 				= goal;
+		request.half_extents 		= Vec3(collision_size, collision_size, collision_height);
+		request.collision 			= collision;
+		request.seed 				= seed;
+		request.distance_to_player 	= distance_to_player;
+		request.visible 			= distance_to_player < view_distance;
+
+		agent->ticket 		= path_planner_submit(planner, request);
+		agent->ticket_goal 	= goal;
+	}
+
+	// What A_Bot does in simulate_intelligence(): take finished path, ask for a new one when objective ran away,
+	// turn to the next path point (simulate_rotation()) and walk to it (simulate_walking()).
+	void think_agent(Path_Planner *planner, Crowd_Agent *agent, const Collision_Query *collision, Vec3 objective, float distance_to_player, uint32_t seed, float dt, Crowd_Result *result) {
+		if (agent->ticket != 0) {
+			Path_Result path_result;
+			if (path_planner_take(planner, agent->ticket, &path_result)) {
+				agent->ticket = 0;
+				if (path_result.search.found_path && path_result.search.path_points.size() > 1) {
+					agent->path_points.assign(path_result.search.path_points.begin(), path_result.search.path_points.end());
+					agent->path_goal 			= agent->ticket_goal;
+					agent->target_path_point 	= 1;
+					agent->stuck_time_left 		= stuck_time;
+					++result->paths_found;
+				} else {
+					agent->retry_time_left = retry_time;
+					++result->paths_failed;
+				}
+			} else {
+				path_planner_update_priority(planner, agent->ticket, distance_to_player, distance_to_player < view_distance);
+			}
+		}
+
+		agent->retry_time_left -= dt;
+
+		bool 	has_path 		= !agent->path_points.empty();
+		float 	objective_distance = vec3_distance_2d(agent->mover.position, objective);
+		bool 	path_is_old 	= has_path && vec3_distance_2d(agent->path_goal, objective) > replan_distance;
+		if (objective_distance > catch_distance && (!has_path || path_is_old) && agent->ticket == 0 && agent->retry_time_left <= 0) {
+			submit_path(planner, agent, collision, objective, seed, distance_to_player);
+		}
+
+		bool was_walking 	= agent->walking;
+		agent->walking 		= false;
+		if (!has_path) {
+			return;
+		}
+
+		Vec3 	point 		= agent->path_points[agent->target_path_point];
+		Vec3 	to_point 	= point - agent->mover.position;
+		to_point.z 			= 0;
+
+		// Reached path point, or walked past it.
+		if (vec3_length_squared(to_point) < 1.0f || (was_walking && vec3_dot(yaw_forward(agent->yaw), to_point) < 0)) {
+			++agent->target_path_point;
+			agent->stuck_time_left = stuck_time;
+			if (agent->target_path_point >= (int)agent->path_points.size()) {
+				agent->path_points.clear();
+				if (objective_distance <= catch_distance) {
+					++result->catches;
+				}
+			}
+			return;
+		}
+
+		// Turn first, walk when we look at the point.
+		float point_yaw 	= std::atan2(to_point.y, to_point.x) * 180.0f / 3.14159265f;
+		float yaw_delta 	= std::remainder(point_yaw - agent->yaw, 360.0f);
+		float turn 			= rotation_speed * dt;
+		if (std::fabs(yaw_delta) > turn) {
+			agent->yaw += yaw_delta > 0 ? turn : -turn;
+			return;
+		}
+		agent->yaw 		= point_yaw;
+		agent->walking 	= true;
+
+		// Wall ate our speed and we still aren't there, give up on this path.
+		agent->stuck_time_left -= dt;
+		if (agent->stuck_time_left <= 0) {
+			agent->path_points.clear();
+		}
+	}
+
+	uint64_t hash_agents(const std::vector<Crowd_Agent> &agents) {
+		State_Hash hash;
+		for (const Crowd_Agent &agent : agents) {
+			state_hash_vec3(&hash, agent.mover.position);
+			state_hash_vec3(&hash, agent.mover.velocity);
+			state_hash_float(&hash, agent.yaw);
+			state_hash_int(&hash, agent.walking);
+			state_hash_int(&hash, agent.ticket != 0);
+			state_hash_int(&hash, (int64_t)agent.path_points.size());
+			state_hash_int(&hash, agent.target_path_point);
+		}
+		return hash.value;
+	}
+
+	void save_crowd(const std::vector<Objective> &objectives, const std::vector<Crowd_Agent> &agents, uint64_t frame, unsigned seed, World_Snapshot *snapshot) {
+		*snapshot 		= World_Snapshot();
+		snapshot->step 	= frame;
+		snapshot->seed 	= seed;
+
+		for (const Objective &objective : objectives) {
+			snapshot->objectives.push_back({objective.position, objective.target});
+		}
+
+		for (size_t i = 0; i < agents.size(); ++i) {
+			const Crowd_Agent &agent = agents[i];
+
+			Snapshot_Pawn pawn;
+			pawn.id 				= (uint64_t)i;
+			pawn.position 			= agent.mover.position;
+			pawn.velocity 			= agent.mover.velocity;
+			pawn.ground_normal 		= agent.mover.ground_normal;
+			pawn.grounded 			= agent.mover.grounded;
+			pawn.yaw 				= agent.yaw;
+			pawn.objective 			= agent.objective;
+			pawn.lod_tier 			= agent.lod.tier;
+			pawn.lod_phase 			= agent.lod.phase;
+			pawn.lod_accumulated_dt = agent.lod.accumulated_dt;
+			pawn.flags 				= agent.walking ? (uint32_t)SNAPSHOT_WALKING : 0;
+			snapshot->pawns.push_back(pawn);
+
+			Snapshot_Path *path 	= world_snapshot_add_path(snapshot, agent.path_points.data(), (int)agent.path_points.size(), nullptr, 0, nullptr, 0);
+			path->pawn_id 			= (uint64_t)i;
+			path->target_point 		= agent.target_path_point;
+			path->goal 				= agent.path_goal;
+			path->retry_time_left 	= agent.retry_time_left;
+			path->stuck_time_left 	= agent.stuck_time_left;
+			path->flags 			= agent.path_points.empty() ? 0 : (uint32_t)SNAPSHOT_PATH_FOUND;
+		}
+	}
+
+	// Searches that were running when it was saved are gone, those agents ask again.
+	void load_crowd(const World_Snapshot_View &view, std::vector<Objective> *objectives, std::vector<Crowd_Agent> *agents) {
+		objectives->resize(view.objective_count);
+		for (int i = 0; i < view.objective_count; ++i) {
+			(*objectives)[i].position 	= view.objectives[i].position;
+			(*objectives)[i].target 	= view.objectives[i].target;
+		}
+
+		agents->assign(view.pawn_count, Crowd_Agent());
+		for (int i = 0; i < view.pawn_count; ++i) {
+			const Snapshot_Pawn &pawn 	= view.pawns[i];
+			Crowd_Agent &agent 			= (*agents)[i];
+			agent.mover.position 		= pawn.position;
+			agent.mover.velocity 		= pawn.velocity;
+			agent.mover.ground_normal 	= pawn.ground_normal;
+			agent.mover.grounded 		= pawn.grounded != 0;
+			agent.yaw 					= pawn.yaw;
+			agent.objective 			= std::min(std::max(pawn.objective, 0), std::max(view.objective_count - 1, 0));
+			agent.lod.tier 				= pawn.lod_tier;
+			agent.lod.phase 			= pawn.lod_phase;
+			agent.lod.accumulated_dt 	= pawn.lod_accumulated_dt;
+			agent.walking 				= (pawn.flags & SNAPSHOT_WALKING) != 0;
+
+			const Snapshot_Path *path = view.path_count == view.pawn_count && view.paths[i].pawn_id == pawn.id ? &view.paths[i] : world_snapshot_find_path(view, pawn.id);
+			if (path) {
+				agent.path_points.assign(view.path_points + path->first_point, view.path_points + path->first_point + path->point_count);
+				agent.target_path_point = path->target_point;
+				agent.path_goal 		= path->goal;
+				agent.retry_time_left 	= path->retry_time_left;
+				agent.stuck_time_left 	= path->stuck_time_left;
+				if (agent.target_path_point < 1 || agent.target_path_point >= (int)agent.path_points.size()) {
+					agent.path_points.clear();
+				}
+			}
+		}
+	}
+
+	double percentile(const std::vector<double> &sorted, double fraction) {
+		if (sorted.empty()) {
+			return 0;
+		}
+		size_t index = std::min(sorted.size() - 1, (size_t)(fraction * sorted.size()));
+		return sorted[index];
+	}
+
+	Crowd_Result run_crowd(const Headless_Bvh &bvh, const Path_Search_Config &config, int agent_count, int threads, int frames, int budget, bool use_lod, unsigned seed, Determinism_Log *log = nullptr,
+		const World_Snapshot_View *start = nullptr, World_Snapshot *out_end = nullptr) {
+		Crowd_Result result;
+		result.agents 	= agent_count;
+		result.threads 	= threads;
+		result.frames 	= frames;
+
+		uint64_t resident_before = resident_memory_bytes();
+
+		uint64_t 		first_frame = start ? start->header->step : 0;
+		std::mt19937 	generator(seed + (unsigned)first_frame);
+
+		Kinematic_Mover_Params 		mover_params;
+		std::vector<Objective> 		objectives;
+		std::vector<Crowd_Agent> 	agents;
+		if (start) {
+			load_crowd(*start, &objectives, &agents);
+			result.agents = agent_count = (int)agents.size();
+		} else {
+			objectives.resize(objective_count);
+			for (Objective &objective : objectives) {
+				objective.position 	= random_crossing(&generator);
+				objective.target 	= objective.position;
+			}
+
+			agents.resize(agent_count);
+			for (int i = 0; i < agent_count; ++i) {
+				agents[i].mover.position 	= random_street_point(&generator) + Vec3(0, 0, 10);
+				agents[i].yaw 				= (float)(generator() % 360);
+				agents[i].objective 		= i % objective_count;
+				agents[i].lod.phase 		= i;
+				kinematic_mover_snap_to_ground(bvh, mover_params, &agents[i].mover, 50);
+			}
+		}
+
+		Path_Planner planner;
+		planner.config 					= config;
+		planner.budget.traces_per_frame = budget;
+		path_planner_start(&planner, threads);
+
+		AI_Lod_Params 		lod_params;
+		Movement_Params 	movement_params;
+		Movement_Batch 		movement_batch;
+		std::vector<Crowd_Agent *> moved_agents; // Agent of every movement slot.
+		std::vector<double> frame_milliseconds;
+		double 				wait_milliseconds 	= 0;
+		uint64_t 			updates 			= 0;
+		uint32_t 			next_seed 			= seed;
+
+		for (int frame = 0; frame < frames; ++frame) {
+			trace_scope("crowd_frame");
+			std::chrono::steady_clock::time_point frame_start = std::chrono::steady_clock::now();
+
+			for (Objective &objective : objectives) {
+				move_objective(&objective, &generator, frame_dt);
+			}
+
+			// Player is whoever first objective is, LOD and budget priority are distances to it.
+			Vec3 player = objectives[0].position;
+
+			path_planner_begin_frame(&planner);
+
+			movement_batch_clear(&movement_batch);
+			moved_agents.clear();
+
+			{
+				trace_scope("crowd_agents");
+				for (Crowd_Agent &agent : agents) {
+					float 	distance_to_player 	= vec3_distance_2d(agent.mover.position, player);
+					float 	dt 					= frame_dt;
+					if (use_lod) {
+						agent.lod.tier = ai_lod_choose_tier(lod_params, agent.lod.tier, distance_to_player, distance_to_player < view_distance);
+						if (!ai_lod_should_update(&agent.lod, lod_params, first_frame + frame, frame_dt, &dt)) {
+							continue;
+						}
+					}
+
+					++updates;
+					think_agent(&planner, &agent, &bvh, objectives[agent.objective].position, distance_to_player, ++next_seed, dt, &result);
+
+					Vec3 forward = yaw_forward(agent.yaw);
+					movement_batch_add(&movement_batch, movement_params, forward.x, forward.y, agent.mover.velocity.x, agent.mover.velocity.y, agent.walking ? (uint32_t)MOVEMENT_FORWARD : 0, dt);
+					moved_agents.push_back(&agent);
+				}
+			}
+
+			{
+				trace_scope("crowd_move");
+				movement_batch_run(movement_params, &movement_batch);
+				for (int i = 0; i < movement_batch.count; ++i) {
+					Vec3 impulse(movement_batch.impulse_x[i], movement_batch.impulse_y[i], movement_batch.impulse_z[i]);
+					move_agent(moved_agents[i], bvh, mover_params, impulse, movement_batch.dt[i]);
+				}
+			}
+
+			// Frame isn't done until this frame's share of searches is, with budget the rest waits for next frame.
+			std::chrono::steady_clock::time_point wait_start = std::chrono::steady_clock::now();
+			{
+				trace_scope("crowd_wait_planner");
+				path_planner_wait(&planner);
+			}
+			std::chrono::steady_clock::time_point frame_end = std::chrono::steady_clock::now();
+
+			if (log) {
+				determinism_log_add(log, (uint64_t)frame, hash_agents(agents));
+			}
+
+			frame_milliseconds.push_back(std::chrono::duration<double, std::milli>(frame_end - frame_start).count());
+			wait_milliseconds += std::chrono::duration<double, std::milli>(frame_end - wait_start).count();
+		}
+
+		uint64_t resident_after = resident_memory_bytes();
+
+		if (out_end) {
+			save_crowd(objectives, agents, first_frame + frames, seed, out_end);
+		}
+
+		size_t path_bytes = 0;
+		for (const Crowd_Agent &agent : agents) {
+			path_bytes += agent.path_points.capacity() * sizeof(Vec3);
+		}
+
+		path_planner_stop(&planner);
+
+		std::sort(frame_milliseconds.begin(), frame_milliseconds.end());
+		result.p50 					= percentile(frame_milliseconds, 0.50);
+		result.p90 					= percentile(frame_milliseconds, 0.90);
+		result.p99 					= percentile(frame_milliseconds, 0.99);
+		result.max 					= frame_milliseconds.empty() ? 0 : frame_milliseconds.back();
+		result.average_wait 		= frames > 0 ? wait_milliseconds / frames : 0;
+		result.agent_bytes 			= sizeof(Crowd_Agent) + (double)path_bytes / std::max(agent_count, 1);
+		result.resident_bytes 		= resident_after > resident_before ? (double)(resident_after - resident_before) / std::max(agent_count, 1) : 0;
+		result.updates_per_frame 	= frames > 0 ? (int)(updates / frames) : 0;
+		return result;
+	}
+}
+
+int main(int argument_count, char **arguments) {
+	std::vector<int> 	agent_counts 	= {100, 1000, 10000};
+	int 				max_threads 	= (int)std::max(1u, std::thread::hardware_concurrency());
+	int 				frames 			= 300;
+	int 				budget 			= 4000; // cd.ai_traces_per_frame default.
+	unsigned 			seed 			= 1;
+	bool 				use_lod 		= true;
+	bool 				check_hashes 	= false;
+	const char 			*csv_path 		= nullptr;
+	const char 			*trace_path 	= nullptr;
+	const char 			*snapshot_path 	= nullptr;
+	int 				snapshot_frames = 600;
+
+	// Nobody flushes lines here, and we don't want to time them anyway.
+	debug_draw.enabled_categories = 0;
+
+	for (int i = 1; i < argument_count; ++i) {
+		bool has_value = i + 1 < argument_count;
+
+		if (!strcmp(arguments[i], "--agents") && has_value) {
+			agent_counts.clear();
+			for (const char *value = arguments[++i]; value; value = strchr(value, ',')) {
+				value += *value == ',' ? 1 : 0;
+				agent_counts.push_back(atoi(value));
+			}
+		} else if (!strcmp(arguments[i], "--threads") && has_value) {
+			max_threads = std::max(1, atoi(arguments[++i]));
+		} else if (!strcmp(arguments[i], "--frames") && has_value) {
+			frames = atoi(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--budget") && has_value) {
+			budget = atoi(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--seed") && has_value) {
+			seed = (unsigned)strtoul(arguments[++i], nullptr, 10);
+		} else if (!strcmp(arguments[i], "--no-lod")) {
+			use_lod = false;
+		} else if (!strcmp(arguments[i], "--determinism")) {
+			check_hashes = true;
+		} else if (!strcmp(arguments[i], "--snapshot") && has_value) {
+			snapshot_path = arguments[++i];
+		} else if (!strcmp(arguments[i], "--snapshot-frames") && has_value) {
+			snapshot_frames = atoi(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--csv") && has_value) {
+			csv_path = arguments[++i];
+		} else if (!strcmp(arguments[i], "--trace") && has_value) {
+			trace_path = arguments[++i];
+		} else {
+			printf("Unknown argument: %s\n", arguments[i]);
+			return 1;
+		}
+	}
+
+	Headless_World world;
+	make_city(&world, seed);
+
+	Headless_Bvh bvh;
+	bvh.build(&world);
+
+	Path_Search_Config config;
+	config.collision_size 	= collision_size;
+	config.collision_height = collision_height;
+
+	// Snapshot stays mapped for all runs, every run reads its agents from it.
+	World_Snapshot_File snapshot_file;
+	const World_Snapshot_View *start = nullptr;
+	if (snapshot_path) {
+		std::chrono::steady_clock::time_point open_start = std::chrono::steady_clock::now();
+		if (!world_snapshot_open(&snapshot_file, snapshot_path)) {
+			int warmup_agents = agent_counts.empty() ? 1000 : agent_counts[0];
+			printf("No snapshot in %s (%s), running %d agents for %d frames to make it.\n", snapshot_path, snapshot_file.view.error, warmup_agents, snapshot_frames);
+
+			World_Snapshot snapshot;
+			run_crowd(bvh, config, warmup_agents, max_threads, snapshot_frames, budget, use_lod, seed, nullptr, nullptr, &snapshot);
+
+			std::chrono::steady_clock::time_point save_start = std::chrono::steady_clock::now();
+			if (!world_snapshot_write(snapshot, snapshot_path)) {
+				printf("Can't write %s\n", snapshot_path);
+				return 1;
+			}
+			printf("Saved %d agents, %d path points in %.3f ms.\n", (int)snapshot.pawns.size(), (int)snapshot.path_points.size(),
+				std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - save_start).count());
+
+			open_start = std::chrono::steady_clock::now();
+			if (!world_snapshot_open(&snapshot_file, snapshot_path)) {
+				printf("Can't load %s: %s\n", snapshot_path, snapshot_file.view.error);
+				return 1;
+			}
+		}
+
+		start = &snapshot_file.view;
+		printf("Snapshot %s: step %llu, %d agents, %.1f KB, mapped in %.3f ms.\n", snapshot_path, (unsigned long long)start->header->step,
+			start->pawn_count, snapshot_file.size / 1024.0, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - open_start).count());
+
+		// Agent count is what snapshot has.
+		agent_counts = {start->pawn_count};
+	}
+
+	FILE *csv = csv_path ? fopen(csv_path, "w") : nullptr;
+	if (csv) {
+		fprintf(csv, "agents,threads,frames,p50_ms,p90_ms,p99_ms,max_ms,wait_ms,updates_per_frame,agent_bytes,resident_bytes_per_agent,paths_found,paths_failed,catches\n");
+	}
+
+	if (trace_path) {
+		trace_recorder_set_thread_name("Benchmark");
+		trace_recorder_start();
+	}
+
+	printf("%d buildings, %.0f m map, %d frames, budget %d traces/frame, lod %s\n\n", (int)world.boxes.size() - 1, map_half_size * 2 / 100, frames, budget, use_lod ? "on" : "off");
+	printf("%7s %7s %8s %8s %8s %8s %8s %8s %9s %9s %7s %7s %7s %8s\n", "agents", "threads", "p50 ms", "p90 ms", "p99 ms", "max ms", "wait ms", "speedup", "updates", "B/agent", "RSS/ag", "paths", "failed", "catches");
+	for (int agent_count : agent_counts) {
+		if (agent_count <= 0) {
+			continue;
+		}
+
+		double one_thread_p50 = 0;
+		for (int threads = 1; threads <= max_threads; threads *= 2) {
+			Crowd_Result result = run_crowd(bvh, config, agent_count, threads, frames, budget, use_lod, seed, nullptr, start);
+			if (threads == 1) {
+				one_thread_p50 = result.p50;
+			}
+
+			printf("%7d %7d %8.2f %8.2f %8.2f %8.2f %8.2f %7.2fx %9d %9.0f %7.0f %7d %7d %8d\n", result.agents, result.threads,
+				result.p50, result.p90, result.p99, result.max, result.average_wait, result.p50 > 0 ? one_thread_p50 / result.p50 : 0,
+				result.updates_per_frame, result.agent_bytes, result.resident_bytes, result.paths_found, result.paths_failed, result.catches);
+
+			if (csv) {
+				fprintf(csv, "%d,%d,%d,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%.1f,%.1f,%d,%d,%d\n", result.agents, result.threads, result.frames,
+					result.p50, result.p90, result.p99, result.max, result.average_wait, result.updates_per_frame,
+					result.agent_bytes, result.resident_bytes, result.paths_found, result.paths_failed, result.catches);
+			}
+		}
+
+		if (check_hashes) {
+			Determinism_Log one_thread, all_threads;
+			run_crowd(bvh, config, agent_count, 1, frames, 0, use_lod, seed, &one_thread, start);
+			run_crowd(bvh, config, agent_count, max_threads, frames, 0, use_lod, seed, &all_threads, start);
+
+			int64_t frame = determinism_log_first_divergence(one_thread, all_threads);
+			if (frame < 0) {
+				printf("%7d agents: same state hashes in all %d frames with 1 and %d threads\n", agent_count, frames, max_threads);
+			} else {
+				printf("%7d agents: state diverged at frame %lld between 1 and %d threads\n", agent_count, (long long)frame, max_threads);
+			}
+		}
+	}
+
+	if (csv) {
+		fclose(csv);
+	}
+
+	world_snapshot_close(&snapshot_file);
+
+	if (trace_path) {
+		trace_recorder_stop();
+		if (!trace_recorder_write_chrome_json(trace_path)) {
+			printf("Can't write %s\n", trace_path);
+		}
+	}
+
+	return 0;
+}
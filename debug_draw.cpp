@@ -0,0 +1,98 @@
+#include "debug_draw.h"
+
+#include <cstdio>
+#include <cstring>
+
+Debug_Draw debug_draw;
+
+namespace {
+	struct Named_Category {
+		const char 	*name;
+		uint32_t 	category;
+	};
+
+	Named_Category named_categories[] = {
+		{"search_fan", 	DEBUG_DRAW_SEARCH_FAN},
+		{"path", 		DEBUG_DRAW_PATH},
+		{"search", 		DEBUG_DRAW_SEARCH},
+		{"raycast", 	DEBUG_DRAW_RAYCAST},
+	};
+
+	thread_local bool this_thread_muted = false;
+}
+
+void debug_draw_mute_this_thread() {
+	this_thread_muted = true;
+}
+
+void debug_draw_add_line(uint32_t category, Vec3 from, Vec3 to, uint32_t color, bool persistent) {
+	if (this_thread_muted) {
+		return;
+	}
+
+	Debug_Line line;
+	line.from 		= from;
+	line.to 		= to;
+	line.color 		= color;
+	line.category 	= category;
+
+	if (!persistent) {
+		debug_draw.frame_lines.push_back(line);
+		return;
+	}
+
+	if ((int)debug_draw.persistent_lines.size() < debug_draw.max_persistent_lines) {
+		debug_draw.persistent_lines.push_back(line);
+		return;
+	}
+
+	if (debug_draw.persistent_lines.empty()) {
+		return; // Persistent lines are turned off.
+	}
+
+	// Full, replace the oldest one.
+	if (debug_draw.next_persistent_line >= (int)debug_draw.persistent_lines.size()) {
+		debug_draw.next_persistent_line = 0;
+	}
+	debug_draw.persistent_lines[debug_draw.next_persistent_line] = line;
+	++debug_draw.next_persistent_line;
+}
+
+void debug_draw_clear_persistent(uint32_t categories) {
+	std::vector<Debug_Line> &lines = debug_draw.persistent_lines;
+
+	size_t kept = 0;
+	for (size_t i = 0; i < lines.size(); ++i) {
+		if ((lines[i].category & categories) == 0) {
+			lines[kept] = lines[i];
+			++kept;
+		}
+	}
+	lines.resize(kept);
+
+	// Order is gone after removing, so just start replacing from the beginning again.
+	debug_draw.next_persistent_line = 0;
+}
+
+uint32_t debug_draw_category_from_name(const char *name) {
+	if (strcmp(name, "all") == 0) {
+		return DEBUG_DRAW_ALL;
+	}
+	for (const Named_Category &named : named_categories) {
+		if (strcmp(name, named.name) == 0) {
+			return named.category;
+		}
+	}
+	return 0;
+}
+
+void debug_draw_report(std::vector<std::string> *out_lines) {
+	char line[256];
+	for (const Named_Category &named : named_categories) {
+		snprintf(line, sizeof(line), "%-12s %s", named.name, debug_draw_enabled(named.category) ? "on" : "off");
+		out_lines->push_back(line);
+	}
+	snprintf(line, sizeof(line), "Lines: %d this frame, %d of %d persistent.",
+		(int)debug_draw.frame_lines.size(), (int)debug_draw.persistent_lines.size(), debug_draw.max_persistent_lines);
+	out_lines->push_back(line);
+}
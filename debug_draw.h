@@ -0,0 +1,81 @@
+#pragma once
+
+// Buffered debug lines. Code adds lines with debug_line(), they are kept here and sent to the engine
+// once per frame by debug_draw_flush() (debug_draw_unreal.h), so nothing in the hot path talks to the renderer.
+//
+// Every line has a category, categories can be switched at runtime (cd.debug_draw console command).
+// debug_line() is a macro that checks the category first, so with category off arguments aren't even computed,
+// it's one load and one branch. With CD_DEBUG_DRAW set to 0 it's nothing at all.
+//
+// Persistent lines go to a ring buffer: when it's full, the oldest line is replaced. They used to live 10000 seconds
+// each and pile up until frame time was mostly debug lines.
+//
+// @note: Not thread safe. Draw from the game thread only, worker threads mute themselves with debug_draw_mute_this_thread().
+
+#include "cd_math.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#ifndef CD_DEBUG_DRAW
+	#if defined(UE_BUILD_SHIPPING) && UE_BUILD_SHIPPING
+		#define CD_DEBUG_DRAW 0
+	#else
+		#define CD_DEBUG_DRAW 1
+	#endif
+#endif
+
+enum Debug_Draw_Category : uint32_t {
+	DEBUG_DRAW_SEARCH_FAN 	= 1 << 0, // Every ray of rotation search, up to 361 per find_path_point().
+	DEBUG_DRAW_PATH 		= 1 << 1, // Path points and lines between them.
+	DEBUG_DRAW_SEARCH 		= 1 << 2, // Straight line checks to final point and joined search sides.
+	DEBUG_DRAW_RAYCAST 		= 1 << 3, // Ground rays of player and bots.
+
+	DEBUG_DRAW_ALL 			= 0xFFFFFFFF,
+};
+
+struct Debug_Line {
+	Vec3 		from;
+	Vec3 		to;
+	uint32_t 	color 		= 0; // 0xRRGGBB.
+	uint32_t 	category 	= 0;
+};
+
+struct Debug_Draw {
+	// Search fan is off by default, it's most of the lines and most of the cost.
+	uint32_t enabled_categories = DEBUG_DRAW_PATH | DEBUG_DRAW_SEARCH | DEBUG_DRAW_RAYCAST;
+
+	std::vector<Debug_Line> frame_lines; 		// Cleared by every flush.
+	std::vector<Debug_Line> persistent_lines; 	// Ring buffer, drawn every frame until cleared or replaced.
+	int 					next_persistent_line 	= 0;
+	int 					max_persistent_lines 	= 4096;
+};
+
+extern Debug_Draw debug_draw;
+
+inline bool debug_draw_enabled(uint32_t category) {
+	return (debug_draw.enabled_categories & category) != 0;
+}
+
+// Use debug_line() instead, it skips this call when category is off.
+void debug_draw_add_line(uint32_t category, Vec3 from, Vec3 to, uint32_t color, bool persistent);
+
+#if CD_DEBUG_DRAW
+	#define debug_line(category, from, to, color, persistent) \
+		do { if (debug_draw_enabled(category)) { debug_draw_add_line((category), (from), (to), (color), (persistent)); } } while (0)
+#else
+	#define debug_line(category, from, to, color, persistent) do {} while (0)
+#endif
+
+// Lines added from this thread are dropped from now on. Worker threads call it, buffers are for the game thread only.
+void debug_draw_mute_this_thread();
+
+// Removes persistent lines of these categories.
+void debug_draw_clear_persistent(uint32_t categories);
+
+// Category by name ("search_fan", "path", "search", "raycast", "all"). Returns zero if there is no such category.
+uint32_t debug_draw_category_from_name(const char *name);
+
+// One line per category with its name and whether it's on, for console.
+void debug_draw_report(std::vector<std::string> *out_lines);
@@ -0,0 +1,78 @@
+#include "debug_draw_unreal.h"
+
+#include "Components/LineBatchComponent.h"
+#include "HAL/IConsoleManager.h" // For console commands.
+
+#include "collision_query_unreal.h"
+
+#include "cd_core/log.h"
+
+namespace {
+	const float line_thickness = 1.2f;
+
+	uint64 flushed_frame = UINT64_MAX;
+	TArray<FBatchedLine> batched_lines;
+
+	FLinearColor to_linear_color(uint32_t color) {
+		return FLinearColor(FColor((color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF));
+	}
+
+	void add_batched_lines(const std::vector<Debug_Line> &lines, float life_time) {
+		for (const Debug_Line &line : lines) {
+			// Category could have been turned off after line was added.
+			if (debug_draw_enabled(line.category)) {
+				batched_lines.Add(FBatchedLine(to_fvector(line.from), to_fvector(line.to), to_linear_color(line.color), life_time, line_thickness, 0));
+			}
+		}
+	}
+
+	void debug_draw_command(const TArray<FString> &arguments) {
+		if (arguments.Num() == 1 && arguments[0] == TEXT("clear")) {
+			debug_draw_clear_persistent(DEBUG_DRAW_ALL);
+		} else if (arguments.Num() == 2) {
+			uint32_t category = debug_draw_category_from_name(TCHAR_TO_UTF8(*arguments[0]));
+			if (category == 0) {
+				UE_LOG(Log_CD_Core, Warning, TEXT("No debug draw category %s."), *arguments[0]);
+				return;
+			}
+
+			if (arguments[1] == TEXT("1")) {
+				debug_draw.enabled_categories |= category;
+			} else {
+				debug_draw.enabled_categories &= ~category;
+				debug_draw_clear_persistent(category);
+			}
+		}
+
+		std::vector<std::string> lines;
+		debug_draw_report(&lines);
+		for (const std::string &line : lines) {
+			UE_LOG(Log_CD_Core, Log, TEXT("%s"), UTF8_TO_TCHAR(line.c_str()));
+		}
+	}
+
+	FAutoConsoleCommand debug_draw_console_command(
+		TEXT("cd.debug_draw"),
+		TEXT("Debug line categories. No arguments prints them, \"<category> 0|1\" turns category off or on (\"all\" is every category), \"clear\" removes persistent lines."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&debug_draw_command));
+}
+
+bool debug_draw_flush(UWorld *world, uint64 engine_frame) {
+	if (flushed_frame == engine_frame || !world || !world->LineBatcher) {
+		return false;
+	}
+	flushed_frame = engine_frame;
+
+	ULineBatchComponent *line_batcher = world->LineBatcher;
+
+	// Lines in this batcher are cleared by the world every frame, like DrawDebugLine() with no life time.
+	batched_lines.Reset();
+	add_batched_lines(debug_draw.frame_lines, line_batcher->DefaultLifeTime);
+	add_batched_lines(debug_draw.persistent_lines, line_batcher->DefaultLifeTime);
+	debug_draw.frame_lines.clear();
+
+	if (batched_lines.Num() > 0) {
+		line_batcher->DrawLines(batched_lines);
+	}
+	return true;
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/World.h"
+
+#include "debug_draw.h"
+
+// Sends buffered debug lines to the world line batcher in one call. Only the first call in a frame does it,
+// returns if it was us. Player and bots call it at the start of their tick, whoever ticks first draws what
+// everybody added last frame, so lines show up one frame late.
+bool debug_draw_flush(UWorld *world, uint64 engine_frame);
@@ -0,0 +1,125 @@
+#include "determinism.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+Determinism determinism;
+
+namespace {
+	uint64_t mix(uint64_t value) {
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+		return value ^ (value >> 31);
+	}
+}
+
+Random_Stream random_stream_make(uint64_t world_seed, uint64_t entity_id) {
+	Random_Stream stream;
+	stream.state = mix(world_seed) ^ mix(entity_id + 0x9E3779B97F4A7C15ull);
+	return stream;
+}
+
+uint32_t random_stream_next(Random_Stream *stream) {
+	stream->state += 0x9E3779B97F4A7C15ull;
+	return (uint32_t)(mix(stream->state) >> 32);
+}
+
+int random_stream_range(Random_Stream *stream, int min, int max) {
+	if (max <= min) {
+		return min;
+	}
+	return min + (int)(random_stream_next(stream) % (uint32_t)(max - min + 1));
+}
+
+uint64_t determinism_id_from_name(const char *name) {
+	State_Hash hash;
+	for (const char *c = name; *c; ++c) {
+		state_hash_bytes(&hash, c, 1);
+	}
+	return hash.value;
+}
+
+void state_hash_bytes(State_Hash *hash, const void *data, size_t size) {
+	const unsigned char *bytes = (const unsigned char *)data;
+	for (size_t i = 0; i < size; ++i) {
+		hash->value ^= bytes[i];
+		hash->value *= 1099511628211ull;
+	}
+}
+
+void determinism_log_add(Determinism_Log *log, uint64_t step, uint64_t hash) {
+	if (log->step_hashes.empty()) {
+		log->first_step = step;
+	}
+	if (step < log->first_step) {
+		return;
+	}
+
+	size_t index = (size_t)(step - log->first_step);
+	if (index >= log->step_hashes.size()) {
+		log->step_hashes.resize(index + 1, 0);
+	}
+
+	// Parts are mixed before the sum, so two parts swapping their state doesn't give the same hash.
+	log->step_hashes[index] += mix(hash);
+}
+
+void determinism_log_clear(Determinism_Log *log) {
+	log->first_step = 0;
+	log->step_hashes.clear();
+}
+
+int64_t determinism_log_first_divergence(const Determinism_Log &a, const Determinism_Log &b) {
+	uint64_t first 	= a.first_step > b.first_step ? a.first_step : b.first_step;
+	uint64_t end_a 	= a.first_step + a.step_hashes.size();
+	uint64_t end_b 	= b.first_step + b.step_hashes.size();
+	uint64_t end 	= end_a < end_b ? end_a : end_b;
+
+	for (uint64_t step = first; step < end; ++step) {
+		if (a.step_hashes[step - a.first_step] != b.step_hashes[step - b.first_step]) {
+			return (int64_t)step;
+		}
+	}
+	return -1;
+}
+
+bool determinism_log_write_csv(const Determinism_Log &log, const std::string &path) {
+	FILE *file = fopen(path.c_str(), "w");
+	if (!file) {
+		return false;
+	}
+
+	fprintf(file, "step,hash\n");
+	for (size_t i = 0; i < log.step_hashes.size(); ++i) {
+		fprintf(file, "%" PRIu64 ",%016" PRIx64 "\n", log.first_step + i, log.step_hashes[i]);
+	}
+
+	fclose(file);
+	return true;
+}
+
+bool determinism_log_read_csv(Determinism_Log *log, const std::string &path) {
+	FILE *file = fopen(path.c_str(), "r");
+	if (!file) {
+		return false;
+	}
+
+	determinism_log_clear(log);
+
+	char line[128];
+	while (fgets(line, sizeof(line), file)) {
+		uint64_t step, hash;
+		if (sscanf(line, "%" SCNu64 ",%" SCNx64, &step, &hash) == 2) {
+			if (log->step_hashes.empty()) {
+				log->first_step = step;
+			}
+			if (step >= log->first_step) {
+				log->step_hashes.resize((size_t)(step - log->first_step) + 1, 0);
+				log->step_hashes[step - log->first_step] = hash;
+			}
+		}
+	}
+
+	fclose(file);
+	return true;
+}
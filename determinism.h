@@ -0,0 +1,83 @@
+#pragma once
+
+// Deterministic mode: same input gives the same simulation, step for step.
+//
+// 	- every entity has its own random stream, seeded from world seed and entity id, instead of global FMath::RandRange,
+// 	- simulation runs in fixed steps (fixed_step.h), entities update in id order,
+// 	- every step all pawn and AI state is hashed into the log, so two runs can be compared step by step.
+//
+// 	State_Hash hash;
+// 	state_hash_vec3(&hash, mover.position);
+// 	determinism_log_add(&determinism.log, step, hash.value);
+//
+// Step hash is a sum of hashes of its parts, so it doesn't matter whether player or bots ticked first in a frame.
+// Hashes are of raw float bits, so they only match on the same build and the same CPU.
+
+#include "cd_math.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Splitmix64, one per entity, so one bot thinking more doesn't change numbers others get.
+struct Random_Stream {
+	uint64_t state = 0;
+};
+
+Random_Stream random_stream_make(uint64_t world_seed, uint64_t entity_id);
+uint32_t random_stream_next(Random_Stream *stream);
+
+// From min to max inclusive, like FMath::RandRange.
+int random_stream_range(Random_Stream *stream, int min, int max);
+
+// Id that is the same every run, from something like actor name.
+uint64_t determinism_id_from_name(const char *name);
+
+// FNV-1a.
+struct State_Hash {
+	uint64_t value = 14695981039346656037ull;
+};
+
+void state_hash_bytes(State_Hash *hash, const void *data, size_t size);
+
+inline void state_hash_int(State_Hash *hash, int64_t value) {
+	state_hash_bytes(hash, &value, sizeof(value));
+}
+
+// Minus zero is zero.
+inline void state_hash_float(State_Hash *hash, float value) {
+	value = value == 0.0f ? 0.0f : value;
+	state_hash_bytes(hash, &value, sizeof(value));
+}
+
+inline void state_hash_vec3(State_Hash *hash, Vec3 value) {
+	state_hash_float(hash, value.x);
+	state_hash_float(hash, value.y);
+	state_hash_float(hash, value.z);
+}
+
+struct Determinism_Log {
+	uint64_t 				first_step = 0;
+	std::vector<uint64_t> 	step_hashes; // Hash of step first_step + i.
+};
+
+// Adds hash of one part of the world to its step.
+void determinism_log_add(Determinism_Log *log, uint64_t step, uint64_t hash);
+
+void determinism_log_clear(Determinism_Log *log);
+
+// First step where both logs have a hash and hashes differ, -1 if there is none.
+int64_t determinism_log_first_divergence(const Determinism_Log &a, const Determinism_Log &b);
+
+// step,hash lines.
+bool determinism_log_write_csv(const Determinism_Log &log, const std::string &path);
+bool determinism_log_read_csv(Determinism_Log *log, const std::string &path);
+
+struct Determinism {
+	bool 			enabled 	= false;
+	uint64_t 		seed 		= 1;
+	Determinism_Log log;
+};
+
+extern Determinism determinism;
@@ -0,0 +1,55 @@
+#include "fixed_step.h"
+
+Fixed_Step_Clock simulation_clock;
+
+int fixed_step_advance(Fixed_Step_Clock *clock, uint64_t frame, float frame_dt) {
+	if (clock->frame == frame) {
+		return clock->steps_this_frame;
+	}
+	clock->frame = frame;
+
+	if (frame_dt > 0) {
+		clock->accumulator += frame_dt;
+	}
+
+	double 	step_dt = clock->params.step_dt;
+	int 	steps 	= (int)(clock->accumulator / step_dt);
+	if (steps > clock->params.max_substeps) {
+		clock->dropped_steps 	+= steps - clock->params.max_substeps;
+		steps 					= clock->params.max_substeps;
+
+		// Keep only the part of a step we are into, so interpolation doesn't jump.
+		clock->accumulator = clock->accumulator - (int64_t)(clock->accumulator / step_dt) * step_dt + steps * step_dt;
+	}
+	clock->accumulator -= steps * step_dt;
+
+	clock->first_step_this_frame 	= clock->step_index;
+	clock->steps_this_frame 		= steps;
+	clock->step_index 				+= steps;
+	return steps;
+}
+
+float fixed_step_alpha(const Fixed_Step_Clock &clock) {
+	float alpha = (float)(clock.accumulator / clock.params.step_dt);
+	return alpha < 0 ? 0 : alpha > 1 ? 1 : alpha;
+}
+
+void fixed_step_reset(Fixed_Step_Clock *clock) {
+	Fixed_Step_Params params = clock->params;
+	*clock 			= Fixed_Step_Clock();
+	clock->params 	= params;
+}
+
+void interpolated_position_reset(Interpolated_Position *interpolation, Vec3 position) {
+	interpolation->previous = position;
+	interpolation->current 	= position;
+}
+
+void interpolated_position_push(Interpolated_Position *interpolation, Vec3 position) {
+	interpolation->previous = interpolation->current;
+	interpolation->current 	= position;
+}
+
+Vec3 interpolated_position_get(const Interpolated_Position &interpolation, float alpha) {
+	return vec3_lerp(interpolation.previous, interpolation.current, alpha);
+}
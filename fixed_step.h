@@ -0,0 +1,59 @@
+#pragma once
+
+// Fixed timestep: movement, AI and rewind capture run in steps of the same length, whatever the frame rate is.
+// Frame time goes into accumulator, every whole step in it is one simulation step.
+//
+// 	int steps = fixed_step_advance(&simulation_clock, GFrameCounter, dt);
+// 	for (int i = 0; i < steps; ++i) { simulate(simulation_clock.params.step_dt); interpolated_position_push(&interpolation, position); }
+// 	root->SetWorldLocation(interpolated_position_get(interpolation, fixed_step_alpha(simulation_clock)));
+//
+// Under load we run at most max_substeps per frame and throw away the rest of the time, game slows down
+// instead of spending even more time on steps every frame. Long pause in editor is thrown away the same way.
+//
+// Rendered transforms are between the last two steps (one step behind), so motion is smooth when
+// frame rate and step rate don't match.
+//
+// @note: Player and bots share simulation_clock. Whoever ticks first in a frame advances it, the rest get the same steps.
+
+#include "cd_math.h"
+
+#include <stdint.h>
+
+struct Fixed_Step_Params {
+	float 	step_dt 		= 1.0f / 60.0f;
+	int 	max_substeps 	= 4;
+};
+
+struct Fixed_Step_Clock {
+	Fixed_Step_Params params;
+
+	double 		accumulator 			= 0;
+	uint64_t 	step_index 				= 0; // Steps run since start, first step of the next frame.
+	uint64_t 	first_step_this_frame 	= 0;
+	int 		steps_this_frame 		= 0;
+	uint64_t 	frame 					= UINT64_MAX; // Frame we advanced for.
+	uint64_t 	dropped_steps 			= 0; // Steps we didn't run because of max_substeps.
+};
+
+extern Fixed_Step_Clock simulation_clock;
+
+// Adds frame time once per frame and returns how many steps to run. Later calls in the same frame return the same.
+int fixed_step_advance(Fixed_Step_Clock *clock, uint64_t frame, float frame_dt);
+
+// Where we are between the last step and the next one, from 0 to 1.
+float fixed_step_alpha(const Fixed_Step_Clock &clock);
+
+void fixed_step_reset(Fixed_Step_Clock *clock);
+
+struct Interpolated_Position {
+	Vec3 previous;
+	Vec3 current;
+};
+
+// Teleport, no interpolation from where we were.
+void interpolated_position_reset(Interpolated_Position *interpolation, Vec3 position);
+
+// After every step.
+void interpolated_position_push(Interpolated_Position *interpolation, Vec3 position);
+
+Vec3 interpolated_position_get(const Interpolated_Position &interpolation, float alpha);
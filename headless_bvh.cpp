@@ -0,0 +1,396 @@
+#include "headless_bvh.h"
+
+#include <algorithm>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	#include <emmintrin.h>
+	#define HEADLESS_BVH_SSE
+#endif
+
+namespace {
+	const int bvh_width = HEADLESS_BVH_WIDTH;
+
+	// Empty child slots are a point this far away, so slab test never hits them.
+	const float far_away = 1.e30f;
+
+	// Same few operations for AVX, SSE and plain floats, so traversal code is written once.
+#if defined(__AVX__)
+	typedef __m256 Simd_Float;
+	inline Simd_Float simd_load(const float *p) 				{ return _mm256_loadu_ps(p); }
+	inline Simd_Float simd_set(float f) 						{ return _mm256_set1_ps(f); }
+	inline Simd_Float simd_sub(Simd_Float a, Simd_Float b) 		{ return _mm256_sub_ps(a, b); }
+	inline Simd_Float simd_mul(Simd_Float a, Simd_Float b) 		{ return _mm256_mul_ps(a, b); }
+	inline Simd_Float simd_min(Simd_Float a, Simd_Float b) 		{ return _mm256_min_ps(a, b); }
+	inline Simd_Float simd_max(Simd_Float a, Simd_Float b) 		{ return _mm256_max_ps(a, b); }
+	inline void 	  simd_store(float *p, Simd_Float a) 		{ _mm256_storeu_ps(p, a); }
+	inline int 		  simd_less_equal(Simd_Float a, Simd_Float b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LE_OQ)); }
+#elif defined(HEADLESS_BVH_SSE)
+	typedef __m128 Simd_Float;
+	inline Simd_Float simd_load(const float *p) 				{ return _mm_loadu_ps(p); }
+	inline Simd_Float simd_set(float f) 						{ return _mm_set1_ps(f); }
+	inline Simd_Float simd_sub(Simd_Float a, Simd_Float b) 		{ return _mm_sub_ps(a, b); }
+	inline Simd_Float simd_mul(Simd_Float a, Simd_Float b) 		{ return _mm_mul_ps(a, b); }
+	inline Simd_Float simd_min(Simd_Float a, Simd_Float b) 		{ return _mm_min_ps(a, b); }
+	inline Simd_Float simd_max(Simd_Float a, Simd_Float b) 		{ return _mm_max_ps(a, b); }
+	inline void 	  simd_store(float *p, Simd_Float a) 		{ _mm_storeu_ps(p, a); }
+	inline int 		  simd_less_equal(Simd_Float a, Simd_Float b) { return _mm_movemask_ps(_mm_cmple_ps(a, b)); }
+#else
+	struct Simd_Float { float v[bvh_width]; };
+	inline Simd_Float simd_load(const float *p) 				{ Simd_Float r; for (int i = 0; i < bvh_width; ++i) r.v[i] = p[i]; return r; }
+	inline Simd_Float simd_set(float f) 						{ Simd_Float r; for (int i = 0; i < bvh_width; ++i) r.v[i] = f; return r; }
+	inline Simd_Float simd_sub(Simd_Float a, Simd_Float b) 		{ for (int i = 0; i < bvh_width; ++i) a.v[i] -= b.v[i]; return a; }
+	inline Simd_Float simd_mul(Simd_Float a, Simd_Float b) 		{ for (int i = 0; i < bvh_width; ++i) a.v[i] *= b.v[i]; return a; }
+	inline Simd_Float simd_min(Simd_Float a, Simd_Float b) 		{ for (int i = 0; i < bvh_width; ++i) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return a; }
+	inline Simd_Float simd_max(Simd_Float a, Simd_Float b) 		{ for (int i = 0; i < bvh_width; ++i) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return a; }
+	inline void 	  simd_store(float *p, Simd_Float a) 		{ for (int i = 0; i < bvh_width; ++i) p[i] = a.v[i]; }
+	inline int 		  simd_less_equal(Simd_Float a, Simd_Float b) { int m = 0; for (int i = 0; i < bvh_width; ++i) m |= (a.v[i] <= b.v[i]) << i; return m; }
+#endif
+
+	struct Build_Range {
+		uint32_t first = 0;
+		uint32_t count = 0;
+	};
+
+	float axis_value(Vec3 v, int axis) {
+		return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+	}
+
+	struct Centroid_Less {
+		const Headless_World 	*world;
+		int 					axis;
+
+		bool operator()(uint32_t a, uint32_t b) const {
+			return axis_value(world->boxes[a].center, axis) < axis_value(world->boxes[b].center, axis);
+		}
+	};
+
+	Box3 range_bounds(const Headless_Bvh &bvh, Build_Range range) {
+		Box3 bounds = bvh.world->box_bounds(bvh.world->boxes[bvh.box_indices[range.first]]);
+		for (uint32_t i = range.first + 1; i < range.first + range.count; ++i) {
+			bounds = box3_union(bounds, bvh.world->box_bounds(bvh.world->boxes[bvh.box_indices[i]]));
+		}
+		return bounds;
+	}
+
+	// Median split along the longest axis of box centers.
+	void split_range(Headless_Bvh *bvh, Build_Range range, Build_Range *out_a, Build_Range *out_b) {
+		Vec3 center_min = bvh->world->boxes[bvh->box_indices[range.first]].center;
+		Vec3 center_max = center_min;
+		for (uint32_t i = range.first + 1; i < range.first + range.count; ++i) {
+			center_min = vec3_min(center_min, bvh->world->boxes[bvh->box_indices[i]].center);
+			center_max = vec3_max(center_max, bvh->world->boxes[bvh->box_indices[i]].center);
+		}
+
+		Vec3 size = center_max - center_min;
+		int  axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+
+		uint32_t 				half 	= range.count / 2;
+		std::vector<uint32_t> 	&boxes 	= bvh->box_indices;
+		std::nth_element(boxes.begin() + range.first, boxes.begin() + range.first + half, boxes.begin() + range.first + range.count, Centroid_Less{bvh->world, axis});
+
+		out_a->first = range.first;
+		out_a->count = half;
+		out_b->first = range.first + half;
+		out_b->count = range.count - half;
+	}
+
+	Headless_Bvh_Node empty_node() {
+		Headless_Bvh_Node node;
+		for (int i = 0; i < bvh_width; ++i) {
+			node.min_x[i] = node.min_y[i] = node.min_z[i] = far_away;
+			node.max_x[i] = node.max_y[i] = node.max_z[i] = far_away;
+			node.child[i] 		= 0;
+			node.leaf_count[i] 	= 0;
+		}
+		return node;
+	}
+
+	uint32_t build_node(Headless_Bvh *bvh, Build_Range range) {
+		uint32_t node_index = bvh->nodes.size();
+		bvh->nodes.push_back(empty_node());
+
+		// Keep splitting the biggest group until we have a group for every child slot.
+		Build_Range groups[bvh_width];
+		int 		group_count = 1;
+		groups[0] = range;
+
+		while (group_count < bvh_width) {
+			int largest = -1;
+			for (int i = 0; i < group_count; ++i) {
+				if ((int)groups[i].count > bvh->max_leaf_size && (largest < 0 || groups[i].count > groups[largest].count)) {
+					largest = i;
+				}
+			}
+
+			if (largest < 0) {
+				break;
+			}
+
+			split_range(bvh, groups[largest], &groups[largest], &groups[group_count]);
+			++group_count;
+		}
+
+		for (int i = 0; i < group_count; ++i) {
+			Box3 		bounds 		= range_bounds(*bvh, groups[i]);
+			uint32_t 	child 		= groups[i].first;
+			uint32_t 	leaf_count 	= groups[i].count;
+			if ((int)groups[i].count > bvh->max_leaf_size) {
+				child 		= build_node(bvh, groups[i]);
+				leaf_count 	= 0;
+			}
+
+			// Recursion above can move nodes, so we take the reference only now.
+			Headless_Bvh_Node &node = bvh->nodes[node_index];
+			node.min_x[i] 		= bounds.min.x;
+			node.min_y[i] 		= bounds.min.y;
+			node.min_z[i] 		= bounds.min.z;
+			node.max_x[i] 		= bounds.max.x;
+			node.max_y[i] 		= bounds.max.y;
+			node.max_z[i] 		= bounds.max.z;
+			node.child[i] 		= child;
+			node.leaf_count[i] 	= leaf_count;
+		}
+
+		return node_index;
+	}
+
+	// Axis parallel rays would give 0 * infinity in slab test, so we never divide by zero.
+	float safe_inverse(float d) {
+		if (std::fabs(d) < 1.e-20f) {
+			d = d < 0 ? -1.e-20f : 1.e-20f;
+		}
+		return 1.0f / d;
+	}
+
+	// Slab test of one ray (grown by extra for sweeps) against all children of a node.
+	// Returns bit mask of children the ray enters before max_t, and entry distances.
+	int intersect_children(const Headless_Bvh_Node &node, Vec3 from, Vec3 inverse, Vec3 extra, float max_t, float *out_near) {
+		// min - extra - from and max + extra - from.
+		Simd_Float from_min_x = simd_set(from.x + extra.x), from_max_x = simd_set(from.x - extra.x);
+		Simd_Float from_min_y = simd_set(from.y + extra.y), from_max_y = simd_set(from.y - extra.y);
+		Simd_Float from_min_z = simd_set(from.z + extra.z), from_max_z = simd_set(from.z - extra.z);
+		Simd_Float inverse_x = simd_set(inverse.x), inverse_y = simd_set(inverse.y), inverse_z = simd_set(inverse.z);
+
+		Simd_Float t0_x = simd_mul(simd_sub(simd_load(node.min_x), from_min_x), inverse_x);
+		Simd_Float t1_x = simd_mul(simd_sub(simd_load(node.max_x), from_max_x), inverse_x);
+		Simd_Float t0_y = simd_mul(simd_sub(simd_load(node.min_y), from_min_y), inverse_y);
+		Simd_Float t1_y = simd_mul(simd_sub(simd_load(node.max_y), from_max_y), inverse_y);
+		Simd_Float t0_z = simd_mul(simd_sub(simd_load(node.min_z), from_min_z), inverse_z);
+		Simd_Float t1_z = simd_mul(simd_sub(simd_load(node.max_z), from_max_z), inverse_z);
+
+		Simd_Float near = simd_max(simd_max(simd_min(t0_x, t1_x), simd_min(t0_y, t1_y)), simd_max(simd_min(t0_z, t1_z), simd_set(0.0f)));
+		Simd_Float far 	= simd_min(simd_min(simd_max(t0_x, t1_x), simd_max(t0_y, t1_y)), simd_min(simd_max(t0_z, t1_z), simd_set(max_t)));
+
+		simd_store(out_near, near);
+		return simd_less_equal(near, far);
+	}
+
+	bool trace_single(const Headless_Bvh &bvh, Vec3 from, Vec3 to, Vec3 extra, Collision_Hit *out_hit) {
+		out_hit->blocking = false;
+		out_hit->fraction = 1.0f;
+
+		if (bvh.nodes.empty()) {
+			return false;
+		}
+
+		Vec3 direction 	= to - from;
+		Vec3 inverse(safe_inverse(direction.x), safe_inverse(direction.y), safe_inverse(direction.z));
+
+		struct Stack_Entry {
+			uint32_t 	node;
+			float 		near;
+		};
+		Stack_Entry stack[64 * bvh_width];
+		int 		stack_size = 0;
+		stack[stack_size++] = Stack_Entry{0, 0.0f};
+
+		float 	max_t 	= 1.0f;
+		bool 	got_hit = false;
+		Vec3 	normal;
+
+		while (stack_size > 0) {
+			Stack_Entry entry = stack[--stack_size];
+			if (got_hit && entry.near > max_t) {
+				continue;
+			}
+
+			const Headless_Bvh_Node &node = bvh.nodes[entry.node];
+
+			alignas(32) float near[bvh_width];
+			int mask = intersect_children(node, from, inverse, extra, max_t, near);
+
+			// Leaves are tested right away, inner children go to stack sorted so the nearest is popped first.
+			Stack_Entry inner[bvh_width];
+			int 		inner_count = 0;
+
+			for (int i = 0; i < bvh_width; ++i) {
+				if (!(mask & (1 << i))) {
+					continue;
+				}
+
+				if (node.leaf_count[i] == 0) {
+					int j = inner_count++;
+					while (j > 0 && inner[j - 1].near < near[i]) {
+						inner[j] = inner[j - 1];
+						--j;
+					}
+					inner[j] = Stack_Entry{node.child[i], near[i]};
+					continue;
+				}
+
+				for (uint32_t k = node.child[i]; k < node.child[i] + node.leaf_count[i]; ++k) {
+					float 	fraction;
+					Vec3 	box_normal;
+					if (headless_ray_box(bvh.world->boxes[bvh.box_indices[k]], extra, from, to, &fraction, &box_normal) && (!got_hit || fraction < max_t)) {
+						got_hit = true;
+						max_t 	= fraction;
+						normal 	= box_normal;
+					}
+				}
+			}
+
+			for (int i = 0; i < inner_count; ++i) {
+				stack[stack_size++] = inner[i];
+			}
+		}
+
+		if (!got_hit) {
+			return false;
+		}
+
+		out_hit->blocking 	= true;
+		out_hit->fraction 	= max_t;
+		out_hit->point 		= vec3_lerp(from, to, max_t);
+		out_hit->normal 	= normal;
+		out_hit->distance 	= vec3_length(direction) * max_t;
+		return true;
+	}
+
+	// Traces up to bvh_width rays together. Every child box is tested against the whole packet at once,
+	// and we go down if any ray in the packet enters it.
+	void trace_packet(const Headless_Bvh &bvh, const Collision_Ray *rays, int count, Collision_Hit *out_hits) {
+		alignas(32) float from_x[bvh_width], from_y[bvh_width], from_z[bvh_width];
+		alignas(32) float inverse_x[bvh_width], inverse_y[bvh_width], inverse_z[bvh_width];
+		alignas(32) float max_t[bvh_width];
+		bool 			  got_hit[bvh_width];
+		Vec3 			  normal[bvh_width];
+
+		for (int i = 0; i < bvh_width; ++i) {
+			got_hit[i] = false;
+
+			if (i >= count) {
+				// Unused lanes can't hit anything.
+				from_x[i] = from_y[i] = from_z[i] = 0.0f;
+				inverse_x[i] = inverse_y[i] = inverse_z[i] = 1.0f;
+				max_t[i] = -1.0f;
+				continue;
+			}
+
+			Vec3 direction = rays[i].to - rays[i].from;
+			from_x[i] 		= rays[i].from.x;
+			from_y[i] 		= rays[i].from.y;
+			from_z[i] 		= rays[i].from.z;
+			inverse_x[i] 	= safe_inverse(direction.x);
+			inverse_y[i] 	= safe_inverse(direction.y);
+			inverse_z[i] 	= safe_inverse(direction.z);
+			max_t[i] 		= 1.0f;
+		}
+
+		Simd_Float packet_from_x = simd_load(from_x), packet_from_y = simd_load(from_y), packet_from_z = simd_load(from_z);
+		Simd_Float packet_inverse_x = simd_load(inverse_x), packet_inverse_y = simd_load(inverse_y), packet_inverse_z = simd_load(inverse_z);
+
+		uint32_t 	stack[64 * bvh_width];
+		int 		stack_size = 0;
+		if (!bvh.nodes.empty()) {
+			stack[stack_size++] = 0;
+		}
+
+		while (stack_size > 0) {
+			const Headless_Bvh_Node &node = bvh.nodes[stack[--stack_size]];
+
+			for (int i = 0; i < bvh_width; ++i) {
+				Simd_Float t0_x = simd_mul(simd_sub(simd_set(node.min_x[i]), packet_from_x), packet_inverse_x);
+				Simd_Float t1_x = simd_mul(simd_sub(simd_set(node.max_x[i]), packet_from_x), packet_inverse_x);
+				Simd_Float t0_y = simd_mul(simd_sub(simd_set(node.min_y[i]), packet_from_y), packet_inverse_y);
+				Simd_Float t1_y = simd_mul(simd_sub(simd_set(node.max_y[i]), packet_from_y), packet_inverse_y);
+				Simd_Float t0_z = simd_mul(simd_sub(simd_set(node.min_z[i]), packet_from_z), packet_inverse_z);
+				Simd_Float t1_z = simd_mul(simd_sub(simd_set(node.max_z[i]), packet_from_z), packet_inverse_z);
+
+				Simd_Float near = simd_max(simd_max(simd_min(t0_x, t1_x), simd_min(t0_y, t1_y)), simd_max(simd_min(t0_z, t1_z), simd_set(0.0f)));
+				Simd_Float far 	= simd_min(simd_min(simd_max(t0_x, t1_x), simd_max(t0_y, t1_y)), simd_min(simd_max(t0_z, t1_z), simd_load(max_t)));
+
+				int mask = simd_less_equal(near, far);
+				if (!mask) {
+					continue;
+				}
+
+				if (node.leaf_count[i] == 0) {
+					stack[stack_size++] = node.child[i];
+					continue;
+				}
+
+				for (int lane = 0; lane < count; ++lane) {
+					if (!(mask & (1 << lane))) {
+						continue;
+					}
+
+					for (uint32_t k = node.child[i]; k < node.child[i] + node.leaf_count[i]; ++k) {
+						float 	fraction;
+						Vec3 	box_normal;
+						if (headless_ray_box(bvh.world->boxes[bvh.box_indices[k]], Vec3(), rays[lane].from, rays[lane].to, &fraction, &box_normal)
+							&& (!got_hit[lane] || fraction < max_t[lane])) {
+							got_hit[lane] 	= true;
+							max_t[lane] 	= fraction;
+							normal[lane] 	= box_normal;
+						}
+					}
+				}
+			}
+		}
+
+		for (int lane = 0; lane < count; ++lane) {
+			Collision_Hit &hit = out_hits[lane];
+			hit.blocking = got_hit[lane];
+			hit.fraction = got_hit[lane] ? max_t[lane] : 1.0f;
+			if (got_hit[lane]) {
+				hit.point 		= vec3_lerp(rays[lane].from, rays[lane].to, max_t[lane]);
+				hit.normal 		= normal[lane];
+				hit.distance 	= vec3_distance(rays[lane].from, rays[lane].to) * max_t[lane];
+			}
+		}
+	}
+}
+
+void Headless_Bvh::build(const Headless_World *new_world) {
+	world = new_world;
+	nodes.clear();
+	box_indices.clear();
+
+	for (uint32_t i = 0; i < world->boxes.size(); ++i) {
+		box_indices.push_back(i);
+	}
+
+	if (box_indices.empty()) {
+		return;
+	}
+
+	Build_Range everything;
+	everything.count = box_indices.size();
+	build_node(this, everything);
+}
+
+bool Headless_Bvh::ray(Vec3 from, Vec3 to, Collision_Hit *out_hit) const {
+	return trace_single(*this, from, to, Vec3(), out_hit);
+}
+
+void Headless_Bvh::ray_batch(const Collision_Ray *rays, int count, Collision_Hit *out_hits) const {
+	for (int first = 0; first < count; first += bvh_width) {
+		trace_packet(*this, rays + first, std::min(bvh_width, count - first), out_hits + first);
+	}
+}
+
+bool Headless_Bvh::box_sweep(Vec3 from, Vec3 to, Vec3 half_extents, Collision_Hit *out_hit) const {
+	return trace_single(*this, from, to, half_extents, out_hit);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// Bounding volume hierarchy over Headless_World boxes, for tools that need a lot of rays (benchmarks, offline bakes).
+// Every node keeps bounds of 4 children (8 with AVX) in SoA layout, so one ray is tested against all of them
+// with one SIMD slab test. ray_batch() traces packets of 4 (or 8) rays together: every child box is tested
+// against the whole packet at once, which is very good for coherent rays like the rotation search fan.
+//
+// @note: BVH doesn't own the boxes, it points into the world. Call build() again if world changes.
+// @note: Sweeps against oriented boxes are culled by node bounds grown by the sweep box, so they can miss
+// a bit of the extra space Headless_World::box_sweep() adds at rotated corners. That space is not real collision anyway.
+
+#include "headless_world.h"
+
+#include <stdint.h>
+#include <vector>
+
+#if defined(__AVX__)
+	#define HEADLESS_BVH_WIDTH 8
+#else
+	#define HEADLESS_BVH_WIDTH 4
+#endif
+
+struct alignas(32) Headless_Bvh_Node {
+	float 		min_x[HEADLESS_BVH_WIDTH];
+	float 		min_y[HEADLESS_BVH_WIDTH];
+	float 		min_z[HEADLESS_BVH_WIDTH];
+	float 		max_x[HEADLESS_BVH_WIDTH];
+	float 		max_y[HEADLESS_BVH_WIDTH];
+	float 		max_z[HEADLESS_BVH_WIDTH];
+	uint32_t 	child[HEADLESS_BVH_WIDTH]; 		// Node index, or first box in box_indices for leaves.
+	uint32_t 	leaf_count[HEADLESS_BVH_WIDTH]; // Zero for inner nodes. Empty slots are a point far away.
+};
+
+class Headless_Bvh : public Collision_Query {
+public:
+	const Headless_World 			*world = nullptr;
+	std::vector<Headless_Bvh_Node> 	nodes; // Zero is root.
+	std::vector<uint32_t> 			box_indices;
+	int 							max_leaf_size = 1; // Node tests are cheap, exact box tests are not, so leaves are small.
+
+	void build(const Headless_World *new_world);
+
+	virtual bool ray(Vec3 from, Vec3 to, Collision_Hit *out_hit) const override;
+	virtual void ray_batch(const Collision_Ray *rays, int count, Collision_Hit *out_hits) const override;
+	virtual bool box_sweep(Vec3 from, Vec3 to, Vec3 half_extents, Collision_Hit *out_hit) const override;
+};
@@ -0,0 +1,268 @@
+#include "headless_world.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace {
+	float degrees_to_radians = 3.14159265358979f / 180.0f;
+
+	// Sweep box is axis aligned, for oriented boxes we grow them by projection of sweep box on their axes.
+	// It's a bit bigger than real Minkowski sum at rotated corners, which is fine for navigation.
+	Vec3 grown_half_extents(const Headless_Box &box, Vec3 extra) {
+		if (!box.oriented) {
+			return box.half_extents + extra;
+		}
+
+		Vec3 axes[3] = {box.axis_x, box.axis_y, box.axis_z};
+		float grown[3];
+		for (int i = 0; i < 3; ++i) {
+			grown[i] = std::fabs(axes[i].x) * extra.x + std::fabs(axes[i].y) * extra.y + std::fabs(axes[i].z) * extra.z;
+		}
+		return box.half_extents + Vec3(grown[0], grown[1], grown[2]);
+	}
+}
+
+bool headless_ray_box(const Headless_Box &box, Vec3 extra_half_extents, Vec3 from, Vec3 to, float *out_fraction, Vec3 *out_normal) {
+	Vec3 half_extents 	= grown_half_extents(box, extra_half_extents);
+	Vec3 relative 		= from - box.center;
+	Vec3 direction 		= to - from;
+
+	// Move ray into box space.
+	Vec3 axes[3] 		= {box.axis_x, box.axis_y, box.axis_z};
+	float origin[3] 	= {vec3_dot(relative, axes[0]), vec3_dot(relative, axes[1]), vec3_dot(relative, axes[2])};
+	float local[3] 		= {vec3_dot(direction, axes[0]), vec3_dot(direction, axes[1]), vec3_dot(direction, axes[2])};
+	float half[3] 		= {half_extents.x, half_extents.y, half_extents.z};
+
+	float 	t_min 		= 0.0f;
+	float 	t_max 		= 1.0f;
+	int 	entry_axis 	= -1;
+	float 	entry_sign 	= 0.0f;
+
+	for (int axis = 0; axis < 3; ++axis) {
+		if (std::fabs(local[axis]) < 1.e-8f) {
+			if (origin[axis] < -half[axis] || origin[axis] > half[axis]) {
+				return false;
+			}
+			continue;
+		}
+
+		float inverse 	= 1.0f / local[axis];
+		float t0 		= (-half[axis] - origin[axis]) * inverse;
+		float t1 		= (half[axis] - origin[axis]) * inverse;
+		float sign 		= -1.0f; // We enter through the negative side.
+		if (t0 > t1) {
+			float swap = t0; t0 = t1; t1 = swap;
+			sign = 1.0f;
+		}
+
+		if (t0 > t_min) {
+			t_min 		= t0;
+			entry_axis 	= axis;
+			entry_sign 	= sign;
+		}
+		t_max = std::fmin(t_max, t1);
+
+		if (t_min > t_max) {
+			return false;
+		}
+	}
+
+	*out_fraction = t_min;
+	if (entry_axis < 0) {
+		// Started inside, normal looks back at the ray.
+		*out_normal = vec3_normalize(-direction);
+	} else {
+		*out_normal = axes[entry_axis] * entry_sign;
+	}
+	return true;
+}
+
+void Headless_World::add_box(Vec3 center, Vec3 half_extents) {
+	Headless_Box box;
+	box.center 			= center;
+	box.half_extents 	= half_extents;
+	boxes.push_back(box);
+}
+
+void Headless_World::add_oriented_box(Vec3 center, Vec3 half_extents, float yaw, float pitch, float roll) {
+	if (yaw == 0.0f && pitch == 0.0f && roll == 0.0f) {
+		add_box(center, half_extents);
+		return;
+	}
+
+	// Same axes as FRotationMatrix gives for FRotator(pitch, yaw, roll).
+	float sp = std::sin(pitch * degrees_to_radians), cp = std::cos(pitch * degrees_to_radians);
+	float sy = std::sin(yaw * degrees_to_radians), 	 cy = std::cos(yaw * degrees_to_radians);
+	float sr = std::sin(roll * degrees_to_radians),  cr = std::cos(roll * degrees_to_radians);
+
+	Headless_Box box;
+	box.center 			= center;
+	box.half_extents 	= half_extents;
+	box.axis_x 			= Vec3(cp * cy, cp * sy, sp);
+	box.axis_y 			= Vec3(sr * sp * cy - cr * sy, sr * sp * sy + cr * cy, -sr * cp);
+	box.axis_z 			= Vec3(-(cr * sp * cy + sr * sy), cy * sr - cr * sp * sy, cr * cp);
+	box.oriented 		= true;
+	boxes.push_back(box);
+}
+
+void Headless_World::add_point(const char *name, Vec3 position) {
+	Headless_Point point;
+	point.name 		= name;
+	point.position 	= position;
+	points.push_back(point);
+}
+
+void Headless_World::clear() {
+	boxes.clear();
+	points.clear();
+}
+
+bool Headless_World::load(const char *path, std::string *out_error) {
+	std::ifstream file(path);
+	if (!file) {
+		*out_error = std::string("Can't open level file: ") + path;
+		return false;
+	}
+
+	std::stringstream text;
+	text << file.rdbuf();
+	return parse(text.str(), out_error);
+}
+
+bool Headless_World::parse(const std::string &text, std::string *out_error) {
+	std::istringstream 	lines(text);
+	std::string 		line;
+	int 				line_number = 0;
+
+	while (std::getline(lines, line)) {
+		++line_number;
+
+		std::istringstream tokens(line);
+		std::string 		type;
+		if (!(tokens >> type) || type[0] == '#') {
+			continue;
+		}
+
+		bool parsed = false;
+		if (type == "box") {
+			Vec3 center, half_extents;
+			parsed = (bool)(tokens >> center.x >> center.y >> center.z >> half_extents.x >> half_extents.y >> half_extents.z);
+			if (parsed) {
+				add_box(center, half_extents);
+			}
+		} else if (type == "obox") {
+			Vec3 	center, half_extents;
+			float 	yaw, pitch, roll;
+			parsed = (bool)(tokens >> center.x >> center.y >> center.z >> half_extents.x >> half_extents.y >> half_extents.z >> yaw >> pitch >> roll);
+			if (parsed) {
+				add_oriented_box(center, half_extents, yaw, pitch, roll);
+			}
+		} else if (type == "point") {
+			std::string name;
+			Vec3 		position;
+			parsed = (bool)(tokens >> name >> position.x >> position.y >> position.z);
+			if (parsed) {
+				add_point(name.c_str(), position);
+			}
+		}
+
+		if (!parsed) {
+			*out_error = "Bad line " + std::to_string(line_number) + ": " + line;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool Headless_World::save(const char *path) const {
+	std::ofstream file(path);
+	if (!file) {
+		return false;
+	}
+
+	for (const Headless_Box &box : boxes) {
+		if (!box.oriented) {
+			file << "box " << box.center.x << " " << box.center.y << " " << box.center.z << " "
+				<< box.half_extents.x << " " << box.half_extents.y << " " << box.half_extents.z << "\n";
+		} else {
+			// Angles back from FRotationMatrix axes.
+			float pitch = std::asin(box.axis_x.z) / degrees_to_radians;
+			float yaw 	= std::atan2(box.axis_x.y, box.axis_x.x) / degrees_to_radians;
+			float roll 	= std::atan2(-box.axis_y.z, box.axis_z.z) / degrees_to_radians;
+			file << "obox " << box.center.x << " " << box.center.y << " " << box.center.z << " "
+				<< box.half_extents.x << " " << box.half_extents.y << " " << box.half_extents.z << " "
+				<< yaw << " " << pitch << " " << roll << "\n";
+		}
+	}
+
+	for (const Headless_Point &point : points) {
+		file << "point " << point.name << " " << point.position.x << " " << point.position.y << " " << point.position.z << "\n";
+	}
+
+	return (bool)file;
+}
+
+bool Headless_World::find_point(const char *name, Vec3 *out_position) const {
+	for (const Headless_Point &point : points) {
+		if (point.name == name) {
+			*out_position = point.position;
+			return true;
+		}
+	}
+	return false;
+}
+
+Box3 Headless_World::box_bounds(const Headless_Box &box) const {
+	Vec3 extent = box.half_extents;
+	if (box.oriented) {
+		// Projection of oriented box on world axes.
+		extent.x = std::fabs(box.axis_x.x) * box.half_extents.x + std::fabs(box.axis_y.x) * box.half_extents.y + std::fabs(box.axis_z.x) * box.half_extents.z;
+		extent.y = std::fabs(box.axis_x.y) * box.half_extents.x + std::fabs(box.axis_y.y) * box.half_extents.y + std::fabs(box.axis_z.y) * box.half_extents.z;
+		extent.z = std::fabs(box.axis_x.z) * box.half_extents.x + std::fabs(box.axis_y.z) * box.half_extents.y + std::fabs(box.axis_z.z) * box.half_extents.z;
+	}
+	return box3_from_center(box.center, extent);
+}
+
+Box3 Headless_World::bounds() const {
+	if (boxes.empty()) {
+		return Box3();
+	}
+
+	Box3 result = box_bounds(boxes[0]);
+	for (const Headless_Box &box : boxes) {
+		result = box3_union(result, box_bounds(box));
+	}
+	return result;
+}
+
+bool Headless_World::ray(Vec3 from, Vec3 to, Collision_Hit *out_hit) const {
+	return box_sweep(from, to, Vec3(), out_hit);
+}
+
+bool Headless_World::box_sweep(Vec3 from, Vec3 to, Vec3 half_extents, Collision_Hit *out_hit) const {
+	float 	best_fraction = 2.0f;
+	Vec3 	best_normal;
+
+	for (const Headless_Box &box : boxes) {
+		float 	fraction;
+		Vec3 	normal;
+		if (headless_ray_box(box, half_extents, from, to, &fraction, &normal) && fraction < best_fraction) {
+			best_fraction 	= fraction;
+			best_normal 	= normal;
+		}
+	}
+
+	if (best_fraction > 1.0f) {
+		out_hit->blocking = false;
+		out_hit->fraction = 1.0f;
+		return false;
+	}
+
+	out_hit->blocking 	= true;
+	out_hit->fraction 	= best_fraction;
+	out_hit->point 		= vec3_lerp(from, to, best_fraction);
+	out_hit->normal 	= best_normal;
+	out_hit->distance 	= vec3_distance(from, to) * best_fraction;
+	return true;
+}
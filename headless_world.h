@@ -0,0 +1,60 @@
+#pragma once
+
+// Stand-in collision world made of boxes, for running the planner without Unreal.
+//
+// Level format is plain text, one thing per line, units are centimeters like in Unreal:
+// 	# comment
+// 	box 	center_x center_y center_z 	half_x half_y half_z
+// 	obox 	center_x center_y center_z 	half_x half_y half_z 	yaw pitch roll 	(degrees, same as FRotator)
+// 	point 	name x y z 																(bot spawns, goals, anything benchmark needs)
+//
+// Rays that start inside a box hit it right away, at the start, same as Unreal traces against simple collision.
+
+#include "collision_query.h"
+
+#include <string>
+#include <vector>
+
+struct Headless_Box {
+	Vec3 center;
+	Vec3 half_extents;
+
+	// Local axes of the box in world space. Identity for axis aligned boxes.
+	Vec3 axis_x = Vec3(1, 0, 0);
+	Vec3 axis_y = Vec3(0, 1, 0);
+	Vec3 axis_z = Vec3(0, 0, 1);
+	bool oriented = false;
+};
+
+struct Headless_Point {
+	std::string name;
+	Vec3 		position;
+};
+
+class Headless_World : public Collision_Query {
+public:
+	std::vector<Headless_Box> 	boxes;
+	std::vector<Headless_Point> points;
+
+	void add_box(Vec3 center, Vec3 half_extents);
+	void add_oriented_box(Vec3 center, Vec3 half_extents, float yaw, float pitch, float roll);
+	void add_point(const char *name, Vec3 position);
+	void clear();
+
+	bool load(const char *path, std::string *out_error);
+	bool parse(const std::string &text, std::string *out_error);
+	bool save(const char *path) const;
+
+	// Returns false if there is no point with this name.
+	bool find_point(const char *name, Vec3 *out_position) const;
+
+	// Axis aligned bounds of all boxes.
+	Box3 bounds() const;
+	Box3 box_bounds(const Headless_Box &box) const;
+
+	virtual bool ray(Vec3 from, Vec3 to, Collision_Hit *out_hit) const override;
+	virtual bool box_sweep(Vec3 from, Vec3 to, Vec3 half_extents, Collision_Hit *out_hit) const override;
+};
+
+// Ray against one box with its half extents grown by extra (for sweeps). Returns entry fraction and world normal.
+bool headless_ray_box(const Headless_Box &box, Vec3 extra_half_extents, Vec3 from, Vec3 to, float *out_fraction, Vec3 *out_normal);
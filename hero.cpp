@@ -1,4 +1,5 @@
 #include "hero.h"
+#include "bot.h"
 #include "hui.h"
 #include "post_update.h"
 
@@ -6,13 +7,32 @@
 #include "Components/BoxComponent.h" // For collision.
 #include "Camera/CameraComponent.h"
 #include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h" // For console variables.
+#include "HAL/FileManager.h" // To make replay folder.
+#include "Misc/App.h" // For fixed frame time in replay playback.
+#include "Misc/CommandLine.h"
+#include "Misc/Paths.h"
+
+#include "collision_query_unreal.h"
+#include "debug_draw_unreal.h"
+#include "determinism.h"
+#include "fixed_step.h"
+#include "blackboard.h"
+#include "kinematic_mover.h"
+#include "lag_compensation.h"
+#include "mouse_look.h"
+#include "movement_kernel.h"
+#include "replay.h"
+#include "rollback.h"
+#include "trace_recorder.h"
+#include "world_snapshot.h"
 
 #include "cd_core/log.h"
 
 bool 	A_Player::game_started 		= false;
 float 	A_Player::player_speed 		= 0;
 FVector A_Player::player_position 	= FVector(0);
-AActor 	*A_Player::player;
+TWeakObjectPtr<AActor> A_Player::player;
 
 namespace {
 	float	collision_size 		= 20.0f;
@@ -21,9 +41,16 @@ namespace {
 	float	collision_height 	= 92.0f;
 	FVector collision_bounds(collision_size, collision_size, collision_height);
 	FVector collision_velocity;
+
+	// Player collision is kinematic, mover sweeps it against everything except us.
+	Kinematic_Mover_Params 	mover_params;
+	Kinematic_Mover_State 	mover_state;
+	Collision_Query_Unreal 	mover_collision;
+
+	// Player moves and saves rewind states in fixed steps, root is drawn between the last two (fixed_step.h).
+	Interpolated_Position 	interpolation;
 	
 	// Camera move variables.
-	FBodyInstance 	*collision_physics;
 	FVector 		camera_offset(0.0f, 0.0f, 70.0f);
 	FVector 		camera_forward_vector;
 	FVector 		camera_backward_vector;
@@ -32,41 +59,20 @@ namespace {
 	FVector 		camera_up_vector;
 	FVector 		camera_down_vector;
 	
-	float 						mouse_input_x;
-	float 						mouse_input_y;
-	float 						mouse_design_sensitivity 		= 100.0f;
-	float 						mouse_user_overall_sensitivity 	= 1.0f;
-	float 						mouse_user_sensitivity_x		= 1.0f;
-	float 						mouse_user_sensitivity_y		= 1.0f;
-	float 						mouse_camera_smoothness			= 1.0f; // @note: I don't use camera smoothing. Works without delta time, 1.0 means no smoothing.
-	FRotator 					camera_euler_rotation(0);
-	FRotationConversionCache 	camera_rotation_conversion;	// @note: This is for optimization, I probably don't use it fully.
-	
-	// Player move variables.
-	FRotationConversionCache 	collision_rotation_conversion; // @note: This is for optimization, I probably don't use it fully.
+	// Mouse deltas are kept as they come and camera takes them as late as it can, see mouse_look.h.
+	Mouse_Look 			mouse_look;
+	Mouse_Look_Params 	mouse_look_params;
+	float 				mouse_user_overall_sensitivity 	= 1.0f;
+	float 				mouse_user_sensitivity_x		= 1.0f;
+	float 				mouse_user_sensitivity_y		= 1.0f;
 	
-	// @todo: rename these to speed.
-	float			max_walking_speed		= 2400.0f;
-	float 			forward_force 			= 2400.0f;
-	float 			backward_force 			= 2400.0f;
-	float 			right_force 			= 2400.0f;
-	float 			left_force 				= 2400.0f;
-	float 			jump_force 				= 3700.0f; 	// Default gravity Z is -980.0
-	float 			gravity_extra_force 	= 1077.0f; 	// I make gravity stronger by adding extra force.
-	
-	float 			drag_walking_force		= 1.3f; // Drag walking should be less than stopping.
-	float 			drag_stop_walking_force = 3.2f;
+	// Walking speeds, jump, extra gravity and drags, see movement_kernel.h.
+	// @todo: rename forces to speed.
+	Movement_Params movement_params;
+	Movement_Batch 	movement_batch; // Player is a batch of one, bots share the same kernel.
 	
 	bool 			is_walking = false;	// Right now I control this by key input and not by checking player velocity.
 	
-	bool 			mass_has_no_effect = true;
-	
-	// @note: Hardcoded vectors for move input keys on unit circle.
-	FVector			move_forward_xy		(0,1,0);
-	FVector			move_backward_xy	(0,-1,0);
-	FVector			move_right_xy		(1,0,0);
-	FVector			move_left_xy		(-1,0,0);
-	
 	struct Player_State {
 		FVector position = FVector(0);
 		FQuat 	rotation = FQuat::Identity;
@@ -93,6 +99,319 @@ namespace {
 	float rewinding_timer 			= 0;
 	bool allowed_to_rewind 			= false;
 	bool currently_rewinding 		= false;
+
+	// Walking, jump, extra gravity and drag all come out as one velocity change (movement_kernel.h), then mover moves us.
+	// Prediction, server and rollback all move the player with this.
+	void simulate_player(void *user, const Rollback_Input &input, Kinematic_Mover_State *state, float dt) {
+		movement_batch_clear(&movement_batch);
+		movement_batch_add(&movement_batch, movement_params, input.forward_x, input.forward_y, state->velocity.x, state->velocity.y, input.buttons, dt);
+		movement_batch_run(movement_params, &movement_batch);
+
+		state->velocity += Vec3(movement_batch.impulse_x[0], movement_batch.impulse_y[0], movement_batch.impulse_z[0]);
+
+		// Server only, from cd.net_knockback.
+		bool *knockback = (bool *)user;
+		if (knockback && *knockback) {
+			*knockback 		= false;
+			state->velocity += Vec3(FMath::RandRange(-800.0f, 800.0f), FMath::RandRange(-800.0f, 800.0f), 300.0f);
+			state->grounded = false;
+		}
+
+		kinematic_mover_move(mover_collision, mover_params, state, dt);
+	}
+
+	// Rollback client prediction against a server in this process, behind fake network (rollback.h).
+	// Server sweeps the same world, so only cd.net_knockback makes it disagree with us.
+	bool 				net_loopback 			= false;
+	float 				net_latency_ms 			= 80.0f; // One way.
+	float 				net_jitter_ms 			= 20.0f;
+	bool 				net_started 			= false;
+	bool 				net_server_knockback 	= false;
+	uint64_t 			net_step 				= 0; // Step move_player() runs.
+	Rollback_Client 	net_client;
+	Rollback_Server 	net_server;
+	Loopback_Transport 	net_to_server;
+	Loopback_Transport 	net_to_client;
+	std::vector<Rollback_Message> 	net_messages;
+	std::vector<Rollback_Frame> 	net_corrections;
+
+	FAutoConsoleVariableRef net_loopback_variable(
+		TEXT("cd.net_loopback"),
+		net_loopback,
+		TEXT("Predict player movement and roll back to corrections from a loopback server."));
+
+	FAutoConsoleVariableRef net_latency_variable(
+		TEXT("cd.net_latency_ms"),
+		net_latency_ms,
+		TEXT("Loopback one way latency in milliseconds."));
+
+	FAutoConsoleVariableRef net_jitter_variable(
+		TEXT("cd.net_jitter_ms"),
+		net_jitter_ms,
+		TEXT("Loopback jitter in milliseconds, messages are late by up to this much more than latency."));
+
+	FAutoConsoleCommand net_knockback_console_command(
+		TEXT("cd.net_knockback"),
+		TEXT("Loopback server pushes player on its next step, client finds out one round trip later and rolls back."),
+		FConsoleCommandDelegate::CreateLambda([]() { net_server_knockback = true; }));
+
+	// Client and server start together from where we are, after rewind too. Call it before step is simulated.
+	void start_net(uint64_t step) {
+		rollback_client_init(&net_client, Rollback_Params());
+		net_server 				= Rollback_Server();
+		net_server.state 		= mover_state;
+		net_server.next_step 	= step;
+		net_to_server 			= Loopback_Transport();
+		net_to_client 			= Loopback_Transport();
+		net_to_server.random 	= random_stream_make(determinism.seed, 4);
+		net_to_client.random 	= random_stream_make(determinism.seed, 5);
+		net_started 			= true;
+	}
+
+	void update_net(const Rollback_Input &input, float dt) {
+		trace_scope("update_net");
+
+		net_to_server.latency 	= net_to_client.latency = net_latency_ms / 1000.0f;
+		net_to_server.jitter 	= net_to_client.jitter 	= net_jitter_ms / 1000.0f;
+
+		rollback_client_record(&net_client, net_step, input, mover_state);
+
+		double 				now = net_step * (double)dt;
+		Rollback_Message 	message;
+		message.type 		= ROLLBACK_MESSAGE_INPUT;
+		message.frame.step 	= net_step;
+		message.frame.input = input;
+		loopback_send(&net_to_server, now, message);
+
+		net_messages.clear();
+		loopback_receive(&net_to_server, now, &net_messages);
+		for (const Rollback_Message &arrived : net_messages) {
+			net_corrections.clear();
+			rollback_server_receive(&net_server, arrived.frame.step, arrived.frame.input, simulate_player, &net_server_knockback, dt, &net_corrections);
+			for (const Rollback_Frame &correction : net_corrections) {
+				Rollback_Message reply;
+				reply.type 	= ROLLBACK_MESSAGE_CORRECTION;
+				reply.frame = correction;
+				loopback_send(&net_to_client, now, reply);
+			}
+		}
+
+		// Only the newest correction matters, it rolls back over everything before it anyway.
+		net_messages.clear();
+		loopback_receive(&net_to_client, now, &net_messages);
+		const Rollback_Message *newest = nullptr;
+		for (const Rollback_Message &arrived : net_messages) {
+			if (!newest || arrived.frame.step > newest->frame.step) {
+				newest = &arrived;
+			}
+		}
+		if (newest && rollback_client_correct(&net_client, newest->frame.step, newest->frame.state, simulate_player, nullptr, dt, &mover_state) > 0) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Rolled back to step %llu, %d steps again."), (unsigned long long)newest->frame.step, (int32)(net_step - newest->frame.step));
+		}
+
+		rollback_client_decay(&net_client, dt);
+	}
+
+	// Lag compensation (lag_compensation.h): every step we go into lag history with bots, shots look there.
+	uint64_t player_lag_id = 0;
+
+	// cd.lag_shot ms - ray from camera into where pawns were ms ago, like a shot from a client that much behind.
+	void lag_shot_command(const TArray<FString> &arguments) {
+		float lag_ms = arguments.Num() > 0 ? FCString::Atof(*arguments[0]) : 0.0f;
+
+		// What we see is between the last two steps (fixed_step.h), client with lag saw that lag_ms earlier.
+		double step_time = (double)simulation_clock.step_index - 2 + fixed_step_alpha(simulation_clock) - lag_ms / 1000.0 / simulation_clock.params.step_dt;
+
+		Vec3 from 	= mover_state.position + to_vec3(camera_offset);
+		Vec3 to 	= from + mouse_look_forward(mouse_look) * 100000.0f;
+
+		Lag_Hit hit;
+		uint64_t tests_before = lag_history.entity_tests;
+		if (lag_history_ray(&lag_history, step_time, from, to, player_lag_id, &hit)) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Lag shot %.0f ms back (step %.2f) hit %llx at %.0f cm, %d pawns tested."),
+				lag_ms, step_time, (unsigned long long)hit.entity_id, vec3_distance(from, hit.point), (int32)(lag_history.entity_tests - tests_before));
+			debug_line(DEBUG_DRAW_RAYCAST, from, hit.point, 0xFF4040, true);
+		} else {
+			UE_LOG(Log_CD_Core, Log, TEXT("Lag shot %.0f ms back (step %.2f) hit nobody."), lag_ms, step_time);
+			debug_line(DEBUG_DRAW_RAYCAST, from, to, 0x40FF40, true);
+		}
+	}
+
+	FAutoConsoleCommand lag_shot_console_command(
+		TEXT("cd.lag_shot"),
+		TEXT("Ray from camera against where pawns were that many milliseconds ago. No arguments is what we see now."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&lag_shot_command));
+
+	// Replay (replay.h): recording keeps what input handlers got, playback feeds handlers itself.
+	// Run a replay as a benchmark:
+	// 	Game.exe -game -nullrhi -nosound -unattended -cd_replay=name -cd_replay_quit
+	bool replay_feeding = false; // Input comes from feed_replay_input(), not from devices.
+
+	// Input handlers ask this first, false means playback is on and this is a device, ignore it.
+	bool take_action(Replay_Input input, bool pressed) {
+		if (replay.playback.playing && !replay_feeding) {
+			return false;
+		}
+		replay_record_action(&replay.recorder, input, pressed);
+		return true;
+	}
+
+	bool take_axis(Replay_Input input, float value) {
+		if (replay.playback.playing && !replay_feeding) {
+			return false;
+		}
+		replay_record_axis(&replay.recorder, input, value);
+		return true;
+	}
+
+	FString replay_path(const FString &name, const TCHAR *extension) {
+		return FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("Replays") / name + extension);
+	}
+
+	FString replay_name(const TArray<FString> &arguments) {
+		return arguments.Num() > 0 ? arguments[0] : TEXT("replay");
+	}
+
+	// cd.replay_record [name] 	- snapshot of the world now and input and frame times from now on,
+	// cd.replay_stop 			- write it to Saved/Replays/name.replay,
+	// cd.replay_play [name] 	- load the snapshot and play it, frame times are logged and written to name_frames.csv.
+	void replay_record_command(const TArray<FString> &arguments) {
+		A_Player *hero = Cast<A_Player>(A_Player::player.Get());
+		if (!hero || replay.playback.playing) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Replay can be recorded only in game and not while one is playing."));
+			return;
+		}
+
+		FString name = replay_name(arguments);
+		FString path = replay_path(name, TEXT(".snapshot"));
+		IFileManager::Get().MakeDirectory(*FPaths::GetPath(path), true);
+
+		World_Snapshot snapshot;
+		A_Bot::save_world_snapshot(&snapshot);
+		if (!world_snapshot_write(snapshot, TCHAR_TO_UTF8(*path))) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Couldn't write replay snapshot to %s"), *path);
+			return;
+		}
+
+		replay.name = TCHAR_TO_UTF8(*name);
+		replay_recorder_start(&replay.recorder, simulation_clock.params.step_dt, snapshot.step, snapshot.seed, determinism.enabled ? REPLAY_DETERMINISTIC : 0);
+		hero->record_held_keys();
+
+		UE_LOG(Log_CD_Core, Log, TEXT("Recording replay %s from step %llu."), *name, (unsigned long long)snapshot.step);
+	}
+
+	void replay_stop_command(const TArray<FString> &arguments) {
+		if (!replay.recorder.recording) {
+			UE_LOG(Log_CD_Core, Log, TEXT("No replay is recording."));
+			return;
+		}
+
+		replay.recorder.recording = false;
+		FString path = replay_path(UTF8_TO_TCHAR(replay.name.c_str()), TEXT(".replay"));
+		if (!replay_recorder_write(replay.recorder, TCHAR_TO_UTF8(*path))) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Couldn't write replay to %s"), *path);
+			return;
+		}
+
+		UE_LOG(Log_CD_Core, Log, TEXT("Replay of %llu frames, %d KB, was written to %s"),
+			(unsigned long long)replay.recorder.frame_count, (int32)(replay.recorder.bytes.size() / 1024), *path);
+		replay.recorder = Replay_Recorder();
+	}
+
+	void start_replay_playback(const FString &name) {
+		A_Player *hero = Cast<A_Player>(A_Player::player.Get());
+		if (!hero || replay.recorder.recording) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Replay can be played only in game and not while one is recording."));
+			return;
+		}
+
+		std::string error;
+		FString path = replay_path(name, TEXT(".replay"));
+		if (!replay_playback_start(&replay.playback, TCHAR_TO_UTF8(*path), &error)) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Couldn't play replay %s: %s"), *path, UTF8_TO_TCHAR(error.c_str()));
+			return;
+		}
+
+		FString snapshot_path = replay_path(name, TEXT(".snapshot"));
+		World_Snapshot_File file;
+		if (!world_snapshot_open(&file, TCHAR_TO_UTF8(*snapshot_path))) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Couldn't load replay snapshot %s: %s"), *snapshot_path, UTF8_TO_TCHAR(file.view.error));
+			replay.playback = Replay_Playback();
+			return;
+		}
+		A_Bot::load_world_snapshot(file.view);
+		world_snapshot_close(&file);
+
+		// Bots do the same only in the mode it was recorded in.
+		determinism.enabled 	= (replay.playback.header.flags & REPLAY_DETERMINISTIC) != 0;
+		determinism.seed 		= replay.playback.header.seed;
+		simulation_clock.params.step_dt = replay.playback.header.step_dt;
+		hero->release_keys();
+
+		// This frame is half gone, first recorded frame is the next one. Engine takes recorded frame times too,
+		// without waiting for them, so props move like they did and we go as fast as the machine does.
+		replay.name 			= TCHAR_TO_UTF8(*name);
+		replay.playback.frame 	= GFrameCounter;
+		FApp::SetUseFixedTimeStep(true);
+		FApp::SetFixedDeltaTime(replay.playback.frames[0].dt);
+
+		UE_LOG(Log_CD_Core, Log, TEXT("Playing replay %s, %d frames from step %llu."),
+			*name, (int32)replay.playback.frames.size(), (unsigned long long)replay.playback.header.start_step);
+	}
+
+	void replay_play_command(const TArray<FString> &arguments) {
+		start_replay_playback(replay_name(arguments));
+	}
+
+	// Playback went to the end: frame times to log and csv, and quit if we were started only for it.
+	void finish_replay_playback() {
+		replay.playback.finished = false;
+		FApp::SetUseFixedTimeStep(false);
+
+		std::vector<std::string> lines;
+		replay_playback_report(replay.playback, &lines);
+		for (const std::string &line : lines) {
+			UE_LOG(Log_CD_Core, Log, TEXT("%s"), UTF8_TO_TCHAR(line.c_str()));
+		}
+
+		FString path = replay_path(UTF8_TO_TCHAR(replay.name.c_str()) + FString(TEXT("_frames")), TEXT(".csv"));
+		if (replay_playback_write_csv(replay.playback, TCHAR_TO_UTF8(*path))) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Frame times were written to %s"), *path);
+		}
+
+		if (FParse::Param(FCommandLine::Get(), TEXT("cd_replay_quit"))) {
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+
+	FAutoConsoleCommand replay_record_console_command(
+		TEXT("cd.replay_record"),
+		TEXT("Snapshot of the world and player input and frame times from now until cd.replay_stop. See replay.h."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&replay_record_command));
+
+	FAutoConsoleCommand replay_stop_console_command(
+		TEXT("cd.replay_stop"),
+		TEXT("Stop recording and write Saved/Replays/name.replay."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&replay_stop_command));
+
+	FAutoConsoleCommand replay_play_console_command(
+		TEXT("cd.replay_play"),
+		TEXT("Play Saved/Replays/name.replay from its snapshot and log frame times."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&replay_play_command));
+
+	bool replay_command_line_checked = false;
+
+	// Our part of deterministic mode step hash, see determinism.h.
+	uint64_t hash_player() {
+		State_Hash hash;
+		state_hash_vec3(&hash, mover_state.position);
+		state_hash_vec3(&hash, mover_state.velocity);
+		state_hash_int(&hash, mover_state.grounded);
+		state_hash_vec3(&hash, mouse_look_forward(mouse_look));
+		state_hash_int(&hash, is_walking | currently_rewinding << 1 | allowed_to_rewind << 2);
+		state_hash_int(&hash, state_array.world_count);
+		return hash.value;
+	}
 }
 
 A_Player::A_Player(const FObjectInitializer &ObjectInitializer) : Super(ObjectInitializer) {
@@ -113,25 +432,17 @@ A_Player::A_Player(const FObjectInitializer &ObjectInitializer) : Super(ObjectIn
 	
 	bool is_registered_and_collides = true;
 	collision_box->SetBoxExtent(collision_bounds, is_registered_and_collides);
-	collision_box->SetSimulatePhysics(true);
-	
-	// Get adress of a struct that we can use for physical manipulations. 
-	collision_physics = collision_box->GetBodyInstance();
-	
-	// We will lock X and Y rotation of collision, so that our collision
-	// box wouldn't fall on the ground.
-	collision_physics->bLockYRotation = 1;
-	collision_physics->bLockXRotation = 1;
-	
-	collision_physics->LinearDamping = 0; // I use my own drag forces.
 
-	// @hack: I use this so that my collision wouldn't rotate after given it a walking impulse.
-	collision_physics->InertiaTensorScale = FVector(10000.0f);
+	// We move collision ourselves with sweeps (kinematic_mover.h), physics doesn't simulate it.
+	// Location is absolute, so relative location is world location, like it was with simulated body.
+	collision_box->SetSimulatePhysics(false);
+	collision_box->SetUsingAbsoluteLocation(true);
 
-	collision_box->SetCollisionProfileName(UCollisionProfile::PhysicsActor_ProfileName);
+	collision_box->SetCollisionProfileName(UCollisionProfile::Pawn_ProfileName);
 	collision_box->SetShouldUpdatePhysicsVolume(true);
-	//collision_box->bDynamicObstacle = true;
-	//collision_box->SetCanEverAffectNavigation(false);
+	// We are moving collision, so we don't want to be baked into navigation.
+	collision_box->bDynamicObstacle = true;
+	collision_box->SetCanEverAffectNavigation(false);
 	//collision_box->CanCharacterStepUpOn = ECB_No;
 	
 	camera = ObjectInitializer.CreateDefaultSubobject<UCameraComponent>(this, TEXT("Camera"));
@@ -185,13 +496,65 @@ void A_Player::BeginPlay() {
 	game_started = true;
 
 	// Interestingly, if I begin playing, this global variable doesn't reset, if I'm restarting the map.
-	// So I'm resetting this camera vector cache for now.
-	camera_euler_rotation = FRotator(0);
+	// So I'm resetting mouse look for now.
+	mouse_look_reset(&mouse_look);
+
+	// Camera takes mouse after every actor ticked, that's the latest we can do before camera manager uses it.
+	late_camera_handle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &A_Player::late_update_camera);
 
 	// Reset state arrays before new playing new game.
 	state_array.world_count = 0;
 	state_array.world_memory_size = 0;
 	save_world_state_timer = 0;
+
+	trace_recorder_set_thread_name("Game thread");
+
+	mover_collision.world 		= GetWorld();
+	mover_collision.parameters 	= FCollisionQueryParams(FName(TEXT("player_mover")), false, this);
+	mover_collision.channel 	= ECC_Pawn;
+
+	mover_params.half_extents 	= to_vec3(collision_bounds);
+	mover_params.gravity 		= GetWorld()->GetGravityZ();
+
+	mover_state 				= Kinematic_Mover_State();
+	mover_state.position 		= to_vec3(collision_box->GetComponentLocation());
+	kinematic_mover_snap_to_ground(mover_collision, mover_params, &mover_state, mover_params.ground_snap_distance);
+	interpolated_position_reset(&interpolation, mover_state.position);
+
+	// New game starts from step zero, for bots too.
+	fixed_step_reset(&simulation_clock);
+	determinism_log_clear(&determinism.log);
+	lag_history_init(&lag_history, 64);
+	player_lag_id = determinism_id_from_name(TCHAR_TO_UTF8(*GetName()));
+	net_started = false;
+
+	blackboard_handle = blackboard_add(&blackboard, BLACKBOARD_PLAYER);
+	blackboard_write_entity(&blackboard, blackboard_handle, mover_state.position, mover_state.velocity);
+
+	// -cd_replay=name plays it on our first Tick, when bots have begun too.
+	replay_command_line_checked = false;
+}
+
+void A_Player::EndPlay(const EEndPlayReason::Type end_play_reason) {
+	FWorldDelegates::OnWorldPostActorTick.Remove(late_camera_handle);
+
+	// Bots see we are gone next frame.
+	blackboard_remove(&blackboard, blackboard_handle);
+	blackboard_handle = Blackboard_Handle();
+
+	// Post update doesn't outlive us and doesn't keep pointers to our components.
+	A_Post_Update::player_root_entity 			= nullptr;
+	A_Post_Update::player_collision_box_entity 	= nullptr;
+	if (post_update.IsValid()) {
+		post_update->Destroy();
+	}
+	post_update = nullptr;
+
+	if (player == this) {
+		player = nullptr;
+	}
+
+	Super::EndPlay(end_play_reason);
 }
 
 void A_Player::spawn_additional_entities_for_player() {	
@@ -200,31 +563,79 @@ void A_Player::spawn_additional_entities_for_player() {
 	//AActor *post_update = GWorld->SpawnActor<A_Post_Update>(A_Post_Update::StaticClass(), FVector(0), FRotator(0), post_update_spawn_info);
 	
 	// Spawn post_update entity that will execute post physics code for player.
-	AActor *post_update = GWorld->SpawnActor<A_Post_Update>(A_Post_Update::StaticClass());
+	post_update = GWorld->SpawnActor<A_Post_Update>(A_Post_Update::StaticClass());
 }
 
 void A_Player::Tick(float dt) {
+	trace_scope("A_Player::Tick");
+
 	Super::Tick(dt);
 
+	// What we and bots wrote last frame goes out, whoever ticks first does it. Same for debug lines.
+	blackboard_begin_frame(&blackboard, GFrameCounter);
+	debug_draw_flush(GetWorld(), GFrameCounter);
+
+	if (!replay_command_line_checked) {
+		replay_command_line_checked = true;
+		FString replay_to_play;
+		if (FParse::Value(FCommandLine::Get(), TEXT("cd_replay="), replay_to_play)) {
+			start_replay_playback(replay_to_play);
+		}
+	}
+
+	// Input of this frame came before Tick, so frame tag goes after it. Playback gives recorded frame time
+	// and input instead, see replay.h.
+	replay_record_frame(&replay.recorder, GFrameCounter, dt);
+	dt = replay_play_frame(&replay.playback, GFrameCounter, dt, FPlatformTime::Seconds());
+	feed_replay_input();
+	if (replay.playback.finished) {
+		finish_replay_playback();
+	}
+
 	// @todo: Make dt global.
 
 	// @note: If player entity gets too high (or too low?) Unreal will delete it.
-	// @bug: If you pause in editor play, while falling, and you wait a little, velocity becomes very high and collision passes through ground after you press play and continue.
-	player_position = GetActorLocation();
+	// @note: Collision is moved by sweeps now (kinematic_mover.h), so a long frame after pause in editor play
+	// can't take us through the ground anymore, sweep can't skip what is between start and end.
 	//UE_LOG(Log_CD_Core, Log, TEXT("Player position: %s"), *GetActorLocation().ToString());
 	
-	move_camera(dt);
+	// We walk where we look, so mouse that came so far turns collision before we move.
+	move_camera();
+
+	// Movement and rewind run in fixed steps, how many depends on how long the frame was.
+	// Bots get the same steps from the same clock.
+	int 	steps 	= fixed_step_advance(&simulation_clock, GFrameCounter, dt);
+	float 	step_dt = simulation_clock.params.step_dt;
+	for (int i = 0; i < steps; ++i) {
+		if (!currently_rewinding) {
+			net_step = simulation_clock.first_step_this_frame + i;
+			move_player(step_dt);
+		} else {
+			net_started = false; // History is not ours anymore.
+		}
+
+		// @todo: What's the execution order of physics? By now, raycast will be always behind one frame.
+		// This is okay for now, but in the future we will need current frame precision.
+		// Is this even possible with Unreal Engine's execution order?
+		//raycast(step_dt);
+
+		time_control(step_dt);
 
-	if (!currently_rewinding) {
-		move_player(dt);
+		interpolated_position_push(&interpolation, mover_state.position);
+		lag_history_add(&lag_history, simulation_clock.first_step_this_frame + i, player_lag_id, mover_state.position, mover_params.half_extents);
+
+		if (determinism.enabled) {
+			determinism_log_add(&determinism.log, simulation_clock.first_step_this_frame + i, hash_player());
+		}
 	}
 
-	// @todo: What's the execution order of physics? By now, raycast will be always behind one frame.
-	// This is okay for now, but in the future we will need current frame precision.
-	// Is this even possible with Unreal Engine's execution order?
-	//raycast(dt);
+	// Bots read where we are from blackboard next frame, that's where our collision is, not where we are drawn.
+	player_position = to_fvector(mover_state.position);
+	blackboard_write_entity(&blackboard, blackboard_handle, mover_state.position, mover_state.velocity);
 
-	time_control(dt);
+	// After rollback correction we are drawn where we were predicted and slide to where server says, see rollback.h.
+	Vec3 net_offset = net_started ? net_client.visual_offset : Vec3();
+	root->SetWorldLocation(to_fvector(interpolated_position_get(interpolation, fixed_step_alpha(simulation_clock)) + net_offset));
 
 	send_variables_to_post_update();
 }
@@ -232,171 +643,83 @@ void A_Player::Tick(float dt) {
 void A_Player::send_variables_to_post_update() {
 	// @hack: Separate entity for post update, after all physics are done.
 	// I could have done it, by making separate tick functions for player, but I'm lazy to work through this Unreal Engine tick logic.
-	// @bug: Game crushes if player was deleted.
+	// Pointers are cleared and post update is destroyed in EndPlay, so it doesn't use them after we are gone.
+	// @todo: Post update should read our root from blackboard (blackboard.h) instead of getting pointers.
+	// @note: Root is placed in Tick between fixed steps now, post update shouldn't move it to collision box anymore.
 	A_Post_Update::player_root_entity = root;
 	A_Post_Update::player_collision_box_entity = collision_box;
 }
 
-void A_Player::move_camera(float dt) {
-	// @speed: Right now I use euler rotation for mouse input and convert euler to quternion.
-	// I need to learn how to use quaternion only for rotation inputs. If I do, this code will become faster.
-	
-	// @note: On low FPS (like 30) camera moves faster. Probably something to do with parallel input
-	// processing in Unreal Engine or maybe that it's only 30 cycles in game frame timer, don't know.
-	// Maybe later I could change camera move speed depending on current framerate.
-	FRotator camera_mouse_rotation(0);
-	camera_mouse_rotation.Yaw 	= mouse_input_x * mouse_design_sensitivity * mouse_user_overall_sensitivity * mouse_user_sensitivity_x * dt;
-	camera_mouse_rotation.Pitch = mouse_input_y * mouse_design_sensitivity * mouse_user_overall_sensitivity * mouse_user_sensitivity_y * dt;
-	
-	camera_euler_rotation += camera_mouse_rotation;
-	camera_euler_rotation.Roll = 0.0f; // @note: Potentially can be used for head leaning, but I will lock this axis for now.
-	
-	// Clamp Pitch value to move camera not more than straight down and up.
-	camera_euler_rotation.Pitch = FMath::Clamp(camera_euler_rotation.Pitch, -90.f, 90.0f);
-	
-	// Rotate camera without smoothing. This is Normilized Lerp method.
-	// Formula: q = lerp(q1, q2, 0.1).normalize()
-/*
-		FQuat old_quaternion_rotation = camera->GetComponentQuat();
-		FQuat target_quaternion_rotation = FQuat(FVector::UpVector, FMath::DegreesToRadians(camera_euler_rotation.Yaw)) * FQuat(FVector::LeftVector, FMath::DegreesToRadians(camera_euler_rotation.Pitch));
-		FQuat new_quaternion_rotation = FQuat::FastLerp(old_quaternion_rotation, target_quaternion_rotation, mouse_camera_smoothness);
-		new_quaternion_rotation.Normalize();
-*/
-	
-	// Rotate camera without smoothing.
-	FQuat new_quaternion_rotation = camera_rotation_conversion.RotatorToQuat(camera_euler_rotation);
+void A_Player::move_camera() {
+	trace_scope("A_Player::move_camera");
+
+	// Sensitivity can change from settings any time.
+	Mouse_Look_Params params 	= mouse_look_params;
+	params.degrees_per_unit_x 	*= mouse_user_overall_sensitivity * mouse_user_sensitivity_x;
+	params.degrees_per_unit_y 	*= mouse_user_overall_sensitivity * mouse_user_sensitivity_y;
+	mouse_look_latch(&mouse_look, params);
+
+	// Roll is locked. @note: Potentially can be used for head leaning.
+	camera->SetRelativeRotation(to_fquat(mouse_look_rotation(mouse_look)));
+}
+
+void A_Player::late_update_camera(UWorld *world, ELevelTick tick_type, float dt) {
+	if (world != GetWorld()) {
+		return;
+	}
 
-	// Set new rotation.
-	camera->SetRelativeRotation(new_quaternion_rotation);
+	// Whatever mouse came after our Tick is on screen this frame, not next one.
+	move_camera();
 }
 
 void A_Player::move_player(float dt) {
+	trace_scope("A_Player::move_player");
+
 	// We rotate box collision by Z axes with the camera.
-	FRotator collision_box_rotation = collision_box->GetRelativeRotation();
-	collision_box_rotation.Yaw 		= camera_euler_rotation.Yaw;
-	FQuat new_collision_rotation 	= collision_rotation_conversion.RotatorToQuat(collision_box_rotation);
-	collision_box->SetRelativeRotation(new_collision_rotation);
+	collision_box->SetRelativeRotation(to_fquat(mouse_look.yaw));
 	
-	// Get direction vectors of collision for movement.
-	FVector collision_forward_vector 	= collision_box->GetForwardVector();
-	FVector collision_up_vector 		= collision_box->GetUpVector();
+	// Direction of collision for movement.
+	Vec3 collision_forward_vector = mouse_look_forward(mouse_look);
 
 	// If we are not pressing any walking buttons, we are not walking.
 	if (!is_move_forward_pressed && !is_move_backward_pressed && !is_move_right_pressed && !is_move_left_pressed) {
 		is_walking = false;
 	}
 
+	uint32_t buttons = 0;
 	if (is_walking) {
-		FVector current_walking_vector(0, 0, 0);
-		float current_speed = 0;
-
-		// @note: Right now I do not use gamepad stick XY inputs.
-		if (is_move_forward_pressed) {
-			current_walking_vector += move_forward_xy;
-			current_speed += forward_force;
-		}
-		
-		if (is_move_backward_pressed) {
-			current_walking_vector += move_backward_xy;
-			current_speed += backward_force;
-		}
-		
-		if (is_move_right_pressed){
-			current_walking_vector += move_right_xy;
-			current_speed += right_force;
-		}
-		
-		if (is_move_left_pressed) {
-			current_walking_vector += move_left_xy;
-			current_speed += left_force;
-		}
-
-		// Normalize walking vector to fit into unit circle.
-		current_walking_vector.Normalize();
-		
-		// We find angle through dot product and we use found number in arccosine (or inverse cosine) to get angle in radians,
-		// between our vector and (as I call it) sine vector.
-		// If our vector is poiting at negative X axis, we need compensate that this angle to get past 180 degrees.
-		// I do that to player collision so that it perfectly translates from Unreal XY bottom-up view to my XY top-down unit circle.
-		float collision_angle = FMath::Acos(FVector::DotProduct(collision_forward_vector, FVector(0,1,0)));
-		if (collision_forward_vector.X < 0) {
-			collision_angle = tau - collision_angle;
-		}
-		
-		// For inputs we are comparing to cosine vector.
-		// If our vector is poiting at negative Y axis, then we turned past pi, and we need to subtract found angle from full circle to get correct angle.
-		// We do this for correcting XY input interpretation to place it on unit circle from 0 degrees (x=1,y=0) to 360 degrees (x=1,y=0).
-		float input_angle = FMath::Acos(FVector::DotProduct(current_walking_vector, FVector(1,0,0)));
-		if (current_walking_vector.Y < 0) {
-			input_angle = tau - input_angle;
-		}
-
-		// Correct collision angle. It's like turning trig circle on 90 degrees to the left.
-		// Think about it as if input angle has sine relationship and collision angle has cosine relationship,
-		// and final angle for world space would have sine relationship.
-		// I found this pattern by investigating unit circle; I think I understand it,
-		// but for now I can't reason this idea quite well into words.
-		// -- Richard Chirkin 12.01.2022
-		collision_angle -= half_pi;
-
-		// We add corrected player collision angle to input angle on unit circle and we get correct angle for player walking direction.
-		float direction_angle = collision_angle + input_angle;
-		
-		// Because Unreal Engine XY axis are placed underneath Z axis (look at XY from bottom-up view),
-		// we need to translate direction angle from unit circle (XY top-down) to Unreal YX top-down view (right is Y = 1 and forward is X = 1).
-		direction_angle = tau - (direction_angle - half_pi);
-
-		//UE_LOG(Log_CD_Core, Log, TEXT("angle: %.2f"), direction_angle * (180/pi));
-		
-		// Finally, we find the right normalized XY coordinates from cosine and sine angle. 
-		FVector direction_vector(0,0,0);
-		FMath::SinCos(&direction_vector.Y, &direction_vector.X, direction_angle);
-
-		// If we got several directions - clamp speed;
-		// @note: 	We can use input_angle to find the difference between forward and right speed, etc.,
-		// 			for example like adding to perpendicular speeds (forward and left) if they are different.
-		// 			Formula is something like: (right_speed / 2) + (forward_speed / 2). Should be useful for stick input.
-		if (current_speed > max_walking_speed) {
-			current_speed = max_walking_speed;
-		}
-
-		// Tell physics system in what direction should we move with our constracted walking direction vector.
-		collision_physics->AddImpulse(direction_vector * (current_speed * dt), mass_has_no_effect);
+		if (is_move_forward_pressed) 	buttons |= MOVEMENT_FORWARD;
+		if (is_move_backward_pressed) 	buttons |= MOVEMENT_BACKWARD;
+		if (is_move_right_pressed) 		buttons |= MOVEMENT_RIGHT;
+		if (is_move_left_pressed) 		buttons |= MOVEMENT_LEFT;
 	}
-
 	if (is_jump_pressed) {
-		collision_physics->AddImpulse(collision_up_vector * (jump_force * dt), mass_has_no_effect);
+		buttons |= MOVEMENT_JUMP;
 	}
-	
-	// Add force to gravity.
-	collision_physics->AddImpulse(-collision_up_vector * (gravity_extra_force * dt), mass_has_no_effect);
-	
-	// We are clamping our walking velocity through drag forces.
-	// If were are not walking, we are initiating more powerfull drag force.
 
-	// @note: You can set instant velocity to collision with SetPhysicsLinearVelocity in PrimitiveComponent.
+	Rollback_Input input;
+	input.buttons 	= buttons;
+	input.forward_x = collision_forward_vector.x;
+	input.forward_y = collision_forward_vector.y;
+	// Server starts from the state this step starts from, so it runs the same step we do and not the one after it.
+	if (!net_loopback) {
+		net_started = false;
+	} else if (!net_started) {
+		start_net(net_step);
+	}
 
-	// @todo: This drag method will also try to stop you if you are not pressing any buttons and in air.
-	// I need moving states for this one, because I also moving very fast while falling.
-	// For example, if I move in air I should constraint magnitude of move_input vectors.
+	simulate_player(nullptr, input, &mover_state, dt);
 
-	collision_velocity = collision_physics->GetUnrealWorldVelocity();
+	if (net_started) {
+		update_net(input, dt);
+	}
 
-	// Debug velocity.
-	//UE_LOG(Log_CD_Core, Log, TEXT("Velocity: %s"), *collision_velocity.ToString());
+	collision_box->SetRelativeLocation(to_fvector(mover_state.position));
 
-	collision_velocity.Z = 0; // We do not use gravity, this is only for XY axes.
-	
-	// I'm taking current player velocity, inverse it and multiply it by desired drag force.
-	if (!is_walking) {
-		collision_physics->AddImpulse(-collision_velocity * (drag_stop_walking_force * dt), mass_has_no_effect);
-	} else {
-		collision_physics->AddImpulse(-collision_velocity * (drag_walking_force * dt), mass_has_no_effect);
-	}
+	collision_velocity = to_fvector(mover_state.velocity);
 
 	// We can know player speed by finding magnitude (length, e.g. speed) in velocity vector.
 	// This speed includes Z height velocity.
-	collision_velocity = collision_physics->GetUnrealWorldVelocity();
 	player_speed = collision_velocity.Size();
 }
 
@@ -420,7 +743,7 @@ void A_Player::raycast(float dt) {
 			FVector point_hit_normal 	= out_hit.ImpactNormal;
 			
 			// Draw vector of the first collision that we hit.
-			DrawDebugLine(GetWorld(), start, point_hit, FColor::Black, false, dt + 0.0001f, 0, 1.2f);
+			debug_line(DEBUG_DRAW_RAYCAST, to_vec3(start), to_vec3(point_hit), 0x000000, false);
 			
 			//UE_LOG(Log_CD_Core, Log, TEXT("Vector Z of hit: %.2f"), point_hit.Z);
 
@@ -435,11 +758,60 @@ void A_Player::raycast(float dt) {
 		}
 	} else {
 		// If no hit, trace a line with a different color.
-		DrawDebugLine(GetWorld(), start, end, FColor::Red, false, dt + 0.0001f, 0, 1.2f);
+		debug_line(DEBUG_DRAW_RAYCAST, to_vec3(start), to_vec3(end), 0xFF0000, false);
 	}
 }
 
+void A_Player::save_snapshot(World_Snapshot *snapshot) {
+	snapshot->has_player 			= true;
+	snapshot->player 				= Snapshot_Player();
+	snapshot->player.id 			= player_lag_id;
+	snapshot->player.position 		= mover_state.position;
+	snapshot->player.velocity 		= mover_state.velocity;
+	snapshot->player.ground_normal 	= mover_state.ground_normal;
+	snapshot->player.grounded 		= mover_state.grounded;
+	snapshot->player.yaw 			= mouse_look.yaw;
+	snapshot->player.pitch 			= mouse_look.pitch;
+	if (is_walking) {
+		snapshot->player.flags |= SNAPSHOT_WALKING;
+	}
+}
+
+void A_Player::load_snapshot(const World_Snapshot_View &view) {
+	if (!view.player) {
+		return;
+	}
+
+	const Snapshot_Player &saved 	= *view.player;
+	mover_state.position 			= saved.position;
+	mover_state.velocity 			= saved.velocity;
+	mover_state.ground_normal 		= saved.ground_normal;
+	mover_state.grounded 			= saved.grounded != 0;
+	is_walking 						= (saved.flags & SNAPSHOT_WALKING) != 0;
+
+	mouse_look_reset(&mouse_look);
+	mouse_look.yaw 		= saved.yaw;
+	mouse_look.pitch 	= saved.pitch;
+
+	collision_box->SetRelativeLocation(to_fvector(mover_state.position));
+	collision_box->SetRelativeRotation(to_fquat(mouse_look.yaw));
+	camera->SetRelativeRotation(to_fquat(mouse_look_rotation(mouse_look)));
+	interpolated_position_reset(&interpolation, mover_state.position);
+
+	// Rewind history and loopback server were of the world we left.
+	state_array.world_count 		= 0;
+	state_array.world_memory_size 	= 0;
+	allowed_to_rewind 				= false;
+	currently_rewinding 			= false;
+	net_started 					= false;
+
+	player_position = to_fvector(mover_state.position);
+	blackboard_write_entity(&blackboard, blackboard_handle, mover_state.position, mover_state.velocity);
+}
+
 void A_Player::time_control(float dt) {
+	trace_scope("A_Player::time_control");
+
 	// If you rewind the time, what will you do with Unreal clouds and sun?
 
 	// FTransform 	= 46 byte
@@ -492,12 +864,10 @@ void A_Player::time_control(float dt) {
 		collision_box->SetRelativeLocation(player_saved_position);
 		collision_box->SetRelativeRotation(player_saved_rotation);
 		
-		// We don't want to move when we are rewinding.
-		//collision_box->SetPhysicsLinearVelocity(FVector(0));
-		collision_physics->bLockXTranslation = 1;
-		collision_physics->bLockYTranslation = 1;
-		collision_physics->bLockZTranslation = 1;
-		//collision_physics->bLockZRotation = 1;
+		// We don't move when we are rewinding, move_player() isn't called.
+		mover_state.position = to_vec3(player_saved_position);
+		mover_state.velocity = Vec3(0, 0, 0);
+		mover_state.grounded = false;
 
 		--state_array.world_count;
 		state_array.world_memory_size -= world_state_type_memory_size;
@@ -511,10 +881,7 @@ void A_Player::time_control(float dt) {
 			// save_world_state_timer is reset on rewind button release.
 
 			// Start moving with last saved speed.
-			collision_physics->bLockXTranslation = 0;
-			collision_physics->bLockYTranslation = 0;
-			collision_physics->bLockZTranslation = 0;
-			collision_box->SetPhysicsLinearVelocity(player_saved_velocity);
+			mover_state.velocity = to_vec3(player_saved_velocity);
 		}
 
 		/*
@@ -539,54 +906,102 @@ void A_Player::time_control(float dt) {
 }
 
 void A_Player::move_forward() {
+	if (!take_action(REPLAY_MOVE_FORWARD, true)) {
+		return;
+	}
+
 	is_move_forward_pressed = true;
 	is_walking = true;
 }
 
 void A_Player::move_backward() {
+	if (!take_action(REPLAY_MOVE_BACKWARD, true)) {
+		return;
+	}
+
 	is_move_backward_pressed = true;
 	is_walking = true;
 }
 
 void A_Player::move_right() {
+	if (!take_action(REPLAY_MOVE_RIGHT, true)) {
+		return;
+	}
+
 	is_move_right_pressed = true;
 	is_walking = true;
 }
 
 void A_Player::move_left() {
+	if (!take_action(REPLAY_MOVE_LEFT, true)) {
+		return;
+	}
+
 	is_move_left_pressed = true;
 	is_walking = true;
 }
 
 void A_Player::jump() {
+	if (!take_action(REPLAY_JUMP, true)) {
+		return;
+	}
+
 	is_jump_pressed = true;
 }
 
 void A_Player::time_rewind() {
+	if (!take_action(REPLAY_TIME_REWIND, true)) {
+		return;
+	}
+
 	is_time_rewind_pressed = true;
 }
 
 void A_Player::move_forward_released() {
+	if (!take_action(REPLAY_MOVE_FORWARD, false)) {
+		return;
+	}
+
 	is_move_forward_pressed = false;
 }
 
 void A_Player::move_backward_released() {
+	if (!take_action(REPLAY_MOVE_BACKWARD, false)) {
+		return;
+	}
+
 	is_move_backward_pressed = false;
 }
 
 void A_Player::move_right_released() {
+	if (!take_action(REPLAY_MOVE_RIGHT, false)) {
+		return;
+	}
+
 	is_move_right_pressed = false;
 }
 
 void A_Player::move_left_released() {
+	if (!take_action(REPLAY_MOVE_LEFT, false)) {
+		return;
+	}
+
 	is_move_left_pressed = false;
 }
 
 void A_Player::jump_released() {
+	if (!take_action(REPLAY_JUMP, false)) {
+		return;
+	}
+
 	is_jump_pressed = false;
 }
 
 void A_Player::time_rewind_released() {
+	if (!take_action(REPLAY_TIME_REWIND, false)) {
+		return;
+	}
+
 	is_time_rewind_pressed = false;
 	
 	// Failsafe if player quit rewinding before exceeding all available rewind states.
@@ -600,19 +1015,70 @@ void A_Player::time_rewind_released() {
 	// Start moving with last saved speed if we not rewinding.
 	FVector player_saved_velocity = state_array.world[state_array.world_count].saved_player.velocity;
 
-	collision_physics->bLockXTranslation = 0;
-	collision_physics->bLockYTranslation = 0;
-	collision_physics->bLockZTranslation = 0;
-	
-	collision_box->SetPhysicsLinearVelocity(player_saved_velocity);
+	mover_state.velocity = to_vec3(player_saved_velocity);
 }
 
 void A_Player::mouse_movement_x(float value) {
 	//UE_LOG(Log_CD_Core, Log, TEXT("Mouse X: %.3f"), value);
-	mouse_input_x = value;
+	if (!take_axis(REPLAY_MOUSE_X, value)) {
+		return;
+	}
+	mouse_look_push(&mouse_look, FPlatformTime::Seconds(), value, 0);
 }
 
 void A_Player::mouse_movement_y(float value) {
 	//UE_LOG(Log_CD_Core, Log, TEXT("Mouse Y: %.3f"), value);
-	mouse_input_y = value;
-}
\ No newline at end of file
+	if (!take_axis(REPLAY_MOUSE_Y, value)) {
+		return;
+	}
+	mouse_look_push(&mouse_look, FPlatformTime::Seconds(), 0, value);
+}
+
+void A_Player::record_held_keys() {
+	if (is_move_forward_pressed) 	replay_record_action(&replay.recorder, REPLAY_MOVE_FORWARD, true);
+	if (is_move_backward_pressed) 	replay_record_action(&replay.recorder, REPLAY_MOVE_BACKWARD, true);
+	if (is_move_right_pressed) 		replay_record_action(&replay.recorder, REPLAY_MOVE_RIGHT, true);
+	if (is_move_left_pressed) 		replay_record_action(&replay.recorder, REPLAY_MOVE_LEFT, true);
+	if (is_jump_pressed) 			replay_record_action(&replay.recorder, REPLAY_JUMP, true);
+	if (is_time_rewind_pressed) 	replay_record_action(&replay.recorder, REPLAY_TIME_REWIND, true);
+}
+
+void A_Player::release_keys() {
+	is_move_forward_pressed 	= false;
+	is_move_backward_pressed 	= false;
+	is_move_right_pressed 		= false;
+	is_move_left_pressed 		= false;
+	is_jump_pressed 			= false;
+	is_time_rewind_pressed 		= false;
+}
+
+void A_Player::feed_replay_input() {
+	const Replay_Frame *frame = replay_current_frame(replay.playback);
+	if (!frame || replay.playback.fed_frame == GFrameCounter) {
+		return;
+	}
+	replay.playback.fed_frame = GFrameCounter;
+
+	replay_feeding = true;
+	for (uint32_t i = 0; i < frame->event_count; ++i) {
+		const Replay_Event &event = replay.playback.events[frame->first_event + i];
+		switch (event.input) {
+			case REPLAY_MOVE_FORWARD: 	event.pressed ? move_forward() 	: move_forward_released(); 	break;
+			case REPLAY_MOVE_BACKWARD: 	event.pressed ? move_backward() : move_backward_released(); break;
+			case REPLAY_MOVE_RIGHT: 	event.pressed ? move_right() 	: move_right_released(); 	break;
+			case REPLAY_MOVE_LEFT: 		event.pressed ? move_left() 	: move_left_released(); 	break;
+			case REPLAY_JUMP: 			event.pressed ? jump() 			: jump_released(); 			break;
+			case REPLAY_TIME_REWIND: 	event.pressed ? time_rewind() 	: time_rewind_released(); 	break;
+			case REPLAY_MOUSE_X: 		mouse_movement_x(event.value); 	break;
+			case REPLAY_MOUSE_Y: 		mouse_movement_y(event.value); 	break;
+			default: break;
+		}
+	}
+	replay_feeding = false;
+
+	// Engine takes the next frame with its recorded time too.
+	int64_t next = replay.playback.current + 1;
+	if (next < (int64_t)replay.playback.frames.size()) {
+		FApp::SetFixedDeltaTime(replay.playback.frames[next].dt);
+	}
+}
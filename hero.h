@@ -5,6 +5,8 @@
 #include "GameFramework/Pawn.h"
 #include "Engine/EngineTypes.h" // For Player control.
 
+#include "blackboard.h"
+
 #include "hero.generated.h"
 
 // @todo: Will need to move them in another file later and using them through namespace.
@@ -38,8 +40,12 @@ public:
 
 	static bool 	game_started;
 	static float 	player_speed;
-	static FVector 	player_position;
-	static AActor 	*player;
+	static FVector 	player_position; 	// @note: AI reads us from blackboard (blackboard.h), this is for HUI.
+	static TWeakObjectPtr<AActor> player; // Null after we are gone.
+
+	// What bots and jobs know about us, see blackboard.h.
+	Blackboard_Handle blackboard_handle;
+	TWeakObjectPtr<AActor> post_update;
 
 	// Execution of the entity comes in this order:
 	// Class() -> PostLoad() -> BeginPlay() -> Tick()
@@ -48,17 +54,24 @@ public:
 	virtual void BeginPlay() override;
 			void spawn_additional_entities_for_player();
 	virtual void Tick(float dt) override;
+	virtual void EndPlay(const EEndPlayReason::Type end_play_reason) override;
 			void send_variables_to_post_update();
 
 
 	// Inputs are set in project setting in Input category and also you can add and edit inputs in Config->DefaultInput.ini
 	virtual void SetupPlayerInputComponent(UInputComponent *input_component) override;
 
-	void move_camera(float dt);
+	void move_camera();
+	void late_update_camera(UWorld *world, ELevelTick tick_type, float dt); // Mouse that came after Tick, see mouse_look.h.
+	FDelegateHandle late_camera_handle;
 	void move_player(float dt);
 	void raycast(float dt);
 	void time_control(float dt);
 
+	// Our part of world snapshot, see world_snapshot.h.
+	void save_snapshot(struct World_Snapshot *snapshot);
+	void load_snapshot(const struct World_Snapshot_View &view);
+
 	// Input logic.
 	// Action Mappings:
 	void move_forward();
@@ -75,6 +88,12 @@ public:
 	void jump_released();
 	void time_rewind_released();
 
+	// Replay (replay.h): keys held when recording starts are its first input, playback starts with none held
+	// and gets its input from feed_replay_input(), not from devices.
+	void record_held_keys();
+	void release_keys();
+	void feed_replay_input();
+
 	bool is_move_forward_pressed = false;
 	bool is_move_backward_pressed = false;
 	bool is_move_right_pressed = false;
@@ -0,0 +1,149 @@
+#include "kinematic_mover.h"
+
+namespace {
+	struct Slide_Result {
+		Vec3 position;
+		Vec3 velocity;
+		bool hit_wall 		= false;
+		bool hit_ground 	= false;
+		Vec3 ground_normal 	= Vec3(0, 0, 1);
+	};
+
+	bool is_walkable(const Kinematic_Mover_Params &params, Vec3 normal) {
+		return normal.z >= params.walkable_normal_z;
+	}
+
+	// Sweeps box along delta and slides along everything it hits, velocity loses the part that went into surfaces.
+	Slide_Result slide(const Collision_Query &collision, const Kinematic_Mover_Params &params, Vec3 position, Vec3 delta, Vec3 velocity) {
+		Slide_Result result;
+		result.position = position;
+		result.velocity = velocity;
+
+		Vec3 first_normal;
+		for (int i = 0; i < params.max_slides && vec3_length_squared(delta) > 0.0001f; ++i) {
+			Collision_Hit hit;
+			if (!collision.box_sweep(result.position, result.position + delta, params.half_extents, &hit)) {
+				result.position += delta;
+				break;
+			}
+
+			// Stop a bit before the surface.
+			Vec3 normal 	= hit.normal;
+			result.position = hit.point + normal * params.skin;
+
+			if (is_walkable(params, normal)) {
+				result.hit_ground 		= true;
+				result.ground_normal 	= normal;
+			} else {
+				result.hit_wall = true;
+			}
+
+			// What's left of the move goes along the surface.
+			delta = delta * (1.0f - hit.fraction);
+			delta -= normal * vec3_dot(delta, normal);
+
+			// Second surface makes a crease, we can only go along it or we bounce between them.
+			if (i > 0 && vec3_dot(delta, first_normal) < 0) {
+				Vec3 	crease 			= vec3_cross(first_normal, normal);
+				float 	crease_length 	= vec3_length(crease);
+				if (crease_length < 0.0001f) {
+					break;
+				}
+				crease 	= crease / crease_length;
+				delta 	= crease * vec3_dot(delta, crease);
+			}
+			first_normal = normal;
+
+			float into_surface = vec3_dot(result.velocity, normal);
+			if (into_surface < 0) {
+				result.velocity -= normal * into_surface;
+			}
+		}
+
+		return result;
+	}
+
+	// Finds walkable ground up to distance below, returns where box stands on it.
+	bool find_ground(const Collision_Query &collision, const Kinematic_Mover_Params &params, Vec3 position, float distance, Vec3 *out_position, Vec3 *out_normal) {
+		Collision_Hit hit;
+		if (!collision.box_sweep(position, position - Vec3(0, 0, distance), params.half_extents, &hit) || !is_walkable(params, hit.normal)) {
+			return false;
+		}
+
+		*out_position 	= hit.point + Vec3(0, 0, params.skin);
+		*out_normal 	= hit.normal;
+		return true;
+	}
+}
+
+void kinematic_mover_move(const Collision_Query &collision, const Kinematic_Mover_Params &params, Kinematic_Mover_State *state, float dt) {
+	bool was_grounded = state->grounded;
+
+	// Ground holds us, gravity only pulls when we are in the air.
+	if (was_grounded && state->velocity.z <= 0) {
+		state->velocity.z = 0;
+	} else {
+		state->velocity.z += params.gravity * dt;
+	}
+
+	// Up is only a jump, walking up a slope doesn't throw us in the air.
+	bool jumping = state->velocity.z > 0;
+
+	Vec3 			start 	= state->position;
+	Vec3 			delta 	= state->velocity * dt;
+	Slide_Result 	result 	= slide(collision, params, start, delta, state->velocity);
+
+	// Wall stopped us while walking, maybe it's a step: go up, forward and back down.
+	Vec3 delta_xy(delta.x, delta.y, 0);
+	if (was_grounded && result.hit_wall && vec3_length_squared(delta_xy) > 0.0001f) {
+		Collision_Hit 	hit;
+		Vec3 			up = start + Vec3(0, 0, params.step_height);
+		if (collision.box_sweep(start, up, params.half_extents, &hit)) {
+			up = hit.point - Vec3(0, 0, params.skin);
+		}
+
+		Slide_Result 	stepped = slide(collision, params, up, delta_xy, Vec3(state->velocity.x, state->velocity.y, 0));
+		Vec3 			landed, landed_normal;
+		bool 			got_further = vec3_distance_2d(start, stepped.position) > vec3_distance_2d(start, result.position) + params.skin;
+		if (got_further && find_ground(collision, params, stepped.position, (up.z - start.z) + params.ground_snap_distance, &landed, &landed_normal)) {
+			result.position 		= landed;
+			result.velocity 		= stepped.velocity;
+			result.hit_ground 		= true;
+			result.ground_normal 	= landed_normal;
+		}
+	}
+
+	if (was_grounded && !jumping) {
+		result.velocity.z = 0;
+	}
+
+	state->position = result.position;
+	state->velocity = result.velocity;
+
+	// Still on the ground, or walked off something low enough to snap down to it.
+	// Going up (jump) always leaves the ground.
+	state->grounded = false;
+	if (state->velocity.z <= 0) {
+		float 	distance = (was_grounded ? params.ground_snap_distance : 0) + params.skin * 2;
+		Vec3 	ground_position, ground_normal;
+		if (find_ground(collision, params, state->position, distance, &ground_position, &ground_normal)) {
+			state->position 		= ground_position;
+			state->ground_normal 	= ground_normal;
+			state->grounded 		= true;
+			state->velocity.z 		= 0;
+		}
+	}
+}
+
+bool kinematic_mover_snap_to_ground(const Collision_Query &collision, const Kinematic_Mover_Params &params, Kinematic_Mover_State *state, float distance) {
+	Vec3 ground_position, ground_normal;
+	if (!find_ground(collision, params, state->position, distance, &ground_position, &ground_normal)) {
+		state->grounded = false;
+		return false;
+	}
+
+	state->position 		= ground_position;
+	state->ground_normal 	= ground_normal;
+	state->grounded 		= true;
+	return true;
+}
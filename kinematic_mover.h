@@ -0,0 +1,47 @@
+#pragma once
+
+// Kinematic character mover: pawn is a box we move ourselves with sweeps, not a simulated rigid body.
+//
+// 	state.velocity += impulse; // from movement_kernel.h
+// 	kinematic_mover_move(collision, params, &state, dt);
+// 	collision_box->SetRelativeLocation(to_fvector(state.position));
+//
+// Every move:
+// 	- sweeps the box along velocity and slides along what it hits (a few times, for corners),
+// 	- if a wall stopped us on the ground, tries to step up on it (up, forward, down) and keeps that if it got further,
+// 	- keeps us on the ground when walking down slopes and steps (ground snap), so we don't fly off every small edge,
+// 	- gravity only pulls when we are not standing on walkable ground.
+//
+// Pawns used to be simulated UBoxComponents with locked rotations and huge inertia, so impulses wouldn't tip them over.
+// Every pawn was a dynamic body in the physics scene, and fast fall could tunnel through the ground after a long frame.
+// A sweep can't skip what is between its start and end, however long the frame was.
+//
+// @note: Works against any Collision_Query, so the same code moves pawns in game and in headless tools.
+// @note: Box we sweep is axis aligned on purpose, it doesn't yaw with the pawn like its UBoxComponent does.
+// Collision_Query only has axis aligned sweeps (headless backends are AABB only), and a box that turns could
+// start its next sweep inside a wall just by turning. Keep half_extents square in XY, then turned box is
+// at most sqrt(2) wider in corners and nothing else changes.
+
+#include "collision_query.h"
+
+struct Kinematic_Mover_Params {
+	Vec3 	half_extents 			= Vec3(20.0f, 20.0f, 92.0f);
+	float 	gravity 				= -980.0f; 	// World gravity Z, extra gravity comes from movement kernel.
+	float 	step_height 			= 45.0f; 	// Steps up to this high are climbed without jumping.
+	float 	ground_snap_distance 	= 45.0f; 	// Walking off something lower than this keeps us on the ground, same as step height.
+	float 	walkable_normal_z 		= 0.7f; 	// Ground steeper than about 45 degrees is a wall.
+	float 	skin 					= 0.5f; 	// We keep this far from surfaces, so next sweep doesn't start inside them.
+	int 	max_slides 				= 4;
+};
+
+struct Kinematic_Mover_State {
+	Vec3 position;
+	Vec3 velocity;
+	Vec3 ground_normal 	= Vec3(0, 0, 1);
+	bool grounded 		= false;
+};
+
+void kinematic_mover_move(const Collision_Query &collision, const Kinematic_Mover_Params &params, Kinematic_Mover_State *state, float dt);
+
+// Puts pawn on the ground below it (within distance), for spawning and teleports. Returns false if there is no ground.
+bool kinematic_mover_snap_to_ground(const Collision_Query &collision, const Kinematic_Mover_Params &params, Kinematic_Mover_State *state, float distance);
@@ -0,0 +1,345 @@
+#include "lag_compensation.h"
+
+#include <algorithm>
+#include <cmath>
+
+Lag_History lag_history;
+
+namespace {
+	Lag_Frame *find_frame(Lag_History *history, uint64_t step) {
+		if (history->frames.empty()) {
+			return nullptr;
+		}
+
+		Lag_Frame *frame = &history->frames[step % history->frames.size()];
+		return frame->step == step ? frame : nullptr;
+	}
+
+	// Segment fractions where it goes in and out of the box.
+	bool segment_box_range(Vec3 a, Vec3 b, Box3 box, float *out_enter, float *out_exit) {
+		float t_min = 0.0f;
+		float t_max = 1.0f;
+		float origin[3] 	= {a.x, a.y, a.z};
+		float direction[3] 	= {b.x - a.x, b.y - a.y, b.z - a.z};
+		float box_min[3] 	= {box.min.x, box.min.y, box.min.z};
+		float box_max[3] 	= {box.max.x, box.max.y, box.max.z};
+
+		for (int axis = 0; axis < 3; ++axis) {
+			if (std::fabs(direction[axis]) < 1.e-8f) {
+				if (origin[axis] < box_min[axis] || origin[axis] > box_max[axis]) {
+					return false;
+				}
+				continue;
+			}
+
+			float inverse = 1.0f / direction[axis];
+			float t0 = (box_min[axis] - origin[axis]) * inverse;
+			float t1 = (box_max[axis] - origin[axis]) * inverse;
+			if (t0 > t1) {
+				std::swap(t0, t1);
+			}
+
+			t_min = std::fmax(t_min, t0);
+			t_max = std::fmin(t_max, t1);
+			if (t_min > t_max) {
+				return false;
+			}
+		}
+
+		*out_enter 	= t_min;
+		*out_exit 	= t_max;
+		return true;
+	}
+
+	// Pawn index in next frame. Pawns usually come in the same order every step, so we look at the same index first.
+	int find_in_next(const Lag_Frame &next, int index, uint64_t id) {
+		if (index < (int)next.entities.size() && next.entities[index].id == id) {
+			return index;
+		}
+		for (int i = 0; i < (int)next.entities.size(); ++i) {
+			if (next.entities[i].id == id) {
+				return i;
+			}
+		}
+		return -1;
+	}
+
+	void build_grid(Lag_History *history, Lag_Frame *frame, const Lag_Frame *next) {
+		int count = (int)frame->entities.size();
+
+		frame->next_step = next ? next->step : UINT64_MAX;
+		frame->next_index.assign(count, -1);
+		frame->swept.resize(count);
+		for (int i = 0; i < count; ++i) {
+			const Lag_Entity &entity = frame->entities[i];
+			frame->swept[i] = box3_from_center(entity.center, entity.half_extents);
+			if (next) {
+				int j = find_in_next(*next, i, entity.id);
+				frame->next_index[i] = j;
+				if (j >= 0) {
+					frame->swept[i] = box3_union(frame->swept[i], box3_from_center(next->entities[j].center, next->entities[j].half_extents));
+				}
+			}
+		}
+
+		frame->bounds = count ? frame->swept[0] : Box3();
+		for (int i = 1; i < count; ++i) {
+			frame->bounds = box3_union(frame->bounds, frame->swept[i]);
+		}
+
+		// Pawns spread over the whole map would make too many cells, cells get bigger instead.
+		Vec3 extent 		= frame->bounds.max - frame->bounds.min;
+		int  max_cells 		= std::max(history->max_cells, 1);
+		frame->cell_size 	= std::fmax(std::fmax(history->cell_size, 1.0f), std::fmax(extent.x, extent.y) / max_cells);
+		frame->cells_x 		= std::min(std::max((int)std::ceil(extent.x / frame->cell_size), 1), max_cells);
+		frame->cells_y 		= std::min(std::max((int)std::ceil(extent.y / frame->cell_size), 1), max_cells);
+
+		// Counting sort of pawns into cells, pawn is in every cell its box touches.
+		int cell_count = frame->cells_x * frame->cells_y;
+		frame->cell_start.assign(cell_count + 1, 0);
+
+		auto cell_range = [frame](const Box3 &box, int *x0, int *y0, int *x1, int *y1) {
+			*x0 = std::min(std::max((int)((box.min.x - frame->bounds.min.x) / frame->cell_size), 0), frame->cells_x - 1);
+			*y0 = std::min(std::max((int)((box.min.y - frame->bounds.min.y) / frame->cell_size), 0), frame->cells_y - 1);
+			*x1 = std::min(std::max((int)((box.max.x - frame->bounds.min.x) / frame->cell_size), 0), frame->cells_x - 1);
+			*y1 = std::min(std::max((int)((box.max.y - frame->bounds.min.y) / frame->cell_size), 0), frame->cells_y - 1);
+		};
+
+		for (int i = 0; i < count; ++i) {
+			int x0, y0, x1, y1;
+			cell_range(frame->swept[i], &x0, &y0, &x1, &y1);
+			for (int y = y0; y <= y1; ++y) {
+				for (int x = x0; x <= x1; ++x) {
+					++frame->cell_start[y * frame->cells_x + x + 1];
+				}
+			}
+		}
+		for (int i = 0; i < cell_count; ++i) {
+			frame->cell_start[i + 1] += frame->cell_start[i];
+		}
+
+		frame->cell_entities.resize(frame->cell_start[cell_count]);
+		std::vector<uint32_t> filled(frame->cell_start.begin(), frame->cell_start.end() - 1);
+		for (int i = 0; i < count; ++i) {
+			int x0, y0, x1, y1;
+			cell_range(frame->swept[i], &x0, &y0, &x1, &y1);
+			for (int y = y0; y <= y1; ++y) {
+				for (int x = x0; x <= x1; ++x) {
+					frame->cell_entities[filled[y * frame->cells_x + x]++] = (uint32_t)i;
+				}
+			}
+		}
+
+		frame->indexed = true;
+		++history->grids_built;
+	}
+
+	// Frame and how far we are to the next one. Too old time is the oldest step we have, future is the newest.
+	Lag_Frame *frame_at(Lag_History *history, double step_time, const Lag_Frame **out_next, float *out_alpha) {
+		if (history->frames.empty()) {
+			return nullptr;
+		}
+
+		uint64_t oldest = history->newest_step + 1 >= history->frames.size() ? history->newest_step + 1 - history->frames.size() : 0;
+		double clamped 	= std::min(std::max(step_time, (double)oldest), (double)history->newest_step);
+		uint64_t step 	= (uint64_t)clamped;
+
+		Lag_Frame *frame = find_frame(history, step);
+		if (!frame) {
+			return nullptr;
+		}
+
+		*out_next 	= find_frame(history, step + 1);
+		*out_alpha 	= *out_next ? (float)(clamped - (double)step) : 0.0f;
+		return frame;
+	}
+
+	Box3 entity_box(const Lag_Frame &frame, const Lag_Frame *next, int index, float alpha) {
+		const Lag_Entity &entity = frame.entities[index];
+		int next_index = index < (int)frame.next_index.size() ? frame.next_index[index] : -1;
+		if (!next || alpha <= 0 || next_index < 0) {
+			return box3_from_center(entity.center, entity.half_extents);
+		}
+
+		const Lag_Entity &moved = next->entities[next_index];
+		return box3_from_center(vec3_lerp(entity.center, moved.center, alpha), vec3_lerp(entity.half_extents, moved.half_extents, alpha));
+	}
+
+	bool test_entity(Lag_History *history, const Lag_Frame &frame, const Lag_Frame *next, int index, float alpha,
+		Vec3 from, Vec3 to, uint64_t ignore_id, Lag_Hit *best) {
+		if (frame.entities[index].id == ignore_id) {
+			return false;
+		}
+
+		++history->entity_tests;
+
+		float fraction;
+		if (!segment_hits_box3(from, to, entity_box(frame, next, index, alpha), &fraction) || fraction >= best->fraction) {
+			return false;
+		}
+
+		best->entity_id = frame.entities[index].id;
+		best->fraction 	= fraction;
+		best->point 	= vec3_lerp(from, to, fraction);
+		return true;
+	}
+}
+
+void lag_history_init(Lag_History *history, int steps) {
+	Lag_History empty;
+	empty.cell_size = history->cell_size;
+	empty.max_cells = history->max_cells;
+
+	*history = empty;
+	history->frames.assign(std::max(steps, 2), Lag_Frame());
+}
+
+void lag_history_add(Lag_History *history, uint64_t step, uint64_t id, Vec3 center, Vec3 half_extents) {
+	if (history->frames.empty()) {
+		lag_history_init(history, 64);
+	}
+
+	Lag_Frame &frame = history->frames[step % history->frames.size()];
+	if (frame.step != step) {
+		// Old step that was here is forgotten, we keep vectors.
+		frame.step 		= step;
+		frame.indexed 	= false;
+		frame.entities.clear();
+	}
+
+	Lag_Entity entity;
+	entity.id 			= id;
+	entity.center 		= center;
+	entity.half_extents = half_extents;
+	frame.entities.push_back(entity);
+	frame.indexed = false;
+
+	// Grid of step before reaches into this one.
+	if (step > 0) {
+		if (Lag_Frame *previous = find_frame(history, step - 1)) {
+			previous->indexed = false;
+		}
+	}
+
+	history->newest_step = std::max(history->newest_step, step);
+}
+
+bool lag_history_ray(Lag_History *history, double step_time, Vec3 from, Vec3 to, uint64_t ignore_id, Lag_Hit *out_hit) {
+	++history->queries;
+
+	const Lag_Frame *next;
+	float alpha;
+	Lag_Frame *frame = frame_at(history, step_time, &next, &alpha);
+	if (!frame || frame->entities.empty()) {
+		return false;
+	}
+
+	// Grid made before next step came in doesn't cover the move to it.
+	uint64_t next_step = next ? next->step : UINT64_MAX;
+	if (!frame->indexed || frame->next_step != next_step) {
+		build_grid(history, frame, next);
+	}
+
+	float enter, exit;
+	if (!segment_box_range(from, to, frame->bounds, &enter, &exit)) {
+		return false;
+	}
+
+	// Every pawn is tested once, even if the ray goes through many of its cells.
+	if (history->tested.size() < frame->entities.size()) {
+		history->tested.resize(frame->entities.size(), 0);
+	}
+	if (++history->query == 0) {
+		std::fill(history->tested.begin(), history->tested.end(), 0);
+		history->query = 1;
+	}
+
+	// Cells along the ray in order (Amanatides and Woo), in XY.
+	float cell_size = frame->cell_size;
+	Vec3  direction = to - from;
+	Vec3  start 	= from + direction * enter;
+
+	int x = std::min(std::max((int)((start.x - frame->bounds.min.x) / cell_size), 0), frame->cells_x - 1);
+	int y = std::min(std::max((int)((start.y - frame->bounds.min.y) / cell_size), 0), frame->cells_y - 1);
+
+	int 	step_x 		= direction.x > 0 ? 1 : -1;
+	int 	step_y 		= direction.y > 0 ? 1 : -1;
+	float 	next_x 		= INFINITY;
+	float 	next_y 		= INFINITY;
+	float 	delta_x 	= INFINITY;
+	float 	delta_y 	= INFINITY;
+	if (std::fabs(direction.x) > 1.e-8f) {
+		float boundary 	= frame->bounds.min.x + (x + (step_x > 0 ? 1 : 0)) * cell_size;
+		next_x 			= (boundary - from.x) / direction.x;
+		delta_x 		= cell_size / std::fabs(direction.x);
+	}
+	if (std::fabs(direction.y) > 1.e-8f) {
+		float boundary 	= frame->bounds.min.y + (y + (step_y > 0 ? 1 : 0)) * cell_size;
+		next_y 			= (boundary - from.y) / direction.y;
+		delta_y 		= cell_size / std::fabs(direction.y);
+	}
+
+	Lag_Hit best;
+	bool 	hit = false;
+	while (true) {
+		int cell = y * frame->cells_x + x;
+		for (uint32_t i = frame->cell_start[cell]; i < frame->cell_start[cell + 1]; ++i) {
+			uint32_t index = frame->cell_entities[i];
+			if (history->tested[index] == history->query) {
+				continue;
+			}
+			history->tested[index] = history->query;
+			hit |= test_entity(history, *frame, next, (int)index, alpha, from, to, ignore_id, &best);
+		}
+
+		// Hit before the ray leaves this cell can't be beaten by anything in cells after it.
+		float cell_exit = std::fmin(next_x, next_y);
+		if ((hit && best.fraction <= cell_exit) || cell_exit > exit) {
+			break;
+		}
+
+		if (next_x < next_y) {
+			x 		+= step_x;
+			next_x 	+= delta_x;
+		} else {
+			y 		+= step_y;
+			next_y 	+= delta_y;
+		}
+		if (x < 0 || y < 0 || x >= frame->cells_x || y >= frame->cells_y) {
+			break;
+		}
+	}
+
+	if (hit) {
+		*out_hit = best;
+	}
+	return hit;
+}
+
+bool lag_history_ray_brute_force(Lag_History *history, double step_time, Vec3 from, Vec3 to, uint64_t ignore_id, Lag_Hit *out_hit) {
+	++history->queries;
+
+	const Lag_Frame *next;
+	float alpha;
+	Lag_Frame *frame = frame_at(history, step_time, &next, &alpha);
+	if (!frame || frame->entities.empty()) {
+		return false;
+	}
+
+	// Grid isn't needed, but pawns of next step are found while it's made.
+	uint64_t next_step = next ? next->step : UINT64_MAX;
+	if (!frame->indexed || frame->next_step != next_step) {
+		build_grid(history, frame, next);
+	}
+
+	Lag_Hit best;
+	bool 	hit = false;
+	for (int i = 0; i < (int)frame->entities.size(); ++i) {
+		hit |= test_entity(history, *frame, next, i, alpha, from, to, ignore_id, &best);
+	}
+
+	if (hit) {
+		*out_hit = best;
+	}
+	return hit;
+}
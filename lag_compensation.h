@@ -0,0 +1,82 @@
+#pragma once
+
+// Lag compensation: where every pawn was on every fixed step, and rays against that, without moving anything back.
+//
+// 	lag_history_add(&lag_history, step, id, position, half_extents); 	// Every pawn, every step.
+// 	Lag_Hit hit;
+// 	if (lag_history_ray(&lag_history, shot_step_time, from, to, shooter_id, &hit)) { hit.entity_id was hit }
+//
+// Time is in steps: 120.25 is what client saw a quarter of the way from step 120 to 121 (fixed_step_alpha()),
+// so we hit what was drawn, not where pawns were at a whole step.
+//
+// Rewinding the scene for one shot is: move everybody back, trace, move everybody forward again. Here one shot
+// is one lookup in a small grid made over that step's pawns. Grid of a step is made the first time somebody
+// shoots into that step, steps nobody shoots into cost only the copy of positions.
+//
+// Grid is in XY, every cell lists pawns whose boxes (grown to cover the move to next step) touch it.
+// Ray walks cells in order and stops at the first cell that is behind the nearest hit so far.
+//
+// @note: Only pawn boxes are here, ray that went through a wall isn't stopped. Trace the world up to the hit too.
+
+#include "cd_math.h"
+
+#include <stdint.h>
+#include <vector>
+
+struct Lag_Entity {
+	uint64_t 	id = 0;
+	Vec3 		center;
+	Vec3 		half_extents;
+};
+
+struct Lag_Hit {
+	uint64_t 	entity_id 	= 0;
+	float 		fraction 	= 1.0f;
+	Vec3 		point;
+};
+
+struct Lag_Frame {
+	uint64_t 				step = UINT64_MAX;
+	std::vector<Lag_Entity> entities;
+
+	// Grid, made on first query.
+	bool 					indexed 	= false;
+	uint64_t 				next_step 	= UINT64_MAX; // Step the grid reaches to, pawns moved in between.
+	std::vector<int> 		next_index; 	// Same pawn in next step frame, -1 if it's not there.
+	std::vector<Box3> 		swept; 			// Box of every pawn from this step to the next.
+	Box3 					bounds;
+	float 					cell_size 	= 0;
+	int 					cells_x 	= 0;
+	int 					cells_y 	= 0;
+	std::vector<uint32_t> 	cell_start; 	// cells_x * cells_y + 1, cell i has cell_entities[cell_start[i]..cell_start[i + 1]).
+	std::vector<uint32_t> 	cell_entities;
+};
+
+struct Lag_History {
+	std::vector<Lag_Frame> 	frames; // Ring, step % frames.size().
+	uint64_t 				newest_step 	= 0;
+	float 					cell_size 		= 400.0f; 	// Few pawns per cell.
+	int 					max_cells 		= 128; 		// Per side, big spread gets bigger cells.
+
+	// Pawns that were already tested by this ray.
+	std::vector<uint32_t> 	tested;
+	uint32_t 				query 			= 0;
+
+	// Counters.
+	uint64_t queries 		= 0;
+	uint64_t entity_tests 	= 0;
+	uint64_t grids_built 	= 0;
+};
+
+// 64 steps is about one second at 60 Hz, clients with more lag than that shoot at the oldest step.
+void lag_history_init(Lag_History *history, int steps);
+
+void lag_history_add(Lag_History *history, uint64_t step, uint64_t id, Vec3 center, Vec3 half_extents);
+
+// Nearest pawn the ray hits at that time, ignoring ignore_id (the shooter).
+bool lag_history_ray(Lag_History *history, double step_time, Vec3 from, Vec3 to, uint64_t ignore_id, Lag_Hit *out_hit);
+
+// Same without the grid, every pawn is tested. For checks and benchmark.
+bool lag_history_ray_brute_force(Lag_History *history, double step_time, Vec3 from, Vec3 to, uint64_t ignore_id, Lag_Hit *out_hit);
+
+extern Lag_History lag_history;
@@ -0,0 +1,144 @@
+// Headless lag compensation test: pawns walk around an arena, every step goes into lag history, then shooters
+// with different latencies shoot rays at where pawns were when they saw them.
+//
+// Every ray goes through the grid and through the brute force test of all pawns, results must be the same.
+// Reports time per shot of both and how many pawns one shot tested.
+//
+// Build (no Unreal needed):
+// 	g++ -O2 -std=c++17 -I. lag_compensation_benchmark.cpp lag_compensation.cpp determinism.cpp -o lag_compensation_benchmark
+//
+// Usage:
+// 	lag_compensation_benchmark [--pawns N] [--steps N] [--shots N] [--max-latency ms] [--seed N]
+
+#include "determinism.h"
+#include "lag_compensation.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+	float step_dt 		= 1.0f / 60.0f;
+	float arena_size 	= 10000.0f; // Half, pawns are in -arena_size..arena_size.
+
+	struct Pawn {
+		uint64_t 	id;
+		Vec3 		position;
+		Vec3 		velocity;
+	};
+
+	float random_float(Random_Stream *random, float min, float max) {
+		return min + (max - min) * (float)(random_stream_next(random) % 1000000) / 1000000.0f;
+	}
+
+	struct Shot {
+		double 	step_time;
+		Vec3 	from;
+		Vec3 	to;
+		uint64_t shooter;
+	};
+}
+
+int main(int argument_count, char **arguments) {
+	int 		pawn_count 		= 200;
+	int 		steps 			= 600;
+	int 		shot_count 		= 100000;
+	float 		max_latency 	= 250; // Milliseconds.
+	uint64_t 	seed 			= 1;
+
+	for (int i = 1; i < argument_count; ++i) {
+		bool has_value = i + 1 < argument_count;
+
+		if (!strcmp(arguments[i], "--pawns") && has_value) {
+			pawn_count = atoi(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--steps") && has_value) {
+			steps = atoi(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--shots") && has_value) {
+			shot_count = atoi(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--max-latency") && has_value) {
+			max_latency = (float)atof(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--seed") && has_value) {
+			seed = strtoull(arguments[++i], nullptr, 10);
+		} else {
+			printf("Unknown argument: %s\n", arguments[i]);
+			return 1;
+		}
+	}
+
+	Random_Stream random = random_stream_make(seed, 1);
+	Vec3 half_extents(20, 20, 92); // Same as A_Player and A_Bot collision.
+
+	std::vector<Pawn> pawns(pawn_count);
+	for (int i = 0; i < pawn_count; ++i) {
+		pawns[i].id 		= (uint64_t)i + 1;
+		pawns[i].position 	= Vec3(random_float(&random, -arena_size, arena_size), random_float(&random, -arena_size, arena_size), 92);
+	}
+
+	lag_history_init(&lag_history, 64);
+
+	Random_Stream 		shot_random = random_stream_make(seed, 2);
+	std::vector<Shot> 	shots;
+	shots.reserve(shot_count);
+
+	int max_latency_steps = (int)(max_latency / 1000.0f / step_dt);
+	for (int step = 0; step < steps; ++step) {
+		for (Pawn &pawn : pawns) {
+			if (step % 30 == 0) {
+				float angle 	= random_float(&random, 0, 6.2831853f);
+				pawn.velocity 	= Vec3(std::cos(angle), std::sin(angle), 0) * 600.0f;
+			}
+			pawn.position += pawn.velocity * step_dt;
+			pawn.position.x = std::fmax(-arena_size, std::fmin(arena_size, pawn.position.x));
+			pawn.position.y = std::fmax(-arena_size, std::fmin(arena_size, pawn.position.y));
+			lag_history_add(&lag_history, (uint64_t)step, pawn.id, pawn.position, half_extents);
+		}
+	}
+
+	// Shooters aim near somebody, so many rays hit, from a few meters to across the arena.
+	for (int i = 0; i < shot_count; ++i) {
+		Shot shot;
+		shot.step_time 	= (steps - 1) - random_float(&shot_random, 0, (float)max_latency_steps);
+		const Pawn &shooter = pawns[random_stream_next(&shot_random) % pawn_count];
+		const Pawn &target 	= pawns[random_stream_next(&shot_random) % pawn_count];
+		shot.shooter 	= shooter.id;
+		shot.from 		= shooter.position + Vec3(0, 0, 70);
+		Vec3 aim 		= target.position + Vec3(random_float(&shot_random, -60, 60), random_float(&shot_random, -60, 60), random_float(&shot_random, -80, 80));
+		shot.to 		= shot.from + vec3_normalize(aim - shot.from) * 20000.0f;
+		shots.push_back(shot);
+	}
+
+	std::vector<Lag_Hit> 	grid_hits(shot_count);
+	std::vector<char> 		grid_hit(shot_count);
+	uint64_t tests_before = lag_history.entity_tests;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int i = 0; i < shot_count; ++i) {
+		grid_hit[i] = lag_history_ray(&lag_history, shots[i].step_time, shots[i].from, shots[i].to, shots[i].shooter, &grid_hits[i]);
+	}
+	double grid_milliseconds 	= std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	uint64_t grid_tests 		= lag_history.entity_tests - tests_before;
+
+	int mismatches 	= 0;
+	int hits 		= 0;
+	tests_before 	= lag_history.entity_tests;
+	start 			= std::chrono::steady_clock::now();
+	for (int i = 0; i < shot_count; ++i) {
+		Lag_Hit hit;
+		bool brute_force_hit = lag_history_ray_brute_force(&lag_history, shots[i].step_time, shots[i].from, shots[i].to, shots[i].shooter, &hit);
+		hits += brute_force_hit;
+		if (brute_force_hit != (bool)grid_hit[i] || (brute_force_hit && hit.entity_id != grid_hits[i].entity_id)) {
+			++mismatches;
+		}
+	}
+	double brute_force_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	uint64_t brute_force_tests 		= lag_history.entity_tests - tests_before;
+
+	printf("%d pawns, %d steps, %d shots up to %.0f ms back, %d hit somebody\n", pawn_count, steps, shot_count, max_latency, hits);
+	printf("grid:         %.3f us per shot, %.1f pawns tested, %llu grids made\n", grid_milliseconds * 1000.0 / shot_count, (double)grid_tests / shot_count, (unsigned long long)lag_history.grids_built);
+	printf("brute force:  %.3f us per shot, %.1f pawns tested\n", brute_force_milliseconds * 1000.0 / shot_count, (double)brute_force_tests / shot_count);
+	printf("mismatches:   %d\n", mismatches);
+
+	return mismatches ? 1 : 0;
+}
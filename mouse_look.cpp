@@ -0,0 +1,70 @@
+#include "mouse_look.h"
+
+namespace {
+	const float degrees_to_radians = 3.14159265358979f / 180.0f;
+
+	// Unreal pitch goes up around -Y.
+	const Vec3 yaw_axis(0.0f, 0.0f, 1.0f);
+	const Vec3 pitch_axis(0.0f, -1.0f, 0.0f);
+}
+
+void mouse_look_reset(Mouse_Look *look) {
+	look->yaw 			= Quat();
+	look->pitch 		= Quat();
+	look->latched_time 	= 0;
+	look->pending.clear();
+}
+
+void mouse_look_push(Mouse_Look *look, double time, float x, float y) {
+	if (x == 0 && y == 0) {
+		return;
+	}
+
+	Mouse_Delta delta;
+	delta.time 	= time;
+	delta.x 	= x;
+	delta.y 	= y;
+	look->pending.push_back(delta);
+}
+
+int mouse_look_latch(Mouse_Look *look, const Mouse_Look_Params &params) {
+	// Pitch quaternion is (0, -sin(a / 2), 0, cos(a / 2)), so clamping angle is clamping w.
+	float min_pitch_w = std::cos(params.max_pitch_degrees * degrees_to_radians * 0.5f);
+
+	int count = (int)look->pending.size();
+	for (const Mouse_Delta &delta : look->pending) {
+		if (delta.x != 0) {
+			look->yaw = quat_normalize(quat_from_axis_angle(yaw_axis, delta.x * params.degrees_per_unit_x * degrees_to_radians) * look->yaw);
+		}
+
+		// Pitch goes in turns of at most 90 degrees. From inside the range that can't get past straight back,
+		// where the quaternion would wrap and we would clamp to the wrong side.
+		float degrees 	= delta.y * params.degrees_per_unit_y;
+		float range 	= params.max_pitch_degrees * 2;
+		degrees 		= degrees > range ? range : degrees < -range ? -range : degrees;
+		while (degrees != 0) {
+			float turn 	= degrees > 90.0f ? 90.0f : degrees < -90.0f ? -90.0f : degrees;
+			degrees 	-= turn;
+
+			Quat pitch = quat_normalize(look->pitch * quat_from_axis_angle(pitch_axis, turn * degrees_to_radians));
+			if (pitch.w < min_pitch_w) {
+				float side 	= pitch.y < 0 ? -1.0f : 1.0f;
+				pitch 		= Quat(0.0f, side * std::sqrt(1.0f - min_pitch_w * min_pitch_w), 0.0f, min_pitch_w);
+			}
+			look->pitch = pitch;
+		}
+
+		look->latched_time = delta.time;
+	}
+
+	look->pending.clear();
+	return count;
+}
+
+Quat mouse_look_rotation(const Mouse_Look &look) {
+	return look.yaw * look.pitch;
+}
+
+Vec3 mouse_look_forward(const Mouse_Look &look) {
+	return quat_rotate(look.yaw, Vec3(1.0f, 0.0f, 0.0f));
+}
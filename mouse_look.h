@@ -0,0 +1,51 @@
+#pragma once
+
+// Mouse look: raw mouse deltas with the time they came, integrated straight into yaw and pitch quaternions.
+//
+// 	mouse_look_push(&look, FPlatformTime::Seconds(), x, y); 	// From input callbacks, as they come.
+// 	mouse_look_latch(&look, params); 							// Before movement, so we walk where we look.
+// 	mouse_look_latch(&look, params); 							// Again as late as we can, right before camera is used.
+// 	camera->SetRelativeRotation(to_fquat(mouse_look_rotation(look)));
+//
+// Delta is how far mouse went, not how fast, so it isn't multiplied by dt. It was before, and camera
+// turned twice as fast on 30 FPS as on 60.
+//
+// Pitch is clamped in quaternion space: pitch quaternion only ever turns around one axis,
+// so its w says how far we look up or down.
+
+#include "cd_math.h"
+
+#include <vector>
+
+struct Mouse_Delta {
+	double 	time 	= 0; // Seconds, when we got it.
+	float 	x 		= 0;
+	float 	y 		= 0;
+};
+
+struct Mouse_Look_Params {
+	float degrees_per_unit_x 	= 100.0f / 60.0f; // Same turn as old dt scaled look on 60 FPS.
+	float degrees_per_unit_y 	= 100.0f / 60.0f;
+	float max_pitch_degrees 	= 90.0f; // Up and down, straight up is the most.
+};
+
+struct Mouse_Look {
+	Quat yaw; 	// Around Z, collision turns with this.
+	Quat pitch; // Around left axis, only camera has it.
+
+	std::vector<Mouse_Delta> 	pending;
+	double 						latched_time = 0; // Time of the last delta in yaw and pitch.
+};
+
+void mouse_look_reset(Mouse_Look *look);
+
+void mouse_look_push(Mouse_Look *look, double time, float x, float y);
+
+// Integrates everything pushed since last latch. Returns how many deltas it took.
+int mouse_look_latch(Mouse_Look *look, const Mouse_Look_Params &params);
+
+// Yaw, then pitch, like FRotator with no roll.
+Quat mouse_look_rotation(const Mouse_Look &look);
+
+// Where yaw looks, flat.
+Vec3 mouse_look_forward(const Mouse_Look &look);
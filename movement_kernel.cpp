@@ -0,0 +1,158 @@
+#include "movement_kernel.h"
+
+#include <cmath>
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+	#include <emmintrin.h>
+	#define MOVEMENT_KERNEL_SSE
+#endif
+
+namespace {
+	// Same few operations for AVX, SSE and plain floats, so the kernel is written once.
+#if defined(__AVX__)
+	const int simd_width = 8;
+	typedef __m256 Simd_Float;
+	inline Simd_Float simd_load(const float *p) 				{ return _mm256_loadu_ps(p); }
+	inline Simd_Float simd_set(float f) 						{ return _mm256_set1_ps(f); }
+	inline Simd_Float simd_add(Simd_Float a, Simd_Float b) 		{ return _mm256_add_ps(a, b); }
+	inline Simd_Float simd_sub(Simd_Float a, Simd_Float b) 		{ return _mm256_sub_ps(a, b); }
+	inline Simd_Float simd_mul(Simd_Float a, Simd_Float b) 		{ return _mm256_mul_ps(a, b); }
+	inline Simd_Float simd_div(Simd_Float a, Simd_Float b) 		{ return _mm256_div_ps(a, b); }
+	inline Simd_Float simd_min(Simd_Float a, Simd_Float b) 		{ return _mm256_min_ps(a, b); }
+	inline Simd_Float simd_sqrt(Simd_Float a) 					{ return _mm256_sqrt_ps(a); }
+	inline Simd_Float simd_greater(Simd_Float a, Simd_Float b) 	{ return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	inline Simd_Float simd_select(Simd_Float mask, Simd_Float a, Simd_Float b) { return _mm256_blendv_ps(b, a, mask); }
+	inline void 	  simd_store(float *p, Simd_Float a) 		{ _mm256_storeu_ps(p, a); }
+#elif defined(MOVEMENT_KERNEL_SSE)
+	const int simd_width = 4;
+	typedef __m128 Simd_Float;
+	inline Simd_Float simd_load(const float *p) 				{ return _mm_loadu_ps(p); }
+	inline Simd_Float simd_set(float f) 						{ return _mm_set1_ps(f); }
+	inline Simd_Float simd_add(Simd_Float a, Simd_Float b) 		{ return _mm_add_ps(a, b); }
+	inline Simd_Float simd_sub(Simd_Float a, Simd_Float b) 		{ return _mm_sub_ps(a, b); }
+	inline Simd_Float simd_mul(Simd_Float a, Simd_Float b) 		{ return _mm_mul_ps(a, b); }
+	inline Simd_Float simd_div(Simd_Float a, Simd_Float b) 		{ return _mm_div_ps(a, b); }
+	inline Simd_Float simd_min(Simd_Float a, Simd_Float b) 		{ return _mm_min_ps(a, b); }
+	inline Simd_Float simd_sqrt(Simd_Float a) 					{ return _mm_sqrt_ps(a); }
+	inline Simd_Float simd_greater(Simd_Float a, Simd_Float b) 	{ return _mm_cmpgt_ps(a, b); }
+	inline Simd_Float simd_select(Simd_Float mask, Simd_Float a, Simd_Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	inline void 	  simd_store(float *p, Simd_Float a) 		{ _mm_storeu_ps(p, a); }
+#else
+	const int simd_width = 4;
+	struct Simd_Float { float v[simd_width]; };
+	inline Simd_Float simd_load(const float *p) 				{ Simd_Float r; for (int i = 0; i < simd_width; ++i) r.v[i] = p[i]; return r; }
+	inline Simd_Float simd_set(float f) 						{ Simd_Float r; for (int i = 0; i < simd_width; ++i) r.v[i] = f; return r; }
+	inline Simd_Float simd_add(Simd_Float a, Simd_Float b) 		{ for (int i = 0; i < simd_width; ++i) a.v[i] += b.v[i]; return a; }
+	inline Simd_Float simd_sub(Simd_Float a, Simd_Float b) 		{ for (int i = 0; i < simd_width; ++i) a.v[i] -= b.v[i]; return a; }
+	inline Simd_Float simd_mul(Simd_Float a, Simd_Float b) 		{ for (int i = 0; i < simd_width; ++i) a.v[i] *= b.v[i]; return a; }
+	inline Simd_Float simd_div(Simd_Float a, Simd_Float b) 		{ for (int i = 0; i < simd_width; ++i) a.v[i] /= b.v[i]; return a; }
+	inline Simd_Float simd_min(Simd_Float a, Simd_Float b) 		{ for (int i = 0; i < simd_width; ++i) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return a; }
+	inline Simd_Float simd_sqrt(Simd_Float a) 					{ for (int i = 0; i < simd_width; ++i) a.v[i] = std::sqrt(a.v[i]); return a; }
+	// Mask is 1 or 0 here, select only looks at it.
+	inline Simd_Float simd_greater(Simd_Float a, Simd_Float b) 	{ for (int i = 0; i < simd_width; ++i) a.v[i] = a.v[i] > b.v[i] ? 1.0f : 0.0f; return a; }
+	inline Simd_Float simd_select(Simd_Float mask, Simd_Float a, Simd_Float b) { for (int i = 0; i < simd_width; ++i) a.v[i] = mask.v[i] != 0 ? a.v[i] : b.v[i]; return a; }
+	inline void 	  simd_store(float *p, Simd_Float a) 		{ for (int i = 0; i < simd_width; ++i) p[i] = a.v[i]; }
+#endif
+
+	// Arrays are always whole SIMD widths long, so the kernel has no scalar tail. Extra slots are zeros.
+	void resize_batch(Movement_Batch *batch, int size) {
+		std::vector<float> *arrays[] = {
+			&batch->forward_x, &batch->forward_y, &batch->velocity_x, &batch->velocity_y,
+			&batch->input_x, &batch->input_y, &batch->input_speed, &batch->jump, &batch->dt,
+			&batch->impulse_x, &batch->impulse_y, &batch->impulse_z,
+		};
+		for (std::vector<float> *array : arrays) {
+			array->resize(size, 0.0f);
+		}
+	}
+}
+
+void movement_batch_clear(Movement_Batch *batch) {
+	batch->count = 0;
+}
+
+int movement_batch_add(Movement_Batch *batch, const Movement_Params &params, float forward_x, float forward_y, float velocity_x, float velocity_y, uint32_t buttons, float dt) {
+	int slot = batch->count++;
+	if ((int)batch->dt.size() < batch->count) {
+		resize_batch(batch, (batch->count + simd_width - 1) / simd_width * simd_width);
+	}
+
+	float input_x = 0, input_y = 0, input_speed = 0;
+
+	// @note: Right now I do not use gamepad stick XY inputs.
+	if (buttons & MOVEMENT_FORWARD) {
+		input_y 	+= 1;
+		input_speed += params.forward_force;
+	}
+	if (buttons & MOVEMENT_BACKWARD) {
+		input_y 	-= 1;
+		input_speed += params.backward_force;
+	}
+	if (buttons & MOVEMENT_RIGHT) {
+		input_x 	+= 1;
+		input_speed += params.right_force;
+	}
+	if (buttons & MOVEMENT_LEFT) {
+		input_x 	-= 1;
+		input_speed += params.left_force;
+	}
+
+	batch->forward_x[slot] 		= forward_x;
+	batch->forward_y[slot] 		= forward_y;
+	batch->velocity_x[slot] 	= velocity_x;
+	batch->velocity_y[slot] 	= velocity_y;
+	batch->input_x[slot] 		= input_x;
+	batch->input_y[slot] 		= input_y;
+	batch->input_speed[slot] 	= input_speed;
+	batch->jump[slot] 			= (buttons & MOVEMENT_JUMP) ? 1.0f : 0.0f;
+	batch->dt[slot] 			= dt;
+
+	return slot;
+}
+
+void movement_batch_run(const Movement_Params &params, Movement_Batch *batch) {
+	Simd_Float zero 				= simd_set(0.0f);
+	Simd_Float one 					= simd_set(1.0f);
+	Simd_Float max_walking_speed 	= simd_set(params.max_walking_speed);
+	Simd_Float drag_walking 		= simd_set(params.drag_walking_force);
+	Simd_Float drag_stop_walking 	= simd_set(params.drag_stop_walking_force);
+	Simd_Float jump_force 			= simd_set(params.jump_force);
+	Simd_Float gravity_extra_force 	= simd_set(params.gravity_extra_force);
+
+	for (int i = 0; i < batch->count; i += simd_width) {
+		Simd_Float input_x 		= simd_load(&batch->input_x[i]);
+		Simd_Float input_y 		= simd_load(&batch->input_y[i]);
+		Simd_Float input_speed 	= simd_load(&batch->input_speed[i]);
+		Simd_Float forward_x 	= simd_load(&batch->forward_x[i]);
+		Simd_Float forward_y 	= simd_load(&batch->forward_y[i]);
+		Simd_Float dt 			= simd_load(&batch->dt[i]);
+
+		// Normalize walking vector to fit into unit circle. Opposite buttons cancel out, then we don't push at all.
+		Simd_Float length_squared 	= simd_add(simd_mul(input_x, input_x), simd_mul(input_y, input_y));
+		Simd_Float has_direction 	= simd_greater(length_squared, zero);
+		Simd_Float inverse_length 	= simd_select(has_direction, simd_div(one, simd_sqrt(simd_select(has_direction, length_squared, one))), zero);
+		input_x = simd_mul(input_x, inverse_length);
+		input_y = simd_mul(input_y, inverse_length);
+
+		// Input y goes along collision forward, input x along collision right, which is forward turned by 90 degrees: (-y, x).
+		Simd_Float direction_x = simd_sub(simd_mul(forward_x, input_y), simd_mul(forward_y, input_x));
+		Simd_Float direction_y = simd_add(simd_mul(forward_y, input_y), simd_mul(forward_x, input_x));
+
+		// If we got several directions - clamp speed.
+		Simd_Float speed = simd_min(input_speed, max_walking_speed);
+
+		// We are clamping walking velocity through drag, if we are not walking drag is stronger.
+		// @todo: This drag will also try to stop you in air, I need moving states for this one.
+		Simd_Float drag = simd_select(simd_greater(input_speed, zero), drag_walking, drag_stop_walking);
+
+		Simd_Float impulse_x = simd_sub(simd_mul(direction_x, speed), simd_mul(simd_load(&batch->velocity_x[i]), drag));
+		Simd_Float impulse_y = simd_sub(simd_mul(direction_y, speed), simd_mul(simd_load(&batch->velocity_y[i]), drag));
+		Simd_Float impulse_z = simd_sub(simd_mul(simd_load(&batch->jump[i]), jump_force), gravity_extra_force);
+
+		simd_store(&batch->impulse_x[i], simd_mul(impulse_x, dt));
+		simd_store(&batch->impulse_y[i], simd_mul(impulse_y, dt));
+		simd_store(&batch->impulse_z[i], simd_mul(impulse_z, dt));
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+// Walking model of player and bots, without the engine: buttons, collision yaw and velocity in,
+// one velocity change (impulse with mass_has_no_effect) per pawn out.
+//
+// 	movement_batch_clear(&batch);
+// 	int slot = movement_batch_add(&batch, forward_x, forward_y, velocity_x, velocity_y, buttons, dt);
+// 	...every pawn...
+// 	movement_batch_run(params, &batch);
+// 	...every pawn: AddImpulse(impulse of its slot)...
+//
+// It used to be two copies of the same code in move_player() and move_bot(): two acos, sincos and angle
+// wrapping to turn input vector by collision yaw, and four AddImpulse calls. Turning a vector by yaw is just
+// input.y * forward + input.x * right, and right is forward turned by 90 degrees, so there is no trig at all.
+// Pawns are kept in SoA arrays and run 4 (8 with AVX) at a time.
+//
+// Input is on the top-down unit circle like before: forward is (0, 1), right is (1, 0).
+// @note: Forward is the pawn's yaw only, a unit vector in XY. Mouse-look pitch turns the camera and never gets here,
+// so walking stays flat whatever we look at, and jump and extra gravity are always along world Z.
+
+#include <stdint.h>
+#include <vector>
+
+enum Movement_Button : uint32_t {
+	MOVEMENT_FORWARD 	= 1 << 0,
+	MOVEMENT_BACKWARD 	= 1 << 1,
+	MOVEMENT_RIGHT 		= 1 << 2,
+	MOVEMENT_LEFT 		= 1 << 3,
+	MOVEMENT_JUMP 		= 1 << 4,
+
+	MOVEMENT_WALK 		= MOVEMENT_FORWARD | MOVEMENT_BACKWARD | MOVEMENT_RIGHT | MOVEMENT_LEFT,
+};
+
+struct Movement_Params {
+	float max_walking_speed 		= 2400.0f;
+	float forward_force 			= 2400.0f;
+	float backward_force 			= 2400.0f;
+	float right_force 				= 2400.0f;
+	float left_force 				= 2400.0f;
+	float jump_force 				= 3700.0f;
+	float gravity_extra_force 		= 1077.0f;
+	float drag_walking_force 		= 1.3f; // Drag walking should be less than stopping.
+	float drag_stop_walking_force 	= 3.2f;
+};
+
+// One slot per pawn, every array is count long.
+struct Movement_Batch {
+	int count = 0;
+
+	// In.
+	std::vector<float> forward_x; 	// Collision forward vector, XY of it.
+	std::vector<float> forward_y;
+	std::vector<float> velocity_x; 	// Current velocity, only XY is dragged.
+	std::vector<float> velocity_y;
+	std::vector<float> input_x; 	// Sum of pressed button vectors, not normalized.
+	std::vector<float> input_y;
+	std::vector<float> input_speed; // Sum of pressed button forces, zero means not walking.
+	std::vector<float> jump; 		// 1 if jump is pressed.
+	std::vector<float> dt;
+
+	// Out.
+	std::vector<float> impulse_x;
+	std::vector<float> impulse_y;
+	std::vector<float> impulse_z;
+};
+
+void movement_batch_clear(Movement_Batch *batch);
+
+// Returns slot of this pawn.
+int movement_batch_add(Movement_Batch *batch, const Movement_Params &params, float forward_x, float forward_y, float velocity_x, float velocity_y, uint32_t buttons, float dt);
+
+// Fills impulses of every slot.
+void movement_batch_run(const Movement_Params &params, Movement_Batch *batch);
@@ -0,0 +1,118 @@
+#include "nav_change_log.h"
+
+namespace {
+	uint32_t oldest_available_revision(const Nav_Change_Log &log) {
+		if (log.revision < log.capacity) {
+			return 1;
+		}
+		return log.revision - log.capacity + 1;
+	}
+
+	bool box_moved(Box3 a, Box3 b, float threshold) {
+		Vec3 min_difference = a.min - b.min;
+		Vec3 max_difference = a.max - b.max;
+		return vec3_length(min_difference) > threshold || vec3_length(max_difference) > threshold;
+	}
+}
+
+void nav_change_log_push(Nav_Change_Log *log, Box3 box) {
+	if (log->regions.size() != log->capacity) {
+		log->regions.resize(log->capacity);
+	}
+
+	++log->revision;
+
+	Nav_Dirty_Region &region = log->regions[(log->revision - 1) % log->capacity];
+	region.box 		= box;
+	region.revision = log->revision;
+}
+
+bool nav_change_log_collect(const Nav_Change_Log &log, uint32_t since_revision, std::vector<Box3> *out_boxes) {
+	out_boxes->clear();
+
+	if (since_revision >= log.revision) {
+		return true;
+	}
+
+	uint32_t first = since_revision + 1;
+	bool 	 complete = true;
+	if (first < oldest_available_revision(log)) {
+		first 		= oldest_available_revision(log);
+		complete 	= false;
+	}
+
+	for (uint32_t revision = first; revision <= log.revision; ++revision) {
+		out_boxes->push_back(log.regions[(revision - 1) % log.capacity].box);
+	}
+
+	return complete;
+}
+
+bool nav_change_log_crosses_path(const Nav_Change_Log &log, uint32_t since_revision, const Vec3 *points, size_t point_count, Vec3 agent_half_extents) {
+	if (since_revision >= log.revision) {
+		return false;
+	}
+
+	if (since_revision + 1 < oldest_available_revision(log)) {
+		return true;
+	}
+
+	for (uint32_t revision = since_revision + 1; revision <= log.revision; ++revision) {
+		// Sweeping agent box along segment is the same as a ray against region grown by agent box.
+		Box3 region = box3_expand(log.regions[(revision - 1) % log.capacity].box, agent_half_extents);
+
+		for (size_t i = 0; i + 1 < point_count; ++i) {
+			if (segment_hits_box3(points[i], points[i + 1], region)) {
+				return true;
+			}
+		}
+
+		if (point_count == 1 && box3_contains(region, points[0])) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void nav_obstacle_tracker_update(Nav_Obstacle_Tracker *tracker, Nav_Change_Log *log, uint64_t id, Box3 box) {
+	for (Nav_Tracked_Obstacle &obstacle : tracker->obstacles) {
+		if (obstacle.id != id) {
+			continue;
+		}
+
+		if (box_moved(obstacle.box, box, tracker->move_threshold)) {
+			// Both where it was and where it is now are dirty: old place is free, new place is blocked.
+			nav_change_log_push(log, box3_union(obstacle.box, box));
+			obstacle.box = box;
+		}
+		return;
+	}
+
+	// New obstacle appeared.
+	Nav_Tracked_Obstacle obstacle;
+	obstacle.id 	= id;
+	obstacle.box 	= box;
+	tracker->obstacles.push_back(obstacle);
+	nav_change_log_push(log, box);
+}
+
+void nav_obstacle_tracker_remove(Nav_Obstacle_Tracker *tracker, Nav_Change_Log *log, uint64_t id) {
+	for (size_t i = 0; i < tracker->obstacles.size(); ++i) {
+		if (tracker->obstacles[i].id == id) {
+			nav_change_log_push(log, tracker->obstacles[i].box);
+			tracker->obstacles[i] = tracker->obstacles.back();
+			tracker->obstacles.pop_back();
+			return;
+		}
+	}
+}
+
+void nav_obstacle_tracker_query(const Nav_Obstacle_Tracker &tracker, Box3 region, std::vector<Box3> *out_boxes) {
+	out_boxes->clear();
+	for (const Nav_Tracked_Obstacle &obstacle : tracker.obstacles) {
+		if (box3_overlaps(obstacle.box, region)) {
+			out_boxes->push_back(obstacle.box);
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// Change log of dirty regions for dynamic obstacles (doors, crates, anything that moves).
+// Every time tracked collision moves, the box it left and the box it moved to are pushed to the log
+// with a new revision number. Whoever caches something about the level (bot paths, navigation layers)
+// remembers revision it was made at and later checks only regions newer than that.
+
+#include "cd_math.h"
+
+#include <stdint.h>
+#include <vector>
+
+struct Nav_Dirty_Region {
+	Box3 		box;
+	uint32_t 	revision = 0;
+};
+
+// Ring buffer, if somebody didn't look at the log for too long, old regions are gone
+// and we tell them that everything is dirty.
+struct Nav_Change_Log {
+	std::vector<Nav_Dirty_Region> 	regions;
+	uint32_t 						capacity = 256;
+	uint32_t 						revision = 0; // Revision of the last pushed region, zero means nothing changed yet.
+};
+
+void nav_change_log_push(Nav_Change_Log *log, Box3 box);
+
+// Regions newer than since_revision. Returns false if some of them were already overwritten.
+bool nav_change_log_collect(const Nav_Change_Log &log, uint32_t since_revision, std::vector<Box3> *out_boxes);
+
+// True if some region newer than since_revision crosses the path (agent box swept along the segments),
+// or if the log can't tell anymore.
+bool nav_change_log_crosses_path(const Nav_Change_Log &log, uint32_t since_revision, const Vec3 *points, size_t point_count, Vec3 agent_half_extents);
+
+// Keeps last known box of every moving obstacle and pushes dirty regions when they move.
+struct Nav_Tracked_Obstacle {
+	uint64_t 	id = 0;
+	Box3 		box;
+};
+
+struct Nav_Obstacle_Tracker {
+	std::vector<Nav_Tracked_Obstacle> 	obstacles;
+	float 								move_threshold = 5.0f; // Smaller moves are not worth replanning.
+};
+
+void nav_obstacle_tracker_update(Nav_Obstacle_Tracker *tracker, Nav_Change_Log *log, uint64_t id, Box3 box);
+void nav_obstacle_tracker_remove(Nav_Obstacle_Tracker *tracker, Nav_Change_Log *log, uint64_t id);
+
+// Current boxes of all obstacles overlapping region.
+void nav_obstacle_tracker_query(const Nav_Obstacle_Tracker &tracker, Box3 region, std::vector<Box3> *out_boxes);
@@ -0,0 +1,249 @@
+#include "nav_jump_links.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace {
+	float 	arc_skin 				= 5.0f; // Arc rays go a bit above feet and below head, so they don't hit floor we stand on.
+	int 	direction_sectors 		= 8; 	// We keep one jump per direction sector for every take off surface.
+	int 	links_per_full_surface 	= 8; 	// Surface with all 8 neighbours is not at the edge of anything.
+
+	struct Open_Node {
+		float 		cost;
+		uint32_t 	surface;
+		bool operator<(const Open_Node &other) const { return cost > other.cost; } // Min heap.
+	};
+
+	// Walking distances from source surface, but only up to max_cost. We reuse arrays between sources.
+	struct Walk_Distances {
+		std::vector<float> 		cost;
+		std::vector<uint32_t> 	touched;
+	};
+
+	void find_walk_distances(const Nav_Layer_Grid &grid, uint32_t source, float max_cost, Walk_Distances *distances) {
+		for (uint32_t surface : distances->touched) {
+			distances->cost[surface] = -1.0f;
+		}
+		distances->touched.clear();
+
+		std::priority_queue<Open_Node> open;
+		distances->cost[source] = 0.0f;
+		distances->touched.push_back(source);
+		open.push(Open_Node{0.0f, source});
+
+		while (!open.empty()) {
+			Open_Node current = open.top();
+			open.pop();
+
+			if (current.cost > distances->cost[current.surface]) {
+				continue;
+			}
+
+			const Nav_Surface &surface = grid.surfaces[current.surface];
+			for (uint32_t l = 0; l < surface.link_count; ++l) {
+				const Nav_Link &link = grid.links[surface.first_link + l];
+				if (link.type == NAV_LINK_JUMP) {
+					continue;
+				}
+
+				float new_cost = current.cost + link.cost;
+				if (new_cost > max_cost) {
+					continue;
+				}
+
+				float &old_cost = distances->cost[link.to];
+				if (old_cost < 0.0f || new_cost < old_cost) {
+					if (old_cost < 0.0f) {
+						distances->touched.push_back(link.to);
+					}
+					old_cost = new_cost;
+					open.push(Open_Node{new_cost, link.to});
+				}
+			}
+		}
+	}
+
+	// Traces the arc as a polyline twice: near the feet and near the head.
+	bool arc_is_clear(const Nav_Layer_Grid &grid, const Collision_Query &collision, const Nav_Jump_Params &params, Vec3 take_off, Vec3 direction, float hold_time, float flight_time) {
+		float line_heights[2] = {arc_skin, grid.agent.height - arc_skin};
+
+		for (float line_height : line_heights) {
+			Vec3 last_point = take_off + Vec3(0, 0, line_height);
+
+			for (int i = 1; i <= params.arc_segments; ++i) {
+				float distance;
+				float height;
+				nav_jump_arc_point(params, hold_time, flight_time * i / params.arc_segments, &distance, &height);
+
+				Vec3 point = take_off + direction * distance + Vec3(0, 0, height + line_height);
+
+				Collision_Hit hit;
+				if (collision.ray(last_point, point, &hit)) {
+					return false;
+				}
+				last_point = point;
+			}
+		}
+
+		return true;
+	}
+}
+
+void nav_jump_arc_point(const Nav_Jump_Params &params, float hold_time, float time, float *out_distance, float *out_height) {
+	// Walking from standstill with linear drag: v(t) = v_max * (1 - e^(-drag * t)).
+	float drag 				= params.walk_drag;
+	float max_speed 		= params.walk_acceleration / drag;
+	*out_distance 			= max_speed * (time - (1.0f - std::exp(-drag * time)) / drag);
+
+	// Jump is held, then only gravity.
+	float rise_acceleration = params.jump_acceleration - params.gravity;
+	if (rise_acceleration < 0.0f) {
+		rise_acceleration = 0.0f;
+	}
+
+	float held_time = std::fmin(time, hold_time);
+	float height 	= rise_acceleration * held_time * held_time * 0.5f;
+	if (time > hold_time) {
+		float rise_speed 	= rise_acceleration * hold_time;
+		float fall_time 	= time - hold_time;
+		height += rise_speed * fall_time - params.gravity * fall_time * fall_time * 0.5f;
+	}
+	*out_height = height;
+}
+
+bool nav_jump_solve(const Nav_Jump_Params &params, float distance, float height, float *out_hold_time, float *out_flight_time) {
+	float rise_acceleration = std::fmax(params.jump_acceleration - params.gravity, 0.0f);
+
+	for (float hold_time = 0.0f; hold_time <= params.max_hold_time + 0.0001f; hold_time += params.hold_time_step) {
+		float release_height 	= rise_acceleration * hold_time * hold_time * 0.5f;
+		float release_speed 	= rise_acceleration * hold_time;
+		float apex 				= release_height + release_speed * release_speed / (2.0f * params.gravity);
+
+		// Can't get this high, hold longer.
+		if (apex < height) {
+			continue;
+		}
+
+		// We land on the way down.
+		float fall_time 	= (release_speed + std::sqrt(release_speed * release_speed + 2.0f * params.gravity * (release_height - height))) / params.gravity;
+		float flight_time 	= hold_time + fall_time;
+
+		float flight_distance;
+		float flight_height;
+		nav_jump_arc_point(params, hold_time, flight_time, &flight_distance, &flight_height);
+
+		// Longer hold only means longer flight, so if we already overshoot - give up.
+		if (flight_distance > distance + params.max_overshoot) {
+			return false;
+		}
+
+		if (flight_distance >= distance) {
+			*out_hold_time 		= hold_time;
+			*out_flight_time 	= flight_time;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int nav_jump_links_build(Nav_Layer_Grid *grid, const Collision_Query &collision, const Nav_Jump_Params &params) {
+	if (!grid->built) {
+		return 0;
+	}
+
+	int32_t radius_in_cells = (int32_t)std::ceil(params.max_distance / grid->cell_size);
+	float 	max_walk_cost 	= params.max_distance * params.detour_factor;
+
+	Walk_Distances distances;
+	distances.cost.assign(grid->surfaces.size(), -1.0f);
+
+	struct Candidate {
+		bool 		valid 		= false;
+		float 		distance 	= 0.0f;
+		Nav_Edge 	edge;
+	};
+	std::vector<Candidate> 	best_in_sector(direction_sectors);
+	std::vector<Nav_Edge> 	jump_edges;
+
+	for (uint32_t source = 0; source < grid->surfaces.size(); ++source) {
+		const Nav_Surface &source_surface = grid->surfaces[source];
+
+		// Jumps start only from the edge of something: ledge, gap or obstacle in front.
+		if (source_surface.link_count >= (uint32_t)links_per_full_surface) {
+			continue;
+		}
+
+		find_walk_distances(*grid, source, max_walk_cost, &distances);
+		std::fill(best_in_sector.begin(), best_in_sector.end(), Candidate());
+
+		Vec3 	take_off 	= nav_layers_surface_point(*grid, source);
+		int32_t source_x 	= source_surface.cell % grid->size_x;
+		int32_t source_y 	= source_surface.cell / grid->size_x;
+
+		for (int32_t cell_y = source_y - radius_in_cells; cell_y <= source_y + radius_in_cells; ++cell_y) {
+			for (int32_t cell_x = source_x - radius_in_cells; cell_x <= source_x + radius_in_cells; ++cell_x) {
+				if (cell_x < 0 || cell_y < 0 || cell_x >= grid->size_x || cell_y >= grid->size_y) {
+					continue;
+				}
+
+				int32_t cell = cell_y * grid->size_x + cell_x;
+				for (uint32_t target = grid->cell_first_surface[cell]; target < grid->cell_first_surface[cell + 1]; ++target) {
+					const Nav_Surface &target_surface = grid->surfaces[target];
+					if (target == source || target_surface.link_count >= (uint32_t)links_per_full_surface) {
+						continue;
+					}
+
+					Vec3 	landing 	= nav_layers_surface_point(*grid, target);
+					float 	distance 	= vec3_distance_2d(take_off, landing);
+					float 	height 		= landing.z - take_off.z;
+					if (distance > params.max_distance || distance < grid->cell_size * 1.5f || height < -params.max_drop_height) {
+						continue;
+					}
+
+					// If we can walk there without a big detour, we don't need to jump.
+					float walk_cost = distances.cost[target];
+					if (walk_cost >= 0.0f && walk_cost <= distance * params.detour_factor) {
+						continue;
+					}
+
+					// Keep only the nearest landing in every direction.
+					Vec3 	direction 	= vec3_normalize_2d(landing - take_off);
+					float 	angle 		= std::atan2(direction.y, direction.x) + 3.14159265f;
+					int 	sector 		= std::min(direction_sectors - 1, (int)(angle / (6.2831853f / direction_sectors)));
+					Candidate &best = best_in_sector[sector];
+					if (best.valid && best.distance <= distance) {
+						continue;
+					}
+
+					float hold_time;
+					float flight_time;
+					if (!nav_jump_solve(params, distance, height, &hold_time, &flight_time)) {
+						continue;
+					}
+
+					if (!arc_is_clear(*grid, collision, params, take_off, direction, hold_time, flight_time)) {
+						continue;
+					}
+
+					best.valid 						= true;
+					best.distance 					= distance;
+					best.edge.from 					= source;
+					best.edge.link.to 				= target;
+					best.edge.link.type 			= NAV_LINK_JUMP;
+					best.edge.link.jump_hold_time 	= hold_time;
+					best.edge.link.cost 			= vec3_distance(take_off, landing) + params.cost_penalty;
+				}
+			}
+		}
+
+		for (const Candidate &candidate : best_in_sector) {
+			if (candidate.valid) {
+				jump_edges.push_back(candidate.edge);
+			}
+		}
+	}
+
+	nav_layers_add_links(grid, jump_edges);
+	return (int)jump_edges.size();
+}
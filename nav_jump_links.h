@@ -0,0 +1,36 @@
+#pragma once
+
+// Jump links for layered navigation.
+// We bake reachable jump arcs once, on level load, and add them to the grid as extra links,
+// so planner can use jumps (over gaps, onto low obstacles, down from ledges) without simulating anything at runtime.
+//
+// Arc model is the same thing that move_bot() does every frame:
+// 	- walking is impulse with drag, and bot starts from standstill, because it stops at path points to rotate;
+// 	- while jump is held, jump impulse works against gravity;
+// 	- after jump is released, only gravity (world gravity plus our extra gravity force).
+
+#include "nav_layers.h"
+
+struct Nav_Jump_Params {
+	float walk_acceleration 	= 2400.0f; 	// forward_force, clamped by max_walking_speed.
+	float walk_drag 			= 1.3f; 	// drag_walking_force.
+	float jump_acceleration 	= 3700.0f; 	// jump_force.
+	float gravity 				= 2057.0f; 	// World gravity plus gravity_extra_force, positive number.
+	float max_hold_time 		= 0.3f; 	// Longest time bot is allowed to hold jump.
+	float hold_time_step 		= 0.02f;
+	float max_drop_height 		= 400.0f;
+	float max_distance 			= 600.0f; 	// Horizontal search radius around take off point.
+	float max_overshoot 		= 150.0f; 	// We can't stop in the air, so landing can be a bit further than target.
+	float detour_factor 		= 2.0f; 	// Jump only if walking around is this many times longer.
+	float cost_penalty 			= 150.0f; 	// Extra cost, so walking is preferred when it's not much longer.
+	int   arc_segments 			= 8; 		// Rays per arc line when we check that arc is clear.
+};
+
+// Horizontal distance and height (relative to take off) after time, if jump was held for hold_time.
+void nav_jump_arc_point(const Nav_Jump_Params &params, float hold_time, float time, float *out_distance, float *out_height);
+
+// Finds shortest hold time that lands on height at horizontal distance. Returns false if we can't get there.
+bool nav_jump_solve(const Nav_Jump_Params &params, float distance, float height, float *out_hold_time, float *out_flight_time);
+
+// Adds NAV_LINK_JUMP links to the built grid. Returns number of added links.
+int nav_jump_links_build(Nav_Layer_Grid *grid, const Collision_Query &collision, const Nav_Jump_Params &params);
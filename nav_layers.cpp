@@ -0,0 +1,447 @@
+#include "nav_layers.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace {
+	// How far we move ray start below surface to search for next surface in the same cell.
+	float 	surface_skin 				= 1.0f;
+	int 	max_surfaces_per_cell 		= 16;
+	int 	max_probes_per_cell 		= 48;
+
+	int32_t cell_index(const Nav_Layer_Grid &grid, int32_t x, int32_t y) {
+		return y * grid.size_x + x;
+	}
+
+	Vec3 cell_center(const Nav_Layer_Grid &grid, int32_t x, int32_t y) {
+		return Vec3(grid.origin.x + (x + 0.5f) * grid.cell_size, grid.origin.y + (y + 0.5f) * grid.cell_size, 0.0f);
+	}
+
+	// Casts down through the whole cell column and collects walkable surfaces from top to bottom.
+	void probe_cell_column(const Nav_Layer_Grid &grid, const Collision_Query &collision, Vec3 center, std::vector<Nav_Surface> *out_surfaces) {
+		out_surfaces->clear();
+
+		float from_z = grid.z_max;
+		for (int probe_count = 0; probe_count < max_probes_per_cell && from_z > grid.z_min; ++probe_count) {
+			Collision_Hit hit;
+			if (!collision.ray(Vec3(center.x, center.y, from_z), Vec3(center.x, center.y, grid.z_min), &hit)) {
+				break;
+			}
+			Vec3 hit_point 	= hit.point;
+			Vec3 hit_normal = hit.normal;
+
+			// Ray started inside geometry (thick floor or wall). Move down and try again.
+			if (hit_point.z >= from_z - 0.01f) {
+				from_z -= grid.agent.max_step_height;
+				continue;
+			}
+
+			if (hit_normal.z >= grid.agent.max_slope_cos) {
+				// Look up to find how much space we have above the floor.
+				Collision_Hit 	ceiling_hit;
+				float 			ceiling = grid.z_max;
+				if (collision.ray(Vec3(center.x, center.y, hit_point.z + surface_skin), Vec3(center.x, center.y, grid.z_max), &ceiling_hit)) {
+					ceiling = ceiling_hit.point.z;
+				}
+
+				if (ceiling - hit_point.z >= grid.agent.height) {
+					Nav_Surface surface;
+					surface.z 		= hit_point.z;
+					surface.ceiling = ceiling;
+					out_surfaces->push_back(surface);
+
+					if ((int)out_surfaces->size() >= max_surfaces_per_cell) {
+						break;
+					}
+				}
+			}
+
+			from_z = hit_point.z - surface_skin;
+		}
+
+		// We probed from top to bottom, but grid keeps surfaces from bottom to top.
+		std::reverse(out_surfaces->begin(), out_surfaces->end());
+	}
+
+	int32_t find_walkable_neighbour(const Nav_Layer_Grid &grid, const Nav_Surface &surface, int32_t neighbour_cell) {
+		int32_t best 		= -1;
+		float 	best_height = grid.agent.max_step_height;
+
+		for (uint32_t i = grid.cell_first_surface[neighbour_cell]; i < grid.cell_first_surface[neighbour_cell + 1]; ++i) {
+			const Nav_Surface &neighbour = grid.surfaces[i];
+
+			float height_difference = std::fabs(neighbour.z - surface.z);
+			if (height_difference > best_height) {
+				continue;
+			}
+
+			// Both cells need enough space above the higher floor.
+			float floor 	= std::fmax(surface.z, neighbour.z);
+			float ceiling 	= std::fmin(surface.ceiling, neighbour.ceiling);
+			if (ceiling - floor < grid.agent.height) {
+				continue;
+			}
+
+			best 		= (int32_t)i;
+			best_height = height_difference;
+		}
+
+		return best;
+	}
+
+	void rebuild_link_table(Nav_Layer_Grid *grid, std::vector<Nav_Edge> &edges) {
+		std::stable_sort(edges.begin(), edges.end(), [](const Nav_Edge &a, const Nav_Edge &b) { return a.from < b.from; });
+
+		grid->links.clear();
+		grid->links.reserve(edges.size());
+
+		for (Nav_Surface &surface : grid->surfaces) {
+			surface.link_count = 0;
+		}
+
+		for (const Nav_Edge &edge : edges) {
+			Nav_Surface &surface = grid->surfaces[edge.from];
+			if (surface.link_count == 0) {
+				surface.first_link = (uint32_t)grid->links.size();
+			}
+			++surface.link_count;
+			grid->links.push_back(edge.link);
+		}
+	}
+
+	void collect_edges(const Nav_Layer_Grid &grid, std::vector<Nav_Edge> *out_edges) {
+		out_edges->clear();
+		out_edges->reserve(grid.links.size());
+
+		for (uint32_t i = 0; i < grid.surfaces.size(); ++i) {
+			const Nav_Surface &surface = grid.surfaces[i];
+			for (uint32_t l = 0; l < surface.link_count; ++l) {
+				Nav_Edge edge;
+				edge.from = i;
+				edge.link = grid.links[surface.first_link + l];
+				out_edges->push_back(edge);
+			}
+		}
+	}
+
+	struct Open_Node {
+		float 		f;
+		uint32_t 	surface;
+		bool operator<(const Open_Node &other) const { return f > other.f; } // Min heap.
+	};
+}
+
+void nav_layers_build(Nav_Layer_Grid *grid, const Collision_Query &collision, Box3 bounds, float cell_size, Nav_Agent agent) {
+	grid->origin 	= bounds.min;
+	grid->cell_size = cell_size;
+	grid->size_x 	= std::max(1, (int32_t)std::ceil((bounds.max.x - bounds.min.x) / cell_size));
+	grid->size_y 	= std::max(1, (int32_t)std::ceil((bounds.max.y - bounds.min.y) / cell_size));
+	grid->z_min 	= bounds.min.z;
+	grid->z_max 	= bounds.max.z;
+	grid->agent 	= agent;
+	grid->built 	= false;
+
+	int32_t cell_count = grid->size_x * grid->size_y;
+	grid->cell_first_surface.assign(cell_count + 1, 0);
+	grid->surfaces.clear();
+	grid->links.clear();
+
+	// Find surfaces in every cell.
+	std::vector<Nav_Surface> column;
+	for (int32_t y = 0; y < grid->size_y; ++y) {
+		for (int32_t x = 0; x < grid->size_x; ++x) {
+			int32_t cell = cell_index(*grid, x, y);
+			grid->cell_first_surface[cell] = (uint32_t)grid->surfaces.size();
+
+			probe_cell_column(*grid, collision, cell_center(*grid, x, y), &column);
+			for (Nav_Surface &surface : column) {
+				surface.cell = cell;
+				grid->surfaces.push_back(surface);
+			}
+		}
+	}
+	grid->cell_first_surface[cell_count] = (uint32_t)grid->surfaces.size();
+
+	// Connect surfaces with their neighbours. We check only half of the directions and add links both ways.
+	// Diagonals are only allowed if both orthogonal neighbours are walkable, so we don't cut wall corners.
+	struct Direction { int32_t x, y; };
+	Direction directions[] = {{1,0}, {0,1}, {1,1}, {-1,1}};
+
+	std::vector<Nav_Edge> edges;
+	for (int32_t y = 0; y < grid->size_y; ++y) {
+		for (int32_t x = 0; x < grid->size_x; ++x) {
+			int32_t cell = cell_index(*grid, x, y);
+
+			for (Direction direction : directions) {
+				int32_t neighbour_x = x + direction.x;
+				int32_t neighbour_y = y + direction.y;
+				if (neighbour_x < 0 || neighbour_y < 0 || neighbour_x >= grid->size_x || neighbour_y >= grid->size_y) {
+					continue;
+				}
+				int32_t neighbour_cell 	= cell_index(*grid, neighbour_x, neighbour_y);
+				bool 	is_diagonal 	= direction.x != 0 && direction.y != 0;
+
+				for (uint32_t i = grid->cell_first_surface[cell]; i < grid->cell_first_surface[cell + 1]; ++i) {
+					const Nav_Surface &surface = grid->surfaces[i];
+
+					int32_t neighbour = find_walkable_neighbour(*grid, surface, neighbour_cell);
+					if (neighbour < 0) {
+						continue;
+					}
+
+					if (is_diagonal) {
+						if (find_walkable_neighbour(*grid, surface, cell_index(*grid, neighbour_x, y)) < 0
+							|| find_walkable_neighbour(*grid, surface, cell_index(*grid, x, neighbour_y)) < 0) {
+							continue;
+						}
+					}
+
+					const Nav_Surface &other = grid->surfaces[neighbour];
+
+					// Thin walls can stand between cell centers, check it with a ray above the step height.
+					float 	wall_check_z 	= std::fmax(surface.z, other.z) + agent.max_step_height + surface_skin;
+					Vec3 	from 			= cell_center(*grid, x, y);
+					Vec3 	to 				= cell_center(*grid, neighbour_x, neighbour_y);
+							from.z 			= wall_check_z;
+							to.z 			= wall_check_z;
+					Collision_Hit hit;
+					if (collision.ray(from, to, &hit)) {
+						continue;
+					}
+
+					Vec3 surface_point 	= nav_layers_surface_point(*grid, i);
+					Vec3 other_point 	= nav_layers_surface_point(*grid, (uint32_t)neighbour);
+
+					Nav_Edge edge;
+					edge.link.cost = vec3_distance(surface_point, other_point);
+					edge.link.type = std::fabs(other.z - surface.z) > agent.max_step_height * 0.5f ? NAV_LINK_STEP : NAV_LINK_WALK;
+
+					edge.from 		= i;
+					edge.link.to 	= (uint32_t)neighbour;
+					edges.push_back(edge);
+
+					edge.from 		= (uint32_t)neighbour;
+					edge.link.to 	= i;
+					edges.push_back(edge);
+				}
+			}
+		}
+	}
+
+	rebuild_link_table(grid, edges);
+	grid->surface_blocked.assign(grid->surfaces.size(), 0);
+	grid->built = true;
+}
+
+int32_t nav_layers_walkable_neighbour(const Nav_Layer_Grid &grid, uint32_t surface_index, int32_t neighbour_cell) {
+	return find_walkable_neighbour(grid, grid.surfaces[surface_index], neighbour_cell);
+}
+
+void nav_layers_add_links(Nav_Layer_Grid *grid, const std::vector<Nav_Edge> &new_edges) {
+	std::vector<Nav_Edge> edges;
+	collect_edges(*grid, &edges);
+	edges.insert(edges.end(), new_edges.begin(), new_edges.end());
+	rebuild_link_table(grid, edges);
+}
+
+int nav_layers_update_blocked(Nav_Layer_Grid *grid, Box3 dirty_region, const std::vector<Box3> &obstacles) {
+	if (!grid->built) {
+		return 0;
+	}
+
+	int32_t min_x = std::max(0, (int32_t)std::floor((dirty_region.min.x - grid->agent.radius - grid->origin.x) / grid->cell_size));
+	int32_t min_y = std::max(0, (int32_t)std::floor((dirty_region.min.y - grid->agent.radius - grid->origin.y) / grid->cell_size));
+	int32_t max_x = std::min(grid->size_x - 1, (int32_t)std::floor((dirty_region.max.x + grid->agent.radius - grid->origin.x) / grid->cell_size));
+	int32_t max_y = std::min(grid->size_y - 1, (int32_t)std::floor((dirty_region.max.y + grid->agent.radius - grid->origin.y) / grid->cell_size));
+
+	int changed = 0;
+	for (int32_t y = min_y; y <= max_y; ++y) {
+		for (int32_t x = min_x; x <= max_x; ++x) {
+			int32_t cell 	= cell_index(*grid, x, y);
+			Vec3 	center 	= cell_center(*grid, x, y);
+
+			for (uint32_t i = grid->cell_first_surface[cell]; i < grid->cell_first_surface[cell + 1]; ++i) {
+				// Space bot takes when it stands on this surface, obstacles below step height don't block.
+				const Nav_Surface &surface = grid->surfaces[i];
+				Box3 agent_box;
+				agent_box.min = Vec3(center.x - grid->agent.radius, center.y - grid->agent.radius, surface.z + grid->agent.max_step_height);
+				agent_box.max = Vec3(center.x + grid->agent.radius, center.y + grid->agent.radius, surface.z + grid->agent.height);
+
+				uint8_t blocked = 0;
+				for (const Box3 &obstacle : obstacles) {
+					if (box3_overlaps(obstacle, agent_box)) {
+						blocked = 1;
+						break;
+					}
+				}
+
+				if (grid->surface_blocked[i] != blocked) {
+					grid->surface_blocked[i] = blocked;
+					++changed;
+				}
+			}
+		}
+	}
+
+	return changed;
+}
+
+Nav_Blocked_Flags nav_layers_publish_blocked(const Nav_Layer_Grid &grid) {
+	return std::make_shared<const std::vector<uint8_t>>(grid.surface_blocked);
+}
+
+int32_t nav_layers_find_surface(const Nav_Layer_Grid &grid, Vec3 feet_point) {
+	if (!grid.built) {
+		return -1;
+	}
+
+	int32_t x = (int32_t)std::floor((feet_point.x - grid.origin.x) / grid.cell_size);
+	int32_t y = (int32_t)std::floor((feet_point.y - grid.origin.y) / grid.cell_size);
+
+	// Look at the cell itself first, then ring around it, because point can be right at the wall
+	// and its cell has no surface we can stand on.
+	for (int32_t ring = 0; ring <= 1; ++ring) {
+		int32_t best 	= -1;
+		float 	best_z 	= 0.0f;
+
+		for (int32_t cell_y = y - ring; cell_y <= y + ring; ++cell_y) {
+			for (int32_t cell_x = x - ring; cell_x <= x + ring; ++cell_x) {
+				if (cell_x < 0 || cell_y < 0 || cell_x >= grid.size_x || cell_y >= grid.size_y) {
+					continue;
+				}
+
+				int32_t cell = cell_index(grid, cell_x, cell_y);
+				for (uint32_t i = grid.cell_first_surface[cell]; i < grid.cell_first_surface[cell + 1]; ++i) {
+					// We want the highest surface that is not above our feet.
+					const Nav_Surface &surface = grid.surfaces[i];
+					if (surface.z <= feet_point.z + grid.agent.max_step_height && (best < 0 || surface.z > best_z)) {
+						best 	= (int32_t)i;
+						best_z 	= surface.z;
+					}
+				}
+			}
+		}
+
+		if (best >= 0) {
+			return best;
+		}
+	}
+
+	return -1;
+}
+
+Vec3 nav_layers_surface_point(const Nav_Layer_Grid &grid, uint32_t surface_index) {
+	const Nav_Surface &surface = grid.surfaces[surface_index];
+	Vec3 point = cell_center(grid, surface.cell % grid.size_x, surface.cell / grid.size_x);
+	point.z = surface.z;
+	return point;
+}
+
+bool nav_layers_find_path(const Nav_Layer_Grid &grid, Vec3 start_feet, Vec3 goal_feet, std::vector<Vec3> *out_points, std::vector<Nav_Link> *out_links,
+	const uint8_t *blocked) {
+	if (!blocked) {
+		blocked = grid.surface_blocked.data();
+	}
+
+	out_points->clear();
+	if (out_links) {
+		out_links->clear();
+	}
+
+	int32_t start 	= nav_layers_find_surface(grid, start_feet);
+	int32_t goal 	= nav_layers_find_surface(grid, goal_feet);
+	if (start < 0 || goal < 0) {
+		return false;
+	}
+
+	Vec3 goal_point = nav_layers_surface_point(grid, (uint32_t)goal);
+
+	size_t surface_count = grid.surfaces.size();
+	std::vector<float> 		cost_so_far(surface_count, -1.0f);
+	std::vector<int32_t> 	came_from(surface_count, -1);
+	std::vector<uint32_t> 	came_by_link(surface_count, 0);
+	std::vector<bool> 		closed(surface_count, false);
+	std::priority_queue<Open_Node> open;
+
+	cost_so_far[start] = 0.0f;
+	open.push(Open_Node{vec3_distance(nav_layers_surface_point(grid, (uint32_t)start), goal_point), (uint32_t)start});
+
+	bool found = false;
+	while (!open.empty()) {
+		uint32_t current = open.top().surface;
+		open.pop();
+
+		if (closed[current]) {
+			continue;
+		}
+		closed[current] = true;
+
+		if ((int32_t)current == goal) {
+			found = true;
+			break;
+		}
+
+		const Nav_Surface &surface = grid.surfaces[current];
+		for (uint32_t l = 0; l < surface.link_count; ++l) {
+			const Nav_Link &link = grid.links[surface.first_link + l];
+			if (closed[link.to] || blocked[link.to]) {
+				continue;
+			}
+
+			float new_cost = cost_so_far[current] + link.cost;
+			if (cost_so_far[link.to] < 0.0f || new_cost < cost_so_far[link.to]) {
+				cost_so_far[link.to] 	= new_cost;
+				came_from[link.to] 		= (int32_t)current;
+				came_by_link[link.to] 	= surface.first_link + l;
+				open.push(Open_Node{new_cost + vec3_distance(nav_layers_surface_point(grid, link.to), goal_point), link.to});
+			}
+		}
+	}
+
+	if (!found) {
+		return false;
+	}
+
+	std::vector<uint32_t> surface_path;
+	for (int32_t current = goal; current >= 0; current = came_from[current]) {
+		surface_path.push_back((uint32_t)current);
+	}
+	std::reverse(surface_path.begin(), surface_path.end());
+
+	// Keep only points where we turn or change height, bot walks straight between them anyway.
+	// Jumps always keep both take off and landing points.
+	Nav_Link walk_link;
+	out_points->push_back(start_feet);
+	if (out_links) {
+		out_links->push_back(walk_link);
+	}
+
+	for (size_t i = 1; i + 1 < surface_path.size(); ++i) {
+		Vec3 previous 	= nav_layers_surface_point(grid, surface_path[i - 1]);
+		Vec3 current 	= nav_layers_surface_point(grid, surface_path[i]);
+		Vec3 next 		= nav_layers_surface_point(grid, surface_path[i + 1]);
+
+		const Nav_Link &link_to_current = grid.links[came_by_link[surface_path[i]]];
+		const Nav_Link &link_to_next 	= grid.links[came_by_link[surface_path[i + 1]]];
+
+		Vec3 to_current = current - previous;
+		Vec3 to_next 	= next - current;
+		bool same_direction = std::fabs(to_current.x - to_next.x) < 0.01f && std::fabs(to_current.y - to_next.y) < 0.01f;
+		bool same_height 	= std::fabs(to_current.z - to_next.z) < 1.0f;
+		bool is_jump 		= link_to_current.type == NAV_LINK_JUMP || link_to_next.type == NAV_LINK_JUMP;
+		if (!same_direction || !same_height || is_jump) {
+			out_points->push_back(current);
+			if (out_links) {
+				out_links->push_back(link_to_current.type == NAV_LINK_JUMP ? link_to_current : walk_link);
+			}
+		}
+	}
+
+	out_points->push_back(goal_feet);
+	if (out_links) {
+		const Nav_Link &last_link = grid.links[came_by_link[goal]];
+		out_links->push_back(surface_path.size() > 1 && last_link.type == NAV_LINK_JUMP ? last_link : walk_link);
+	}
+
+	return true;
+}
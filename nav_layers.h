@@ -0,0 +1,100 @@
+#pragma once
+
+// Layered navigation data.
+// Level is split into XY cells and every cell keeps all walkable surfaces found in it (ground, ramps, stairs, floors above).
+// Surfaces are connected with neighbouring surfaces if bot can walk or step between them,
+// so planning over this graph works across floors without doing flat sweeps per floor.
+
+#include "cd_math.h"
+#include "collision_query.h"
+
+#include <memory>
+#include <stdint.h>
+#include <vector>
+
+struct Nav_Agent {
+	float radius 			= 20.0f;
+	float height 			= 184.0f;
+	float max_step_height 	= 45.0f;
+	float max_slope_cos 	= 0.7f; // Around 45 degrees.
+};
+
+enum Nav_Link_Type : uint8_t {
+	NAV_LINK_WALK = 0,
+	NAV_LINK_STEP, 	// Height changes more than a little, like stairs or ramp edge.
+	NAV_LINK_JUMP, 	// Baked jump arc, see nav_jump_links.h.
+};
+
+struct Nav_Surface {
+	float 		z 			= 0.0f; // Height of the floor.
+	float 		ceiling 	= 0.0f; // Height of the first thing above the floor.
+	int32_t 	cell 		= 0;
+	uint32_t 	first_link 	= 0;
+	uint32_t 	link_count 	= 0;
+};
+
+struct Nav_Link {
+	uint32_t 		to 				= 0;
+	float 			cost 			= 0.0f;
+	float 			jump_hold_time 	= 0.0f; // How long to hold jump, only for NAV_LINK_JUMP.
+	Nav_Link_Type 	type 			= NAV_LINK_WALK;
+};
+
+// Link with its source, used when we add links to already built grid.
+struct Nav_Edge {
+	uint32_t 	from = 0;
+	Nav_Link 	link;
+};
+
+struct Nav_Layer_Grid {
+	Vec3 		origin; 			// Min corner of the grid.
+	float 		cell_size 	= 50.0f;
+	int32_t 	size_x 		= 0;
+	int32_t 	size_y 		= 0;
+	float 		z_min 		= 0.0f;
+	float 		z_max 		= 0.0f;
+	Nav_Agent 	agent;
+
+	// Surfaces of cell i are surfaces[cell_first_surface[i] .. cell_first_surface[i + 1]), sorted from bottom to top.
+	std::vector<uint32_t> 		cell_first_surface;
+	std::vector<Nav_Surface> 	surfaces;
+	std::vector<Nav_Link> 		links;
+
+	// Surfaces currently covered by dynamic obstacles. Grid is baked without them,
+	// so we only flip these flags when obstacles move, see nav_change_log.h.
+	std::vector<uint8_t> 		surface_blocked;
+
+	bool built = false;
+};
+
+// Cells and links are built once, on level load. Cost is around (surfaces * 6) rays.
+void nav_layers_build(Nav_Layer_Grid *grid, const Collision_Query &collision, Box3 bounds, float cell_size, Nav_Agent agent);
+
+// Adds extra links (for example jumps) to the built grid.
+void nav_layers_add_links(Nav_Layer_Grid *grid, const std::vector<Nav_Edge> &edges);
+
+// Recomputes blocked flags of surfaces inside dirty region from current obstacle boxes.
+// Returns how many surfaces changed.
+int nav_layers_update_blocked(Nav_Layer_Grid *grid, Box3 dirty_region, const std::vector<Box3> &obstacles);
+
+// Blocked flags as they were when published, they never change after that. Game thread updates grid.surface_blocked
+// while searches on other threads plan, so they read one of these instead (see path_planner.h).
+// Publish again after blocked flags changed, searches that started before keep the copy they got.
+typedef std::shared_ptr<const std::vector<uint8_t>> Nav_Blocked_Flags;
+Nav_Blocked_Flags nav_layers_publish_blocked(const Nav_Layer_Grid &grid);
+
+// Returns index of the surface that point (feet position) stands on, or -1.
+int32_t nav_layers_find_surface(const Nav_Layer_Grid &grid, Vec3 feet_point);
+
+// Center of the surface cell at floor height.
+Vec3 nav_layers_surface_point(const Nav_Layer_Grid &grid, uint32_t surface_index);
+
+// Surface we can walk or step to in the neighbour cell, or -1.
+int32_t nav_layers_walkable_neighbour(const Nav_Layer_Grid &grid, uint32_t surface_index, int32_t neighbour_cell);
+
+// A* over the surfaces, blocked surfaces are skipped. Points are feet positions, out_points starts with start and ends with goal.
+// Straight runs are merged, so out_points only keeps turns, layer changes and jumps.
+// If out_links is given, out_links[i] is the link we take to get to out_points[i] (first one is just walk).
+// If blocked is given, it's used instead of grid.surface_blocked, one flag per surface.
+bool nav_layers_find_path(const Nav_Layer_Grid &grid, Vec3 start_feet, Vec3 goal_feet, std::vector<Vec3> *out_points, std::vector<Nav_Link> *out_links = nullptr,
+	const uint8_t *blocked = nullptr);
@@ -0,0 +1,69 @@
+#include "objective_prediction.h"
+#include "trace_recorder.h"
+
+namespace {
+	// Exponential smoothing factor that doesn't depend on framerate.
+	float smoothing_factor(float dt, float smoothing_time) {
+		if (smoothing_time <= 0.0f) {
+			return 1.0f;
+		}
+		return 1.0f - std::exp(-dt / smoothing_time);
+	}
+
+	int intercept_iterations = 3;
+}
+
+void objective_estimate_update(Objective_Estimate *estimate, const Objective_Prediction_Params &params, Vec3 target_velocity, float dt) {
+	// We only care about walking on the ground, falling and jumping would throw prediction into the floor.
+	target_velocity.z = 0.0f;
+
+	// How much current velocity differs from what we expected tells us how steady objective moves.
+	float 	smoothed_speed 	= vec3_length(estimate->smoothed_velocity);
+	float 	difference 		= vec3_length(target_velocity - estimate->smoothed_velocity);
+	float 	steadiness 		= std::exp(-difference / std::fmax(smoothed_speed, params.still_speed));
+	estimate->confidence += (steadiness - estimate->confidence) * smoothing_factor(dt, params.confidence_smoothing_time);
+
+	estimate->smoothed_velocity += (target_velocity - estimate->smoothed_velocity) * smoothing_factor(dt, params.velocity_smoothing_time);
+}
+
+bool objective_prediction_update(Objective_Prediction *prediction, const Objective_Prediction_Params &params, const Objective_Estimate &estimate,
+	Vec3 bot_position, Vec3 target_position, float dt, Vec3 *out_objective) {
+	trace_scope("objective_prediction_update");
+
+	// Intercept point: how long will it take us to get where objective will be by then?
+	// Few iterations are enough, it converges quickly when bot is faster than objective.
+	Vec3 velocity = estimate.smoothed_velocity;
+	if (vec3_length(velocity) < params.still_speed) {
+		velocity = Vec3();
+	}
+
+	float max_lead_time = params.max_lead_time * estimate.confidence;
+	float lead_time 	= 0.0f;
+	for (int i = 0; i < intercept_iterations; ++i) {
+		Vec3 future_point = target_position + velocity * lead_time;
+		lead_time = std::fmin(vec3_distance_2d(bot_position, future_point) / params.bot_speed, max_lead_time);
+	}
+
+	prediction->lead_time 		= lead_time;
+	prediction->predicted_point = target_position + velocity * lead_time;
+	prediction->time_since_update += dt;
+
+	// Decide if it's time to give bot a new objective.
+	bool take_new_objective = !prediction->has_objective;
+	if (!take_new_objective) {
+		float update_interval 	= params.min_update_interval + (params.max_update_interval - params.min_update_interval) * estimate.confidence;
+		float moved 			= vec3_distance(prediction->objective, prediction->predicted_point);
+
+		take_new_objective = moved >= params.force_replan_distance
+			|| (prediction->time_since_update >= update_interval && moved >= params.replan_distance);
+	}
+
+	if (take_new_objective) {
+		prediction->objective 			= prediction->predicted_point;
+		prediction->has_objective 		= true;
+		prediction->time_since_update 	= 0.0f;
+	}
+
+	*out_objective = prediction->objective;
+	return take_new_objective;
+}
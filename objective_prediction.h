@@ -0,0 +1,49 @@
+#pragma once
+
+// Predicts where a moving objective (player) will be when bot gets there,
+// so bot goes to intercept point instead of trailing behind and replanning all the time.
+//
+// Confidence tells how steady objective velocity is. High confidence means we lead further
+// and keep the same objective longer, low confidence (player is zigzagging) means
+// we lead less and update objective more often.
+//
+// 	objective_estimate_update(&estimate, params, player_velocity, step_dt); 		// Once per step, shared by everybody.
+// 	objective_prediction_update(&bot_prediction, params, estimate, ...); 			// Every bot when it thinks.
+//
+// Estimate of how objective moves is one for all bots. Intercept point depends on where the bot is,
+// so every bot has its own prediction, and its own time to take a new objective.
+
+#include "cd_math.h"
+
+struct Objective_Prediction_Params {
+	float bot_speed 				= 1846.0f; 	// Speed bot really walks with (walking force divided by drag).
+	float max_lead_time 			= 2.0f; 	// Never predict further than this many seconds.
+	float velocity_smoothing_time 	= 0.25f; 	// Smoothing of objective velocity, in seconds.
+	float confidence_smoothing_time = 0.5f;
+	float min_update_interval 		= 0.15f; 	// Low confidence - we take new objective this often.
+	float max_update_interval 		= 1.0f; 	// High confidence - we keep objective this long.
+	float replan_distance 			= 150.0f; 	// Predicted point needs to move this much before we take it.
+	float force_replan_distance 	= 800.0f; 	// If it moved this much, we take it right away.
+	float still_speed 				= 50.0f; 	// Objective slower than this is standing still.
+};
+
+struct Objective_Estimate {
+	Vec3 	smoothed_velocity;
+	float 	confidence = 0.0f;
+};
+
+struct Objective_Prediction {
+	Vec3 	predicted_point;
+	Vec3 	objective; 					// Last objective we gave to the bot.
+	float 	time_since_update 	= 0.0f;
+	float 	lead_time 			= 0.0f;
+	bool 	has_objective 		= false;
+};
+
+// Call once per step with how objective moves now.
+void objective_estimate_update(Objective_Estimate *estimate, const Objective_Prediction_Params &params, Vec3 target_velocity, float dt);
+
+// Call every AI update of the bot, dt is time since its last one. Returns true when bot should take
+// out_objective as its new objective, otherwise out_objective is the one we gave before.
+bool objective_prediction_update(Objective_Prediction *prediction, const Objective_Prediction_Params &params, const Objective_Estimate &estimate,
+	Vec3 bot_position, Vec3 target_position, float dt, Vec3 *out_objective);
@@ -0,0 +1,277 @@
+#include "path_planner.h"
+#include "debug_draw.h"
+#include "trace_recorder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+enum Path_Job_State {
+	PATH_JOB_WAITING, 	// For a share of frame budget.
+	PATH_JOB_RUNNING, 	// Queued in pool or running on a worker.
+	PATH_JOB_DONE, 		// Result is written and worker doesn't touch job anymore.
+};
+
+struct Path_Planner_Job {
+	Path_Request 		request;
+	Path_Search_Config 	config;
+	Path_Result 		result;
+	uint32_t 			random_state 	= 1;
+	bool 				started 		= false;
+	int 				share 			= 0; // Traces for current run, zero is no limit.
+
+	std::chrono::steady_clock::time_point waiting_since;
+
+	std::atomic<int> 	state 		{PATH_JOB_WAITING};
+	std::atomic<bool> 	cancelled 	{false};
+};
+
+namespace {
+	// Xorshift, every job has its own, so workers don't share generator state.
+	int job_random_range(void *user, int min, int max) {
+		uint32_t &state = *(uint32_t *)user;
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return min + (int)(state % (uint32_t)(max - min + 1));
+	}
+
+	bool job_is_finished(const Path_Planner_Job &job) {
+		const Path_Search &search = job.result.search;
+		return search.found_path || path_search_failed(search, job.config) || job.result.steps >= job.request.max_steps;
+	}
+
+	void run_job(Path_Planner *planner, Path_Planner_Job *job) {
+		trace_scope("path_planner_job");
+
+		// Debug lines are buffered for the game thread only.
+		debug_draw_mute_this_thread();
+
+		const Path_Request 	&request 	= job->request;
+		Path_Search 		&search 	= job->result.search;
+
+		if (!job->started) {
+			job->started = true;
+			path_search_begin(&search, request.start);
+		}
+
+		uint32_t traces_before 	= search.counters.traces;
+		search.trace_limit 		= job->share > 0 ? traces_before + job->share : UINT32_MAX;
+
+		bool finished = false;
+		while (true) {
+			if (job->cancelled.load(std::memory_order_relaxed) || job_is_finished(*job)) {
+				finished = true;
+				break;
+			}
+			// Step only starts if everything it does besides rotation search fits into what's left.
+			// First step always runs, begin_frame() gave us at least that much (unless it's more than whole budget).
+			bool first_step = search.counters.traces == traces_before;
+			if (!first_step && search.counters.traces + path_search_step_trace_bound(job->config) >= search.trace_limit) {
+				break;
+			}
+
+			path_search_step(&search, *request.collision, job->config, request.goal);
+			if (!path_search_paused(search)) {
+				++job->result.steps;
+			}
+		}
+
+		planner->traces_used += search.counters.traces - traces_before;
+
+		if (finished) {
+			job->result.cancelled = job->cancelled.load();
+			job->state.store(PATH_JOB_DONE, std::memory_order_release);
+		} else {
+			job->waiting_since = std::chrono::steady_clock::now();
+			job->state.store(PATH_JOB_WAITING, std::memory_order_release);
+		}
+	}
+
+	// On the thread that hands the result out, workers never touch stats.
+	void record_stats(const Path_Request &request, const Path_Result &result) {
+		if (!request.stats) {
+			return;
+		}
+		for (const Find_Path_Point_Sample &sample : result.find_path_point_samples) {
+			search_stats_add_find_path_point(request.stats, sample.microseconds, sample.sweep_iterations);
+		}
+		search_stats_add_search(request.stats, result.search.counters, result.search.found_path);
+	}
+
+	void dispatch_job(Path_Planner *planner, const std::shared_ptr<Path_Planner_Job> &job, int share) {
+		job->share = share;
+		job->state.store(PATH_JOB_RUNNING);
+
+		// Task keeps the job alive, even if ticket was cancelled and forgotten.
+		// Pool that was stopped takes nothing, job is done as cancelled.
+		if (!worker_pool_push(&planner->pool, [planner, job] { run_job(planner, job.get()); })) {
+			job->result.cancelled = true;
+			job->state.store(PATH_JOB_DONE, std::memory_order_release);
+		}
+	}
+}
+
+void path_planner_start(Path_Planner *planner, int worker_count) {
+	worker_pool_start(&planner->pool, worker_count, "Path planner");
+}
+
+void path_planner_stop(Path_Planner *planner) {
+	{
+		std::lock_guard<std::mutex> lock(planner->jobs_mutex);
+		for (auto &ticket_and_job : planner->jobs) {
+			ticket_and_job.second->cancelled.store(true);
+		}
+		planner->jobs.clear();
+	}
+	worker_pool_stop(&planner->pool);
+}
+
+bool path_planner_running(const Path_Planner &planner) {
+	return worker_pool_running(planner.pool);
+}
+
+uint64_t path_planner_submit(Path_Planner *planner, const Path_Request &request) {
+	if (!path_planner_running(*planner)) {
+		return 0;
+	}
+
+	std::shared_ptr<Path_Planner_Job> job(new Path_Planner_Job());
+	job->request 		= request;
+	job->waiting_since 	= std::chrono::steady_clock::now();
+
+	job->config 					= planner->config;
+	job->config.collision_size 		= request.half_extents.x;
+	job->config.collision_height 	= request.half_extents.z;
+	job->config.user 				= &job->random_state;
+	job->config.random_range 		= job_random_range;
+	job->config.stats 				= nullptr;
+	job->config.samples 			= request.stats ? &job->result.find_path_point_samples : nullptr;
+	if (request.surface_blocked) {
+		job->config.surface_blocked = request.surface_blocked.get();
+	}
+
+	std::lock_guard<std::mutex> lock(planner->jobs_mutex);
+
+	uint64_t ticket = planner->next_ticket++;
+	planner->jobs[ticket] = job;
+
+	job->result.ticket 	= ticket;
+	job->random_state 	= request.seed != 0 ? request.seed : (uint32_t)ticket * 2654435761u;
+	if (job->random_state == 0) {
+		job->random_state = 1; // Xorshift stays at zero forever.
+	}
+
+	// Without budget search runs right away, with budget it waits for path_planner_begin_frame().
+	if (planner->budget.traces_per_frame <= 0) {
+		dispatch_job(planner, job, 0);
+	}
+	return ticket;
+}
+
+bool path_planner_take(Path_Planner *planner, uint64_t ticket, Path_Result *out_result) {
+	std::lock_guard<std::mutex> lock(planner->jobs_mutex);
+
+	auto found = planner->jobs.find(ticket);
+	if (found == planner->jobs.end() || found->second->state.load(std::memory_order_acquire) != PATH_JOB_DONE) {
+		return false;
+	}
+
+	record_stats(found->second->request, found->second->result);
+	*out_result = std::move(found->second->result);
+	planner->jobs.erase(found);
+	return true;
+}
+
+void path_planner_cancel(Path_Planner *planner, uint64_t ticket) {
+	std::lock_guard<std::mutex> lock(planner->jobs_mutex);
+
+	auto found = planner->jobs.find(ticket);
+	if (found != planner->jobs.end()) {
+		found->second->cancelled.store(true);
+		planner->jobs.erase(found);
+	}
+}
+
+void path_planner_update_priority(Path_Planner *planner, uint64_t ticket, float distance_to_player, bool visible) {
+	std::lock_guard<std::mutex> lock(planner->jobs_mutex);
+
+	auto found = planner->jobs.find(ticket);
+	if (found != planner->jobs.end()) {
+		found->second->request.distance_to_player 	= distance_to_player;
+		found->second->request.visible 				= visible;
+	}
+}
+
+void path_planner_begin_frame(Path_Planner *planner) {
+	trace_scope("path_planner_begin_frame");
+
+	uint64_t traces_used 			= planner->traces_used.load();
+	planner->frame_traces_used 		= traces_used - planner->traces_used_before;
+	planner->traces_used_before 	= traces_used;
+	planner->frame_traces_given 	= 0;
+	planner->frame_deferred 		= 0;
+
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	std::lock_guard<std::mutex> lock(planner->jobs_mutex);
+
+	std::vector<std::shared_ptr<Path_Planner_Job>> waiting;
+	std::vector<Query_Budget_Candidate> candidates;
+	for (auto &ticket_and_job : planner->jobs) {
+		const std::shared_ptr<Path_Planner_Job> &job = ticket_and_job.second;
+		if (job->state.load(std::memory_order_acquire) != PATH_JOB_WAITING) {
+			continue;
+		}
+
+		Query_Budget_Candidate candidate;
+		candidate.index 	= (int)waiting.size();
+		candidate.min_share = (int)std::min<uint32_t>(path_search_step_trace_bound(job->config) + 1, (uint32_t)planner->budget.traces_per_frame);
+		candidate.priority 	= query_budget_priority(planner->budget, job->request.distance_to_player, job->request.visible,
+			std::chrono::duration<float>(now - job->waiting_since).count());
+		candidates.push_back(candidate);
+		waiting.push_back(job);
+	}
+
+	// Budget was turned off while requests waited.
+	if (planner->budget.traces_per_frame <= 0) {
+		for (const std::shared_ptr<Path_Planner_Job> &job : waiting) {
+			dispatch_job(planner, job, 0);
+		}
+		return;
+	}
+
+	int given = query_budget_distribute(planner->budget, &candidates);
+	for (int i = 0; i < given; ++i) {
+		dispatch_job(planner, waiting[candidates[i].index], candidates[i].share);
+		planner->frame_traces_given += candidates[i].share;
+	}
+	planner->frame_deferred = (int)candidates.size() - given;
+}
+
+int path_planner_poll(Path_Planner *planner) {
+	std::vector<std::shared_ptr<Path_Planner_Job>> finished;
+	{
+		std::lock_guard<std::mutex> lock(planner->jobs_mutex);
+		for (auto it = planner->jobs.begin(); it != planner->jobs.end();) {
+			const Path_Planner_Job &job = *it->second;
+			if (job.request.on_done && job.state.load(std::memory_order_acquire) == PATH_JOB_DONE) {
+				finished.push_back(it->second);
+				it = planner->jobs.erase(it);
+			} else {
+				++it;
+			}
+		}
+	}
+
+	// Outside of the lock, so callbacks can submit new requests.
+	for (const std::shared_ptr<Path_Planner_Job> &job : finished) {
+		record_stats(job->request, job->result);
+		job->request.on_done(job->request.user, job->result);
+	}
+	return (int)finished.size();
+}
+
+void path_planner_wait(Path_Planner *planner) {
+	worker_pool_wait_idle(&planner->pool);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+// Path planning service: path searches run on worker threads, game thread only submits requests and polls results.
+//
+// 	uint64_t ticket = path_planner_submit(&planner, request);
+// 	...
+// 	Path_Result result;
+// 	if (path_planner_take(&planner, ticket, &result)) { use result.search.path_points }
+//
+// Or give request a callback and call path_planner_poll() once per frame, it calls callbacks for finished paths.
+// Either way results are handed out on the thread that asks, so bots never see a half written path.
+//
+// Every request is one whole search, from path_search_begin() until path is found, search failed or max_steps ran out.
+// Requests are spread over Worker_Pool, idle workers steal from busy ones.
+//
+// With budget (budget.traces_per_frame) searches don't run at once. Game thread calls path_planner_begin_frame()
+// every frame, it orders waiting requests by priority and gives them shares of the frame budget (query_budget.h).
+// Search runs until its share is used, rotation search pauses in the middle if needed (Path_Search::trace_limit),
+// and waits for the next frame. So all bots together never trace more than the budget, however many there are.
+//
+// @note: Collision must be thread safe (see Collision_Query). Navigation layers must not be rebuilt while planner runs,
+// blocked flags that change every frame come with the request as a published copy (request.surface_blocked).
+// @note: Workers don't draw debug lines and don't record to stats. Counters and find_path_point() samples come back
+// in the result, and go into request.stats on the thread that takes or polls it.
+
+#include "path_search.h"
+#include "query_budget.h"
+#include "worker_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+struct Path_Result;
+
+struct Path_Request {
+	Vec3 start;
+	Vec3 goal;
+	Vec3 half_extents = Vec3(20.0f, 20.0f, 92.0f); // Search is in XY with square collision, so only x and z are used.
+
+	const Collision_Query *collision = nullptr; // Must live until result is taken or cancelled.
+
+	// Optional, job keeps it alive until the worker is done with it. For collision made for one request,
+	// so its parameters can't change while workers trace with them.
+	std::shared_ptr<const Collision_Query> collision_owner;
+
+	int 		max_steps 	= 256; 	// path_search_step() calls before we give up, paused steps don't count.
+	uint32_t 	seed 		= 0; 	// For search direction choice. Zero uses ticket.
+
+	Search_Stats *stats = nullptr; // Optional, see @note above. Must live until result is taken or cancelled.
+
+	// Optional, job keeps it alive. Blocked flags of config.layers the search reads, see nav_layers_publish_blocked().
+	Nav_Blocked_Flags surface_blocked;
+
+	// For budget priority, update them with path_planner_update_priority() while request waits.
+	float 	distance_to_player 	= 0;
+	bool 	visible 			= true;
+
+	// Optional, called from path_planner_poll().
+	void *user = nullptr;
+	void (*on_done)(void *user, const Path_Result &result) = nullptr;
+};
+
+struct Path_Result {
+	uint64_t 	ticket 		= 0;
+	Path_Search search; 			// found_path, path points, jumps, failure counters and search counters.
+	std::vector<Find_Path_Point_Sample> find_path_point_samples;
+	int 		steps 		= 0;
+	bool 		cancelled 	= false;
+};
+
+struct Path_Planner_Job;
+
+struct Path_Planner {
+	Path_Search_Config 	config; // Copied into every request, except collision size, random_range and stats.
+	Query_Budget_Params budget; // Zero traces per frame means no budget.
+	Worker_Pool 		pool;
+
+	// What happened in last path_planner_begin_frame(): traces given out, requests that got nothing,
+	// and traces workers really used since the frame before.
+	int 		frame_traces_given 	= 0;
+	int 		frame_deferred 		= 0;
+	uint64_t 	frame_traces_used 	= 0;
+
+	std::atomic<uint64_t> 	traces_used 		{0};
+	uint64_t 				traces_used_before 	= 0;
+
+	std::mutex 			jobs_mutex;
+	uint64_t 			next_ticket = 1;
+
+	// Submitted and not taken yet.
+	std::unordered_map<uint64_t, std::shared_ptr<Path_Planner_Job>> jobs;
+};
+
+// Zero workers means one less than hardware threads.
+void path_planner_start(Path_Planner *planner, int worker_count);
+
+// Cancels everything and joins workers. Results that weren't taken are dropped.
+void path_planner_stop(Path_Planner *planner);
+
+bool path_planner_running(const Path_Planner &planner);
+
+// Returns ticket, zero if planner isn't running, nothing is submitted then.
+uint64_t path_planner_submit(Path_Planner *planner, const Path_Request &request);
+
+// True and fills result if that search has finished. Ticket is forgotten after this.
+bool path_planner_take(Path_Planner *planner, uint64_t ticket, Path_Result *out_result);
+
+// Search stops at its next step and result is dropped.
+void path_planner_cancel(Path_Planner *planner, uint64_t ticket);
+
+void path_planner_update_priority(Path_Planner *planner, uint64_t ticket, float distance_to_player, bool visible);
+
+// Gives this frame's budget to waiting requests. Call once per frame from game thread, it's not needed without budget.
+void path_planner_begin_frame(Path_Planner *planner);
+
+// Calls on_done of finished requests that have it and forgets them. Returns how many.
+int path_planner_poll(Path_Planner *planner);
+
+// Blocks until workers have nothing to do, for tools and shutdown. With budget, requests that wait for next frame keep waiting.
+void path_planner_wait(Path_Planner *planner);
@@ -0,0 +1,755 @@
+#include "path_search.h"
+#include "debug_draw.h"
+#include "trace_recorder.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+	// @note: Not pi and tau, those are macros in hero.h and bot.h.
+	float search_pi 	= 3.1415926535897932384626433832795f;
+	float search_tau 	= search_pi * 2;
+
+	uint32_t color_yellow 		= 0xFFFF00;
+	uint32_t color_green 		= 0x00FF00;
+	uint32_t color_red 			= 0xFF0000;
+	uint32_t color_pinkish 		= 0xE450A2;
+	uint32_t color_turquoise 	= 0x47E2EF; // Victory turquoise.
+
+	const int max_fan_batch_size = 64;
+
+	double microseconds_since(std::chrono::steady_clock::time_point start_time) {
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start_time).count();
+	}
+
+	// Angle of XY vector on trigonometric circle, from 0 to tau.
+	float angle_on_circle(Vec3 normalized_xy) {
+		float angle = std::acos(std::fmax(-1.0f, std::fmin(1.0f, normalized_xy.x)));
+		if (normalized_xy.y < 0) {
+			angle = search_tau - angle;
+		}
+		return angle;
+	}
+
+	Vec3 vector_on_circle(float angle) {
+		return Vec3(std::cos(angle), std::sin(angle), 0.0f);
+	}
+
+	// Direction of i-th ray in rotation search fan.
+	Vec3 fan_direction(float start_angle, int i, bool search_right) {
+		// If we add degrees it's rotation to the right in Unreal, if we substract - it's rotation to the left.
+		float search_angle = start_angle * (180 / search_pi);
+
+		// We rotate and search by one degree, not radians.
+		if (search_right) {
+			search_angle += i;
+		} else {
+			search_angle -= i;
+		}
+
+		return vector_on_circle(search_angle * search_pi / 180); // Convert back to radians.
+	}
+
+	void set_path_point(Path_Search *search, const Path_Search_Config &config, Vec3 start_point, Vec3 path_point) {
+		search->path_points.push_back(path_point);
+
+		// Draw where point is.
+		debug_line(DEBUG_DRAW_PATH, Vec3(path_point.x, path_point.y, start_point.z - config.collision_height),
+			Vec3(path_point.x, path_point.y, start_point.z + config.collision_height), color_pinkish, true);
+
+		// Draw line from point to point.
+		debug_line(DEBUG_DRAW_PATH, start_point, path_point, color_turquoise, true);
+	}
+
+	bool find_path_point(Path_Search *search, const Collision_Query &collision, const Path_Search_Config &config, Vec3 start_point, Vec3 start_to_final, float start_to_final_distance, bool found_final_point, bool from_goal, Vec3 *path_point) {
+		trace_scope("find_path_point");
+
+		Path_Search_Side &side = from_goal ? search->from_goal : search->from_start;
+
+		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+		float whole_collision_size = config.collision_size * 2;
+
+		// @todo: 	Make sure to make implementation, when we don't hit any collision
+		// 			from A to B.
+		// Also, if we found straight path, there is no guarantee that we can fit into this
+		// straight passage.
+
+		// @todo: 	What if there is an obstacle at the bottom or at the top of bot collision?
+		// 			We need something like this: check_height_for_collision(dt);
+		// We will need this to know if collision can fit into found passage.
+
+		// @hack: To find if we can fit into passage, right now I'll some big width number.
+		// 		Maybe I can use more than twice of collision, before I implement something
+		// like check_height_for_collision(), so that bot wouldn't stuck at some
+		// obstacles or tricky wall angles, because I don't use Z axes in rotation search.
+		// 		Yeah, seems like we need to use more than twice of the collision.
+		// Right now my trace precision is only 360 degrees. Sometimes there is more wall
+		// collision left and we need to account for that.
+		// Will think about it when I'll test extreme cases like corridor with same width
+		// as bot collision. Guess right now I'll hack my way through that.
+		// -- Richard Chirkin 22.01.2022
+		float safe_distance_to_pass = whole_collision_size * 3;
+
+		// Point B is like the center of a circle. start_to_final_distance is radius of a circle.
+		// But we will use diameter of this imaginary B circle for our path search.
+		// @todo: 	What if target is near and passage to target is very far?
+		// 			Will this still work? Think not.
+		float search_length = start_to_final_distance * 2;
+
+		// We are searching only in XY plane, we don't need Z.
+		Vec3 start_to_final_search = vec3_normalize_2d(start_to_final);
+
+		// Prepare everything for raycast cycle.
+		Vec3 	first_success_trace_vector;
+		float 	new_trace_distance 		= 0;
+		float 	last_hit_distance 		= 0;
+		int 	success_traces_count 	= 0;
+		bool 	found_passage 			= false;
+
+		// Randomize decision in what direction to go.
+		if (!side.direction_was_randomized) {
+			side.direction_was_randomized = true;
+
+			int random_number = config.random_range ? config.random_range(config.user, 0, 1) : 0;
+			side.search_right = random_number != 0;
+		}
+
+		// Find angle between start_to_final_search and cosine vector on trigonometric circle, to know
+		// where to rotate in search cycle.
+		float start_to_final_search_angle = angle_on_circle(start_to_final_search);
+
+		// Fan rays can be traced in batches, backends like Headless_Bvh trace them as packets.
+		// We may trace up to batch size - 1 rays we don't need, if passage is found in the middle of a batch.
+		Collision_Ray 	fan_rays[max_fan_batch_size];
+		Collision_Hit 	fan_hits[max_fan_batch_size];
+		int 			fan_batch_size 	= std::max(1, std::min(config.fan_batch_size, max_fan_batch_size));
+		int 			fan_batch_first = 0;
+		int 			fan_batch_count = 0;
+
+		// Continue sweep that ran out of traces last step, if it's the same sweep.
+		Path_Sweep 	&sweep 		= search->sweep;
+		bool 		resuming 	= sweep.active && sweep.from_goal == from_goal && sweep.found_final_point == found_final_point
+			&& sweep.start_point.x == start_point.x && sweep.start_point.y == start_point.y && sweep.start_point.z == start_point.z;
+		sweep.active = false;
+
+		int i = 0;
+		if (resuming) {
+			i 							= sweep.next_index;
+			last_hit_distance 			= sweep.last_hit_distance;
+			success_traces_count 		= sweep.success_traces_count;
+			first_success_trace_vector 	= sweep.first_success_trace_vector;
+		} else {
+			++search->counters.find_path_point_calls;
+		}
+
+		for (; i <= config.maximum_to_rotate; ++i) {
+			Vec3 new_search_vector 	= fan_direction(start_to_final_search_angle, i, side.search_right);
+			Vec3 search_vector 		= start_point + new_search_vector * search_length;
+
+			if (i >= fan_batch_first + fan_batch_count) {
+				fan_batch_first = i;
+				fan_batch_count = std::min(fan_batch_size, config.maximum_to_rotate + 1 - i);
+
+				// Out of traces, save where we are and continue next step.
+				uint32_t traces_left = search->trace_limit > search->counters.traces ? search->trace_limit - search->counters.traces : 0;
+				if (traces_left == 0) {
+					sweep.active 						= true;
+					sweep.from_goal 					= from_goal;
+					sweep.found_final_point 			= found_final_point;
+					sweep.start_point 					= start_point;
+					sweep.next_index 					= i;
+					sweep.last_hit_distance 			= last_hit_distance;
+					sweep.success_traces_count 			= success_traces_count;
+					sweep.first_success_trace_vector 	= first_success_trace_vector;
+					return false;
+				}
+				fan_batch_count = std::min(fan_batch_count, (int)std::min(traces_left, (uint32_t)max_fan_batch_size));
+
+				for (int j = 0; j < fan_batch_count; ++j) {
+					fan_rays[j].from 	= start_point;
+					fan_rays[j].to 		= start_point + fan_direction(start_to_final_search_angle, i + j, side.search_right) * search_length;
+				}
+
+				if (fan_batch_count == 1) {
+					collision.ray(fan_rays[0].from, fan_rays[0].to, &fan_hits[0]);
+				} else {
+					collision.ray_batch(fan_rays, fan_batch_count, fan_hits);
+				}
+				search->counters.traces += fan_batch_count;
+			}
+
+			// Line trace search.
+			const Collision_Hit &hit_search = fan_hits[i - fan_batch_first];
+			Vec3 				point_hit;
+			bool 				found_empty_space = false;
+
+			if (hit_search.blocking) {
+				point_hit 			= hit_search.point;
+				new_trace_distance 	= hit_search.distance;
+			} else { // Found empty space (no walls were hit).
+				found_empty_space 	= true;
+				new_trace_distance 	= search_length;
+			}
+
+			// If this is initial trace, just save information and continue.
+			if (i == 0) {
+				// If we are looking at final_point, take twice of whole collision
+				// as distance for first trace, to compare it against success traces.
+				if (found_final_point) {
+					last_hit_distance = whole_collision_size * 2;
+				} else {
+					last_hit_distance = new_trace_distance;
+				}
+
+				new_trace_distance = 0.0f;
+
+				// If first trace, draw line towards point b location.
+				debug_line(DEBUG_DRAW_SEARCH_FAN, start_point, point_hit, color_yellow, false);
+
+				continue;
+			}
+
+			// Find out if our trace was successful to meet requirements on how to be successful or
+			// if it failed miserably.
+			// New wall is further. If this is an opening we fit in 1D, than it's a success trace.
+			// If new wall is nearer or the same, there is no opening, sadge.
+			// @todo: There is probably passage between walls. Should I do normal angle checking?
+			// But even if the wall seems nearer with no opening in 1D (in 1D wall = dot),
+			// there is still can be opening in 2D between last_hit_distance's wall and new wall.
+			bool success_trace = new_trace_distance > last_hit_distance && new_trace_distance - last_hit_distance >= safe_distance_to_pass;
+
+			if (success_trace) {
+				// We are hoping that we get successful sequence of traces and we don't
+				// care how far away new success traces are from last_hit_distance
+				// (or more like how longer are they from last_hit_distance).
+				// If we fulfill passage width with continues success traces, we will use
+				// last_hit_distance to find where we should place path point.
+				// That's why we don't overwrite last_hit_distance in success_trace.
+				Vec3 new_trace_vector = new_search_vector * last_hit_distance;
+
+				// We count success traces to know when was the first one and save it's search vector
+				// to use for point finding. We are finding the point in between the first and the last success trace.
+				++success_traces_count;
+				if (success_traces_count == 1) {
+					first_success_trace_vector = new_trace_vector;
+				}
+
+				float distance_between_line_traces = vec3_distance(new_trace_vector, first_success_trace_vector);
+
+				// Draw success trace, with the length of search_vector if there was no wall.
+				debug_line(DEBUG_DRAW_SEARCH_FAN, start_point, found_empty_space ? search_vector : point_hit, color_green, false);
+
+				// If opening is wide enough to go through, guess we found the passage!
+				// @todo: 	If wall is very near and we traced more than 180 degrees (if 180 is max), path point will not be set,
+				// 			because we are setting it using last_hit_distance that is very near us, and
+				// 			distance_between_line_traces will always be smaller than safe_distance_to_pass,
+				// 			but nevertheless there is actually enough space to set a point.
+				// Is this because safe_distance_to_pass is not actual bot collision and just a hack,
+				// or I need to set path point differently? Or just use 360 degrees?
+				if (distance_between_line_traces >= safe_distance_to_pass) {
+					found_passage = true;
+
+					// We want half of perpendicular vector from first_success_trace_vector to new_trace_vector.
+					Vec3 vector_to_set_point = vec3_normalize(new_trace_vector - first_success_trace_vector) * (distance_between_line_traces / 2);
+
+					*path_point = start_point + first_success_trace_vector + vector_to_set_point;
+
+					break;
+				}
+			} else {
+				// Save info for next success_trace comparison.
+				last_hit_distance = new_trace_distance;
+
+				// Reset success traces count.
+				success_traces_count = 0;
+
+				// Draw fail trace.
+				debug_line(DEBUG_DRAW_SEARCH_FAN, start_point, point_hit, color_red, false);
+			}
+
+			// If we didn't find the passage, for now just rotate search other side and
+			// hope that someday we will find the passage.
+			if (i == config.maximum_to_rotate) {
+				side.search_right = !side.search_right;
+				++search->counters.direction_flips;
+
+				// Save info that we failed to do rotation search in one direction.
+				if (from_goal) {
+					++search->failed_to_search_from_goal;
+				} else {
+					++search->failed_to_search_in_some_direction;
+				}
+
+				// @note: Stop searching if we didn't found anything in right and left turns?
+				// @note: If we failed searching in both directions, we never stop searching.
+				// Do we actually need to stop? EZ
+				// 360 degrees of raycasts will make your CPU very happy every frame! GIGACHAD
+
+				// @todo: This looks like the case where we actually found a dead end!
+
+				// @todo: 	If you place a point, that bot can't actually go to (not just Z height in 3D),
+				// bot will do rotation search forever.
+				// This is caused by safe_distance_to_pass being too high that results in
+				// bot being stuck forever.
+				// There is just not enough space for bot to get to our final point Sadge
+				// @note: 	Guess you can mark final point unreachable and just wait for another
+				// objective or maybe find new objective that you can reach.
+			}
+		}
+
+		uint32_t sweep_iterations = (uint32_t)std::min(i, config.maximum_to_rotate) + 1;
+		search->counters.sweep_iterations += sweep_iterations;
+		if (config.stats || config.samples) {
+			Find_Path_Point_Sample sample;
+			sample.microseconds 	= microseconds_since(start_time);
+			sample.sweep_iterations = sweep_iterations;
+			if (config.stats) {
+				search_stats_add_find_path_point(config.stats, sample.microseconds, sample.sweep_iterations);
+			}
+			if (config.samples) {
+				config.samples->push_back(sample);
+			}
+		}
+
+		return found_passage;
+	}
+
+	bool can_walk_straight(Path_Search *search, const Collision_Query &collision, const Path_Search_Config &config, Vec3 from, Vec3 to) {
+		trace_scope("can_walk_straight");
+
+		// Same idea as the final point check in path_search_step(): center ray and two rays from front corners of bot collision.
+		Vec3 direction = vec3_normalize_2d(to - from);
+		Vec3 side(-direction.y, direction.x, 0);
+		Vec3 corner_offsets[3] = {
+			Vec3(),
+			direction * config.collision_size + side * config.collision_size,
+			direction * config.collision_size - side * config.collision_size,
+		};
+
+		Collision_Hit hit;
+		for (const Vec3 &corner_offset : corner_offsets) {
+			++search->counters.traces;
+			if (collision.ray(from + corner_offset, to + corner_offset, &hit)) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool join_search_sides(Path_Search *search, const Collision_Query &collision, const Path_Search_Config &config) {
+		trace_scope("join_search_sides");
+
+		// Newest point of each side is checked against every point of the other side, from newest to oldest,
+		// because newest points are usually nearer to each other.
+		int start_join 	= -1;
+		int goal_join 	= -1;
+
+		std::vector<Vec3> &path_points = search->path_points;
+		std::vector<Vec3> &goal_points = search->goal_points;
+
+		// Every check is three rays. When we run out of traces, we remember where we stopped and continue next step.
+		int resume_index = search->join_next_index;
+		search->join_next_index = -1;
+
+		if (search->start_tip_is_new) {
+			Vec3 start_tip = path_points.back();
+			for (int j = resume_index >= 0 ? resume_index : goal_points.size() - 1; j >= 0 && goal_join < 0; --j) {
+				if (search->counters.traces + 3 > search->trace_limit) {
+					search->join_next_index = j;
+					return false;
+				}
+				if (can_walk_straight(search, collision, config, start_tip, goal_points[j])) {
+					start_join 	= path_points.size() - 1;
+					goal_join 	= j;
+				}
+			}
+
+			search->start_tip_is_new 	= false;
+			resume_index 				= -1;
+		}
+
+		if (goal_join < 0 && search->goal_tip_is_new) {
+			Vec3 goal_tip = goal_points.back();
+			for (int i = resume_index >= 0 ? resume_index : path_points.size() - 1; i >= 0 && start_join < 0; --i) {
+				if (search->counters.traces + 3 > search->trace_limit) {
+					search->join_next_index = i;
+					return false;
+				}
+				if (can_walk_straight(search, collision, config, path_points[i], goal_tip)) {
+					start_join 	= i;
+					goal_join 	= goal_points.size() - 1;
+				}
+			}
+
+			search->goal_tip_is_new = false;
+		}
+
+		if (goal_join < 0) {
+			return false;
+		}
+
+		// Drop start side points after the join and walk goal side points backwards to final point.
+		path_points.resize(start_join + 1);
+		for (int j = goal_join; j >= 0; --j) {
+			debug_line(DEBUG_DRAW_SEARCH, path_points.back(), goal_points[j], color_green, true);
+			path_points.push_back(goal_points[j]);
+		}
+
+		goal_points.clear();
+		search->found_path = true;
+		return true;
+	}
+
+	void search_bidirectional(Path_Search *search, const Collision_Query &collision, const Path_Search_Config &config, Vec3 start_point, Vec3 final_point) {
+		trace_scope("search_bidirectional");
+
+		// We grow path from bot and from final point, one point per frame, and join them when newest point
+		// of one side can see a point of the other side. In corridors and mazes one side usually sees through
+		// what the other side would need many 360 degree sweeps for.
+		if (search->goal_points.size() == 0) {
+			search->goal_points.push_back(final_point);
+		}
+
+		// Joining ran out of traces, it continues next step before anything else.
+		if (join_search_sides(search, collision, config) || search->join_next_index >= 0) {
+			return;
+		}
+
+		// Side that failed rotation search in both directions is not grown anymore.
+		bool start_side_alive 	= search->failed_to_search_in_some_direction < 2;
+		bool goal_side_alive 	= search->failed_to_search_from_goal < 2;
+		if (!start_side_alive && !goal_side_alive) {
+			return;
+		}
+
+		// Paused sweep is finished first, otherwise sides would take turns restarting it.
+		bool grow_from_goal;
+		if (search->sweep.active) {
+			grow_from_goal = search->sweep.from_goal;
+		} else {
+			grow_from_goal = (search->grow_from_goal_next && goal_side_alive) || !start_side_alive;
+			search->grow_from_goal_next = !grow_from_goal;
+		}
+
+		Vec3 from 	= grow_from_goal ? search->goal_points.back() : start_point;
+		Vec3 to 	= grow_from_goal ? start_point : search->goal_points.back();
+			 to.z 	= from.z;
+
+		Vec3 	from_to 	= to - from;
+		float 	distance 	= vec3_length_2d(from_to);
+
+		Vec3 path_point;
+		if (!find_path_point(search, collision, config, from, from_to, distance, false, grow_from_goal, &path_point)) {
+			return;
+		}
+
+		set_path_point(search, config, from, path_point);
+
+		if (grow_from_goal) {
+			// set_path_point() adds to bot's side, move it to our side.
+			search->path_points.pop_back();
+			search->goal_points.push_back(path_point);
+			search->goal_tip_is_new = true;
+		} else {
+			search->start_tip_is_new = true;
+		}
+	}
+
+	bool search_layers(Path_Search *search, const Path_Search_Config &config, Vec3 start_point, Vec3 final_point, bool only_with_jumps) {
+		trace_scope("search_layers");
+
+		if (!config.layers || !config.layers->built) {
+			return false;
+		}
+
+		// Layers work with feet positions, path points are at collision center.
+		Vec3 feet_offset(0, 0, config.collision_height);
+
+		std::vector<Vec3> 		layer_points;
+		std::vector<Nav_Link> 	layer_links;
+		const uint8_t *blocked = config.surface_blocked ? config.surface_blocked->data() : nullptr;
+		if (!nav_layers_find_path(*config.layers, start_point - feet_offset, final_point - feet_offset, &layer_points, &layer_links, blocked)) {
+			return false;
+		}
+
+		if (only_with_jumps) {
+			bool has_jump = false;
+			for (const Nav_Link &link : layer_links) {
+				has_jump |= link.type == NAV_LINK_JUMP;
+			}
+
+			if (!has_jump) {
+				return false;
+			}
+		}
+
+		// First layer point is our start point, it is already in path points.
+		Vec3 last_point = start_point;
+		for (size_t i = 1; i < layer_points.size(); ++i) {
+			Vec3 path_point = layer_points[i] + feet_offset;
+			set_path_point(search, config, last_point, path_point);
+			last_point = path_point;
+
+			if (layer_links[i].type == NAV_LINK_JUMP) {
+				Path_Jump path_jump;
+				path_jump.path_point_index 	= search->path_points.size() - 1;
+				path_jump.hold_time 		= layer_links[i].jump_hold_time;
+				search->jumps.push_back(path_jump);
+			}
+		}
+
+		search->found_path = true;
+		return true;
+	}
+}
+
+void path_search_reset(Path_Search *search) {
+	*search = Path_Search();
+}
+
+void path_search_finish(Path_Search *search) {
+	int failed_to_search_in_some_direction 	= search->failed_to_search_in_some_direction;
+	int failed_to_search_from_goal 			= search->failed_to_search_from_goal;
+
+	// @note: If level changes dynamically we do not want to save found path.
+	path_search_reset(search);
+
+	search->failed_to_search_in_some_direction 	= failed_to_search_in_some_direction;
+	search->failed_to_search_from_goal 			= failed_to_search_from_goal;
+}
+
+void path_search_begin(Path_Search *search, Vec3 start_position) {
+	search->path_points.clear();
+	search->path_points.push_back(start_position);
+
+	search->counters 			= Search_Counters();
+	search->counters_recorded 	= false;
+	search->sweep 				= Path_Sweep();
+	search->join_next_index 	= -1;
+	search->layers_failed 		= false;
+	search->jump_layers_failed 	= false;
+}
+
+namespace {
+	// Single step of the search, path_search_step() below measures it.
+	void path_search_think(Path_Search *search, const Collision_Query &collision, const Path_Search_Config &config, Vec3 current_final_point) {
+		// @todo: What should we do, when we set last path point and we found the finish point?
+		// Right now, we could find finish point, but if we found it at awkward angle, we can't
+		// go to it, because we will not have enough space.
+
+		// @todo: What about dead ends? We need to save them and start to search from first bot position
+		// before dead end?
+		// Or should we continue searching from dead end?
+
+		// @todo: What if we found finish point, but can't actually go to it?
+		// Mark this area unreachable and search the other way? Define "mark this area", haha.
+
+		// @todo: Bot will fall, because I don't check ground. This problem is for search_height()?
+
+		// @todo: Consider using capsule collision for bot, instead of cuboid.
+
+		// @note: Right now the farther away the bot is (or point) from finish,
+		// the less accurate the rays are.
+
+		// @note: Raycasts and time it took to find final_point are counted in search->counters,
+		// give config stats to get histograms per bot (see search_stats.h).
+
+		// @note: Rotation search stops at search->trace_limit, saves current turn degrees in search->sweep
+		// and continues from them on next step, so one search doesn't eat the whole frame.
+
+		// @todo: If we are not that far away from final_point and we need to pass one last wall,
+		// we can choose for bot to decide, if he will go into different direction.
+		// For example: We're searching right. final_point is near, but still behind the wall.
+		// 				Start searching left from last path_point.
+
+		// @todo: We can make two arrays of path points.
+		// One will contain newly found path.
+		// Second will contain the same path, but with reduced points. It will be a shorter path.
+		// To find shorter path, I can iterate between n and n+2, if theres no obstacles,
+		// I can remove n+1 and shift n+2 to the place of n+1.
+		// Of course I can compare n with n+(2+x) to find the shortest path, but this
+		// probably will be expansive.
+
+		// @todo: If I set final point as something that is within collision, like
+		// player position, this code will work wrong, because it will consider player collision
+		// as wall, which we are not. If you want to make proper "follow me" feature,
+		// I think you need to ignore player collision in search raycasts.
+
+		// If it's the first time we are searching the path, start position is bot's position.
+		// If not, start from last point we found.
+		Vec3 start_point = search->path_points.back();
+
+		// Rotation search below only works in XY plane. If objective is on another floor,
+		// plan over navigation layers instead, they know about stairs, ramps and floors.
+		if (search->path_points.size() == 1 && config.layers && !search->layers_failed
+			&& std::fabs(current_final_point.z - start_point.z) > config.layers->agent.max_step_height) {
+			if (search_layers(search, config, start_point, current_final_point, false)) {
+				return;
+			}
+			search->layers_failed = true;
+		}
+
+		// @note: What will happen if final point will change mid path finding?
+		Vec3 	final_point 			= current_final_point;
+				final_point.z 			= start_point.z;
+		Vec3 	start_to_final 			= final_point - start_point;
+		float 	start_to_final_distance = vec3_length_2d(start_to_final);
+
+		// Raycast from start to final point.
+		Collision_Hit hit_main;
+		++search->counters.traces;
+
+		// If we found obstacle between start and final_point, search where to go.
+		if (collision.ray(start_point, final_point, &hit_main)) {
+			// Rotation search can't jump. If layers know a jump over this obstacle, take it.
+			if (search->path_points.size() == 1 && !search->jump_layers_failed) {
+				if (search_layers(search, config, start_point, current_final_point, true)) {
+					return;
+				}
+				search->jump_layers_failed = true;
+			}
+
+			if (config.bidirectional) {
+				search_bidirectional(search, collision, config, start_point, final_point);
+				return;
+			}
+
+			Vec3 path_point;
+			if (find_path_point(search, collision, config, start_point, start_to_final, start_to_final_distance, false, false, &path_point)) {
+				set_path_point(search, config, start_point, path_point);
+			}
+			return;
+		}
+
+		// No obstacles found and we are "looking" straight at final_point.
+		// We didn't actually found path, we just found (saw) final point.
+		// We will do extra logic to know that we can actually reach final point and
+		// declare that we found path.
+		// We need to perform last check to see if bot can actually reach final_point
+		// using two raycasts from cuboid collision of bot.
+		Vec3 last_point 	= start_point;
+		Vec3 last_to_final 	= final_point - last_point;
+
+		// Find angle between last path point and final_point and cosine vector on trigonometric circle for
+		// two raycasts from cuboid collision of bot.
+		float last_to_final_angle = angle_on_circle(vec3_normalize_2d(last_to_final));
+
+		// Find front corners of cuboid bot collision (front is looking at final_point direction from new extra path_point).
+		// We use this to know that we could actually reach final_point.
+		float length_of_hypotenuse_from_center_of_bot_collision = std::sqrt(2.0f) * config.collision_size;
+
+		// Minus degrees on trig circle is left for Unreal top-down view, plus is right.
+		Vec3 front_left_corner 	= last_point + vector_on_circle(last_to_final_angle - search_pi / 4) * length_of_hypotenuse_from_center_of_bot_collision;
+		Vec3 front_right_corner = last_point + vector_on_circle(last_to_final_angle + search_pi / 4) * length_of_hypotenuse_from_center_of_bot_collision;
+
+		// Find vector for side shifting in corner trace cycle.
+		// If we are serching right side, shift will be to the right relative to the final_point.
+		// And vice versa.
+		float side_shift_angle = search->from_start.search_right ? last_to_final_angle + search_pi / 2 : last_to_final_angle - search_pi / 2;
+
+		// We will shift by 1.5 of whole cuboid collision.
+		Vec3 side_shift_vector = vector_on_circle(side_shift_angle) * (config.collision_size * 3);
+
+		// Corner trace cycle. Find if we can actually reach final_point.
+		// If not, shift number of times and if we can actually reach final_point,
+		// set new path_point. If shifting was not successful,
+		// do not set new path_point and just leave.
+		Vec3 	new_path_point 	= last_point;
+		Vec3 	new_to_final 	= last_to_final;
+		bool 	made_side_shift = false;
+		bool 	path_is_clear 	= false;
+
+		// @todo: Raycast to the side to see that we can actually side shift.
+		for (int i = 1; i <= config.times_to_shift_to_the_side + 1; ++i) {
+			if (i > 1) {
+				front_left_corner 	+= side_shift_vector;
+				front_right_corner 	+= side_shift_vector;
+				new_path_point 		+= side_shift_vector;
+				new_to_final 		= final_point - new_path_point;
+			}
+
+			// Raycast from left and right side of cuboid collision straight at final point direction.
+			// @note: If it's first iteration new_to_final is just last_to_final.
+			Collision_Hit hit_left;
+			Collision_Hit hit_right;
+			bool got_hit_left 	= collision.ray(front_left_corner, front_left_corner + new_to_final, &hit_left);
+			bool got_hit_right 	= collision.ray(front_right_corner, front_right_corner + new_to_final, &hit_right);
+			search->counters.traces += 2;
+
+			// If traces weren't colliding with anything, path is clear.
+			if (!got_hit_left && !got_hit_right) {
+				made_side_shift = i > 1;
+				path_is_clear 	= true;
+				break;
+			}
+		}
+
+		// We need to set new path point and rewrite start point if we made a shift.
+		if (made_side_shift) {
+			++search->counters.side_shifts;
+			set_path_point(search, config, start_point, new_path_point);
+			start_point = new_path_point;
+		}
+
+		// If both rays didn't hit anything - we have finally found the path!
+		if (path_is_clear) {
+			search->found_path = true;
+
+			// Put final point at the end of array to use it for movement logic.
+			search->path_points.push_back(final_point);
+
+			// Draw line from last path_point to final_point to indicate that we can reach final_point.
+			debug_line(DEBUG_DRAW_SEARCH, start_point, final_point, color_green, true);
+		} else {
+			// Draw line from last path_point to final_point to indicate that we saw final_point,
+			// but we can't reach.
+			debug_line(DEBUG_DRAW_SEARCH, start_point, final_point, color_red, true);
+
+			// We got some obstacles, find new point with found_final_point exception
+			// and on to the next frame.
+			Vec3 path_point;
+			if (find_path_point(search, collision, config, start_point, start_to_final, start_to_final_distance, true, false, &path_point)) {
+				set_path_point(search, config, start_point, path_point);
+			}
+		}
+	}
+}
+
+void path_search_step(Path_Search *search, const Collision_Query &collision, const Path_Search_Config &config, Vec3 final_point) {
+	trace_scope("path_search_step");
+
+	if (search->found_path || search->path_points.size() == 0) {
+		return;
+	}
+
+	std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+	path_search_think(search, collision, config, final_point);
+
+	++search->counters.steps;
+	search->counters.microseconds += microseconds_since(start_time);
+
+	// Search is over when path is found or when we gave up, record it once.
+	if (config.stats && !search->counters_recorded && (search->found_path || path_search_failed(*search, config))) {
+		search->counters_recorded = true;
+		search_stats_add_search(config.stats, search->counters, search->found_path);
+	}
+}
+
+uint32_t path_search_step_trace_bound(const Path_Search_Config &config) {
+	// Main ray to final point and side shift rays from both corners. Joining and rotation search pause by themselves.
+	return 1 + 2 * (uint32_t)std::max(config.times_to_shift_to_the_side + 1, 0);
+}
+
+bool path_search_paused(const Path_Search &search) {
+	return search.sweep.active || search.join_next_index >= 0;
+}
+
+bool path_search_failed(const Path_Search &search, const Path_Search_Config &config) {
+	// In bidirectional search other side can still find us, so we wait until both sides give up.
+	bool start_side_failed 	= search.failed_to_search_in_some_direction >= 2;
+	bool goal_side_failed 	= search.failed_to_search_from_goal >= 2;
+	return start_side_failed && (!config.bidirectional || goal_side_failed);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+// Bot path search (rotation search), written against Collision_Query, so it runs the same in game
+// and in headless tools. A_Bot owns one Path_Search and calls path_search_step() every time it thinks.
+//
+// Search works in XY plane: from the last path point we cast a fan of rays towards final point,
+// rotating one degree at a time, and put next path point in the middle of first opening that is wide enough.
+// Bidirectional mode grows path from final point too and joins the sides when they can see each other.
+// If navigation layers are given, search uses them for other floors and for jumps.
+// Debug lines go through debug_draw.h, fan rays are DEBUG_DRAW_SEARCH_FAN.
+
+#include "cd_math.h"
+#include "collision_query.h"
+#include "nav_layers.h"
+#include "search_stats.h"
+
+#include <stdint.h>
+#include <vector>
+
+// Path point that bot needs to jump to, filled from navigation layer jump links.
+struct Path_Jump {
+	int 	path_point_index 	= 0;
+	float 	hold_time 			= 0;
+};
+
+// Every side remembers in what direction it rotates.
+struct Path_Search_Side {
+	bool search_right 				= false;
+	bool direction_was_randomized 	= false;
+};
+
+struct Path_Search_Config {
+	float 	collision_size 				= 20.0f; // Half of bot collision width.
+	float 	collision_height 			= 92.0f; // Half of bot collision height.
+	int 	maximum_to_rotate 			= 360; 	 // In degrees, we rotate by one degree.
+	int 	times_to_shift_to_the_side 	= 1;
+	int 	fan_batch_size 				= 1; 	 // Rays per ray_batch() in rotation search, up to 64. One means plain ray() calls.
+	bool 	bidirectional 				= false; // Costs more traces per path on every benchmark layout, see path_search_benchmark.cpp.
+
+	const Nav_Layer_Grid 		*layers 			= nullptr; // Optional.
+	const std::vector<uint8_t> 	*surface_blocked 	= nullptr; // Optional, used instead of layers->surface_blocked, see nav_layers_publish_blocked().
+
+	// Everything engine specific goes through callbacks with this user pointer.
+	void *user = nullptr;
+
+	// Returns random number from min to max inclusive, used to choose search direction.
+	// Planner gives every search its own seeded generator, so runs can be repeated.
+	int (*random_range)(void *user, int min, int max) = nullptr;
+
+	// Optional, where find_path_point() calls and finished searches are recorded.
+	Search_Stats *stats = nullptr;
+
+	// Optional, find_path_point() calls are also kept here, for whoever records them into stats later on another thread.
+	std::vector<Find_Path_Point_Sample> *samples = nullptr;
+};
+
+// Rotation search that ran out of traces (Path_Search::trace_limit) in the middle, it continues from here on next step.
+struct Path_Sweep {
+	bool 	active 						= false;
+	bool 	from_goal 					= false;
+	bool 	found_final_point 			= false;
+	Vec3 	start_point;
+	int 	next_index 					= 0; // Degrees already rotated.
+	float 	last_hit_distance 			= 0;
+	int 	success_traces_count 		= 0;
+	Vec3 	first_success_trace_vector;
+};
+
+struct Path_Search {
+	// Zero is where bot started, last one is final point when path is found.
+	std::vector<Vec3> 		path_points;
+	std::vector<Path_Jump> 	jumps;
+
+	// Points found by searching from final point towards bot. Zero is final point.
+	std::vector<Vec3> 		goal_points;
+
+	Path_Search_Side from_start;
+	Path_Search_Side from_goal;
+
+	bool found_path 			= false;
+	bool grow_from_goal_next 	= false;
+	bool start_tip_is_new 		= true; // Newest point on each side still needs to be checked against the other side.
+	bool goal_tip_is_new 		= true;
+
+	// How many times rotation search went full circle without finding anything.
+	int failed_to_search_in_some_direction 	= 0;
+	int failed_to_search_from_goal 			= 0; // Same, but for bidirectional search from final point.
+
+	// What this search cost so far. Reset by path_search_begin().
+	Search_Counters counters;
+	bool 			counters_recorded = false; // Search was already added to stats.
+
+	// Rotation search and joining sides pause when counters.traces reaches this, so whoever steps the search can give it
+	// only part of the frame (see path_planner.h). Everything else in a step is a few rays and isn't paused.
+	uint32_t 	trace_limit 	= UINT32_MAX;
+	Path_Sweep 	sweep;
+	int 		join_next_index = -1; // Joining sides paused here, see join_search_sides().
+
+	// Path over navigation layers (A* over the whole grid) is tried once per search, from bot position.
+	// Start side can stay at one point for many steps, so we remember it didn't work instead of trying every step.
+	bool layers_failed 		= false; // To another floor.
+	bool jump_layers_failed = false; // Over obstacle with a jump.
+};
+
+// Forgets everything, including failures.
+void path_search_reset(Path_Search *search);
+
+// Forgets found path after bot walked it, but keeps failure counters.
+void path_search_finish(Path_Search *search);
+
+// Starts new path from bot position.
+void path_search_begin(Path_Search *search, Vec3 start_position);
+
+// Finds one more path point (or the whole path if layers or straight line can do it).
+// Call it until found_path is true or path_search_failed() says we should give up.
+// If path_search_paused() is true after the call, step ran out of trace_limit and will continue where it stopped.
+void path_search_step(Path_Search *search, const Collision_Query &collision, const Path_Search_Config &config, Vec3 final_point);
+
+// Most traces next step can use besides what pauses at trace_limit by itself.
+uint32_t path_search_step_trace_bound(const Path_Search_Config &config);
+
+bool path_search_paused(const Path_Search &search);
+
+// True if rotation search failed in both directions (on both sides in bidirectional mode).
+bool path_search_failed(const Path_Search &search, const Path_Search_Config &config);
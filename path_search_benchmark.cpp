@@ -0,0 +1,638 @@
+// Headless benchmark for bot path search.
+// Runs path_search_step() (same code A_Bot::search_rotation() calls) on a set of scenario levels
+// until path is found or search gives up, and reports per scenario:
+// 	- failure rate (search gave up or took too many steps),
+// 	- steps (bot thinks) and traces per path,
+// 	- microseconds per path,
+// 	- path length against (almost) optimal path from a grid planner,
+// 	- path segments bot collision can't actually walk.
+//
+// Direction choice uses seeded generator instead of FMath::RandRange, so two runs with the same seed trace the same rays.
+//
+// Build (no Unreal needed):
+// 	g++ -O2 -std=c++17 -I. path_search_benchmark.cpp path_search.cpp search_stats.cpp debug_draw.cpp trace_recorder.cpp worker_pool.cpp path_planner.cpp query_budget.cpp headless_world.cpp headless_bvh.cpp nav_layers.cpp -pthread -o path_search_benchmark
+//
+// Usage:
+// 	path_search_benchmark [--runs N] [--seed N] [--fan-batch N] [--bidirectional] [--level file.level ...] [--save-levels dir] [--csv file] [--trace file.json] [--threads N] [--budget traces]
+// Extra levels need points named "start" and "goal".
+
+#include "headless_world.h"
+#include "headless_bvh.h"
+#include "path_search.h"
+#include "debug_draw.h"
+#include "trace_recorder.h"
+#include "path_planner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+	// Same as A_Bot.
+	float 	collision_size 		= 20.0f;
+	float 	collision_height 	= 92.0f;
+	int 	max_steps_per_path 	= 1000; // One step is one bot think, at 60 fps this is more than 16 seconds.
+
+	float 	wall_height 		= 300.0f;
+	float 	wall_thickness 		= 20.0f;
+
+	struct Scenario {
+		std::string 	name;
+		Headless_World 	world;
+	};
+
+	struct Scenario_Result {
+		int 	runs 				= 0;
+		int 	failures 			= 0;
+		double 	steps 				= 0;
+		double 	traces 				= 0;
+		double 	microseconds 		= 0;
+		double 	length_ratio 		= 0;
+		int 	length_ratio_count 	= 0;
+		int 	clipped_segments 	= 0;
+		float 	optimal_length 		= -1;
+	};
+
+	// Counts everything search asks from collision.
+	class Counting_Collision : public Collision_Query {
+	public:
+		const Collision_Query 	*inner 	= nullptr;
+		mutable uint64_t 		traces 	= 0;
+
+		virtual bool ray(Vec3 from, Vec3 to, Collision_Hit *out_hit) const override {
+			++traces;
+			return inner->ray(from, to, out_hit);
+		}
+
+		virtual void ray_batch(const Collision_Ray *rays, int count, Collision_Hit *out_hits) const override {
+			traces += count;
+			inner->ray_batch(rays, count, out_hits);
+		}
+
+		virtual bool box_sweep(Vec3 from, Vec3 to, Vec3 half_extents, Collision_Hit *out_hit) const override {
+			++traces;
+			return inner->box_sweep(from, to, half_extents, out_hit);
+		}
+	};
+
+	std::mt19937 generator;
+
+	int random_range(void *, int min, int max) {
+		return std::uniform_int_distribution<int>(min, max)(generator);
+	}
+
+	//
+	// Scenario levels.
+	//
+
+	void add_floor(Headless_World *world, float half_size) {
+		world->add_box(Vec3(0, 0, -10), Vec3(half_size, half_size, 10));
+	}
+
+	// Wall from a to b on the floor, a and b are XY.
+	void add_wall(Headless_World *world, float ax, float ay, float bx, float by) {
+		Vec3 center((ax + bx) / 2, (ay + by) / 2, wall_height / 2);
+		Vec3 half_extents(std::fabs(bx - ax) / 2 + wall_thickness / 2, std::fabs(by - ay) / 2 + wall_thickness / 2, wall_height / 2);
+		world->add_box(center, half_extents);
+	}
+
+	void add_start_and_goal(Headless_World *world, float start_x, float start_y, float goal_x, float goal_y) {
+		world->add_point("start", Vec3(start_x, start_y, collision_height));
+		world->add_point("goal", Vec3(goal_x, goal_y, collision_height));
+	}
+
+	void make_open_field(Scenario *scenario) {
+		scenario->name = "open_field";
+		add_floor(&scenario->world, 4000);
+
+		// Few pillars, so it's not only one ray.
+		std::mt19937 level_generator(1);
+		std::uniform_real_distribution<float> position(-2500, 2500);
+		for (int i = 0; i < 12; ++i) {
+			scenario->world.add_oriented_box(Vec3(position(level_generator), position(level_generator), wall_height / 2), Vec3(60, 60, wall_height / 2), (float)(i * 15), 0, 0);
+		}
+
+		add_start_and_goal(&scenario->world, -3500, -300, 3500, 300);
+	}
+
+	// Bot stands inside U and goal is behind its bottom, so straight line search runs into dead end.
+	void make_u_trap(Scenario *scenario) {
+		scenario->name = "u_trap";
+		add_floor(&scenario->world, 4000);
+
+		add_wall(&scenario->world, 600, -900, 600, 900);
+		add_wall(&scenario->world, -600, -900, 600, -900);
+		add_wall(&scenario->world, -600, 900, 600, 900);
+
+		add_start_and_goal(&scenario->world, 0, 0, 2500, 0);
+	}
+
+	void make_maze(Scenario *scenario) {
+		scenario->name = "maze";
+
+		int 	cells 		= 8;
+		float 	cell_size 	= 400.0f;
+		float 	half_size 	= cells * cell_size / 2;
+		add_floor(&scenario->world, half_size + 500);
+
+		// Recursive backtracker with fixed seed, so maze is always the same.
+		std::vector<bool> 	visited(cells * cells, false);
+		std::vector<bool> 	east_wall(cells * cells, true);
+		std::vector<bool> 	north_wall(cells * cells, true);
+		std::vector<int> 	stack;
+		std::mt19937 		level_generator(12345);
+
+		stack.push_back(0);
+		visited[0] = true;
+		while (!stack.empty()) {
+			int cell 	= stack.back();
+			int x 		= cell % cells;
+			int y 		= cell / cells;
+
+			int neighbours[4];
+			int neighbour_count = 0;
+			if (x > 0 && !visited[cell - 1]) 			neighbours[neighbour_count++] = cell - 1;
+			if (x < cells - 1 && !visited[cell + 1]) 	neighbours[neighbour_count++] = cell + 1;
+			if (y > 0 && !visited[cell - cells]) 		neighbours[neighbour_count++] = cell - cells;
+			if (y < cells - 1 && !visited[cell + cells]) neighbours[neighbour_count++] = cell + cells;
+
+			if (neighbour_count == 0) {
+				stack.pop_back();
+				continue;
+			}
+
+			int next = neighbours[std::uniform_int_distribution<int>(0, neighbour_count - 1)(level_generator)];
+			if (next == cell + 1) 		east_wall[cell] = false;
+			if (next == cell - 1) 		east_wall[next] = false;
+			if (next == cell + cells) 	north_wall[cell] = false;
+			if (next == cell - cells) 	north_wall[next] = false;
+
+			visited[next] = true;
+			stack.push_back(next);
+		}
+
+		// Outer walls.
+		add_wall(&scenario->world, -half_size, -half_size, half_size, -half_size);
+		add_wall(&scenario->world, -half_size, -half_size, -half_size, half_size);
+
+		for (int y = 0; y < cells; ++y) {
+			for (int x = 0; x < cells; ++x) {
+				float min_x = -half_size + x * cell_size;
+				float min_y = -half_size + y * cell_size;
+				if (east_wall[y * cells + x]) {
+					add_wall(&scenario->world, min_x + cell_size, min_y, min_x + cell_size, min_y + cell_size);
+				}
+				if (north_wall[y * cells + x]) {
+					add_wall(&scenario->world, min_x, min_y + cell_size, min_x + cell_size, min_y + cell_size);
+				}
+			}
+		}
+
+		float first_center = -half_size + cell_size / 2;
+		float last_center 	= half_size - cell_size / 2;
+		add_start_and_goal(&scenario->world, first_center, first_center, last_center, last_center);
+	}
+
+	// Walls across the way with doors not much wider than what search thinks is passable, at different places.
+	void make_narrow_doors(Scenario *scenario) {
+		scenario->name = "narrow_doors";
+		add_floor(&scenario->world, 4000);
+
+		float door_width 	= 160.0f;
+		float half_length 	= 1500.0f;
+		float door_offsets[4] = {-900, 700, -200, 1100};
+
+		for (int i = 0; i < 4; ++i) {
+			float x 	= -1500.0f + i * 1000.0f;
+			float door 	= door_offsets[i];
+			add_wall(&scenario->world, x, -half_length, x, door - door_width / 2);
+			add_wall(&scenario->world, x, door + door_width / 2, x, half_length);
+		}
+
+		// Side walls, so we can't just walk around.
+		add_wall(&scenario->world, -1500, -half_length, 1500, -half_length);
+		add_wall(&scenario->world, -1500, half_length, 1500, half_length);
+
+		add_start_and_goal(&scenario->world, -2500, 0, 2500, 0);
+	}
+
+	// One kilometer of city blocks.
+	void make_km_scale(Scenario *scenario) {
+		scenario->name = "km_scale";
+		add_floor(&scenario->world, 55000);
+
+		std::mt19937 level_generator(777);
+		std::uniform_real_distribution<float> jitter(-400, 400);
+		std::uniform_real_distribution<float> size(500, 1500);
+		std::uniform_real_distribution<float> yaw(0, 90);
+
+		float block = 5000.0f;
+		for (float y = -45000; y <= 45000; y += block) {
+			for (float x = -45000; x <= 45000; x += block) {
+				// Leave start and goal free.
+				if (std::fabs(y) < block / 2 && std::fabs(x) > 40000) {
+					continue;
+				}
+
+				Vec3 center(x + jitter(level_generator), y + jitter(level_generator), 1000);
+				scenario->world.add_oriented_box(center, Vec3(size(level_generator), size(level_generator), 1000), yaw(level_generator), 0, 0);
+			}
+		}
+
+		add_start_and_goal(&scenario->world, -47000, 0, 47000, 0);
+	}
+
+	//
+	// Reference path: A* on a grid of cells where bot collision fits, then pulled tight with sweeps.
+	//
+
+	struct Grid_Node {
+		float 	cost;
+		int 	cell;
+
+		bool operator<(const Grid_Node &other) const {
+			return cost > other.cost;
+		}
+	};
+
+	float path_length(const std::vector<Vec3> &points) {
+		float length = 0;
+		for (size_t i = 0; i + 1 < points.size(); ++i) {
+			length += vec3_distance_2d(points[i], points[i + 1]);
+		}
+		return length;
+	}
+
+	Vec3 agent_half_extents(float shrink) {
+		// Lifted a little, so standing on the floor is not overlapping it.
+		return Vec3(collision_size * shrink, collision_size * shrink, collision_height - 10.0f);
+	}
+
+	bool can_sweep(const Collision_Query &collision, Vec3 from, Vec3 to, float shrink) {
+		Collision_Hit hit;
+		return !collision.box_sweep(from, to, agent_half_extents(shrink), &hit);
+	}
+
+	float optimal_path_length(const Headless_World &world, const Collision_Query &collision, Vec3 start, Vec3 goal) {
+		Box3 	bounds 		= world.bounds();
+		float 	extent 		= std::fmax(bounds.max.x - bounds.min.x, bounds.max.y - bounds.min.y);
+		float 	cell_size 	= std::fmax(10.0f, extent / 1000.0f);
+		int 	size_x 		= (int)((bounds.max.x - bounds.min.x) / cell_size) + 1;
+		int 	size_y 		= (int)((bounds.max.y - bounds.min.y) / cell_size) + 1;
+
+		std::vector<bool> free(size_x * size_y);
+		for (int y = 0; y < size_y; ++y) {
+			for (int x = 0; x < size_x; ++x) {
+				Vec3 center(bounds.min.x + (x + 0.5f) * cell_size, bounds.min.y + (y + 0.5f) * cell_size, start.z);
+				free[y * size_x + x] = can_sweep(collision, center, center, 1.0f);
+			}
+		}
+
+		int start_x = (int)((start.x - bounds.min.x) / cell_size), start_y = (int)((start.y - bounds.min.y) / cell_size);
+		int goal_x 	= (int)((goal.x - bounds.min.x) / cell_size), 	goal_y 	= (int)((goal.y - bounds.min.y) / cell_size);
+		int start_cell 	= start_y * size_x + start_x;
+		int goal_cell 	= goal_y * size_x + goal_x;
+		if (!free[start_cell] || !free[goal_cell]) {
+			return -1;
+		}
+
+		std::vector<float> 	cost(size_x * size_y, 1.e30f);
+		std::vector<int> 	came_from(size_x * size_y, -1);
+		std::priority_queue<Grid_Node> open;
+		cost[start_cell] = 0;
+		open.push(Grid_Node{0, start_cell});
+
+		while (!open.empty()) {
+			Grid_Node node = open.top();
+			open.pop();
+			if (node.cell == goal_cell) {
+				break;
+			}
+
+			int x = node.cell % size_x;
+			int y = node.cell / size_x;
+			for (int dy = -1; dy <= 1; ++dy) {
+				for (int dx = -1; dx <= 1; ++dx) {
+					int nx = x + dx, ny = y + dy;
+					if ((dx == 0 && dy == 0) || nx < 0 || ny < 0 || nx >= size_x || ny >= size_y || !free[ny * size_x + nx]) {
+						continue;
+					}
+
+					// No corner cutting.
+					if (dx != 0 && dy != 0 && (!free[y * size_x + nx] || !free[ny * size_x + x])) {
+						continue;
+					}
+
+					int 	neighbour 	= ny * size_x + nx;
+					float 	new_cost 	= cost[node.cell] + ((dx != 0 && dy != 0) ? 1.41421356f : 1.0f) * cell_size;
+					if (new_cost < cost[neighbour]) {
+						cost[neighbour] 		= new_cost;
+						came_from[neighbour] 	= node.cell;
+
+						float hx = (float)std::abs(goal_x - nx), hy = (float)std::abs(goal_y - ny);
+						float heuristic = (std::fmax(hx, hy) + 0.41421356f * std::fmin(hx, hy)) * cell_size;
+						open.push(Grid_Node{new_cost + heuristic, neighbour});
+					}
+				}
+			}
+		}
+
+		if (came_from[goal_cell] < 0 && goal_cell != start_cell) {
+			return -1;
+		}
+
+		std::vector<Vec3> cells;
+		cells.push_back(goal);
+		for (int cell = came_from[goal_cell]; cell >= 0 && cell != start_cell; cell = came_from[cell]) {
+			cells.push_back(Vec3(bounds.min.x + (cell % size_x + 0.5f) * cell_size, bounds.min.y + (cell / size_x + 0.5f) * cell_size, start.z));
+		}
+		cells.push_back(start);
+		std::reverse(cells.begin(), cells.end());
+
+		// Pull the path tight: from every point go to the farthest point we can sweep to.
+		std::vector<Vec3> 	pulled;
+		size_t 				current = 0;
+		pulled.push_back(cells[0]);
+		while (current + 1 < cells.size()) {
+			size_t next = cells.size() - 1;
+			while (next > current + 1 && !can_sweep(collision, cells[current], cells[next], 0.9f)) {
+				--next;
+			}
+			pulled.push_back(cells[next]);
+			current = next;
+		}
+
+		return path_length(pulled);
+	}
+
+	//
+	// Running.
+	//
+
+	void run_scenario(const Scenario &scenario, const Path_Search_Config &base_config, int runs, unsigned seed, Scenario_Result *result) {
+		Vec3 start, goal;
+		if (!scenario.world.find_point("start", &start) || !scenario.world.find_point("goal", &goal)) {
+			printf("%s: level needs \"start\" and \"goal\" points, skipped.\n", scenario.name.c_str());
+			return;
+		}
+
+		Headless_Bvh bvh;
+		bvh.build(&scenario.world);
+
+		Counting_Collision counting;
+		counting.inner = &bvh;
+
+		result->optimal_length = optimal_path_length(scenario.world, bvh, start, goal);
+
+		Path_Search_Config config = base_config;
+		config.random_range = random_range;
+
+		for (int run = 0; run < runs; ++run) {
+			generator.seed(seed + run);
+			counting.traces = 0;
+
+			Path_Search search;
+			int 		steps = 0;
+
+			std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+			path_search_begin(&search, start);
+			while (!search.found_path && !path_search_failed(search, config) && steps < max_steps_per_path) {
+				path_search_step(&search, counting, config, goal);
+				++steps;
+			}
+
+			std::chrono::steady_clock::time_point end_time = std::chrono::steady_clock::now();
+
+			++result->runs;
+			result->steps 			+= steps;
+			result->traces 			+= (double)counting.traces;
+			result->microseconds 	+= std::chrono::duration<double, std::micro>(end_time - start_time).count();
+
+			if (!search.found_path) {
+				++result->failures;
+				continue;
+			}
+
+			for (size_t i = 0; i + 1 < search.path_points.size(); ++i) {
+				if (!can_sweep(bvh, search.path_points[i], search.path_points[i + 1], 1.0f)) {
+					++result->clipped_segments;
+				}
+			}
+
+			if (result->optimal_length > 0) {
+				result->length_ratio += path_length(search.path_points) / result->optimal_length;
+				++result->length_ratio_count;
+			}
+		}
+	}
+
+	struct Planner_Result {
+		double 		paths_per_second 		= 0;
+		int 		frames 					= 0; // With budget.
+		uint64_t 	max_traces_per_frame 	= 0;
+	};
+
+	// Same paths through Path_Planner workers, returns paths per second of wall time.
+	// Every run is a separate request with its own seed, like bots asking at the same time.
+	// With budget we play frames: give out the budget, wait for workers, repeat until every path is done.
+	Planner_Result run_scenario_planner(const Scenario &scenario, const Path_Search_Config &base_config, int runs, unsigned seed, int threads, int budget) {
+		Planner_Result planner_result;
+		Vec3 start, goal;
+		if (!scenario.world.find_point("start", &start) || !scenario.world.find_point("goal", &goal)) {
+			return planner_result;
+		}
+
+		Headless_Bvh bvh;
+		bvh.build(&scenario.world);
+
+		Path_Planner planner;
+		planner.config 					= base_config;
+		planner.budget.traces_per_frame = budget;
+		path_planner_start(&planner, threads);
+
+		// Enough requests that every worker has something to steal.
+		int request_count = runs * 8;
+
+		std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+		std::vector<uint64_t> tickets;
+		for (int i = 0; i < request_count; ++i) {
+			Path_Request request;
+			request.start 			= start;
+			request.goal 			= goal;
+			request.half_extents 	= Vec3(collision_size, collision_size, collision_height);
+			request.collision 		= &bvh;
+			request.max_steps 		= max_steps_per_path;
+			request.seed 			= seed + i;
+			request.distance_to_player 	= (float)(i % 10) * 1000.0f;
+			request.visible 			= i % 3 == 0;
+			tickets.push_back(path_planner_submit(&planner, request));
+		}
+
+		Path_Result result;
+		size_t 		taken = 0;
+		while (taken < tickets.size()) {
+			uint64_t traces_before = planner.traces_used.load();
+			if (budget > 0) {
+				path_planner_begin_frame(&planner);
+				++planner_result.frames;
+			}
+			path_planner_wait(&planner);
+			planner_result.max_traces_per_frame = std::max(planner_result.max_traces_per_frame, planner.traces_used.load() - traces_before);
+
+			for (uint64_t &ticket : tickets) {
+				if (ticket != 0 && path_planner_take(&planner, ticket, &result)) {
+					ticket = 0;
+					++taken;
+				}
+			}
+		}
+
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+		path_planner_stop(&planner);
+
+		planner_result.paths_per_second = request_count / seconds;
+		return planner_result;
+	}
+}
+
+int main(int argument_count, char **arguments) {
+	int 		runs 		= 20;
+	unsigned 	seed 		= 1;
+	const char 	*csv_path 	= nullptr;
+	const char 	*save_dir 	= nullptr;
+	const char 	*trace_path = nullptr;
+	int 		max_threads = 0;
+	int 		budget 		= 0;
+
+	// Nobody flushes lines here, and we don't want to time them anyway.
+	debug_draw.enabled_categories = 0;
+
+	Path_Search_Config config;
+	config.collision_size 	= collision_size;
+	config.collision_height = collision_height;
+
+	std::vector<Scenario> scenarios(5);
+	make_open_field(&scenarios[0]);
+	make_u_trap(&scenarios[1]);
+	make_maze(&scenarios[2]);
+	make_narrow_doors(&scenarios[3]);
+	make_km_scale(&scenarios[4]);
+
+	for (int i = 1; i < argument_count; ++i) {
+		bool has_value = i + 1 < argument_count;
+
+		if (!strcmp(arguments[i], "--runs") && has_value) {
+			runs = atoi(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--seed") && has_value) {
+			seed = (unsigned)strtoul(arguments[++i], nullptr, 10);
+		} else if (!strcmp(arguments[i], "--fan-batch") && has_value) {
+			config.fan_batch_size = atoi(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--bidirectional")) {
+			config.bidirectional = true;
+		} else if (!strcmp(arguments[i], "--csv") && has_value) {
+			csv_path = arguments[++i];
+		} else if (!strcmp(arguments[i], "--budget") && has_value) {
+			budget = atoi(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--threads") && has_value) {
+			max_threads = atoi(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--trace") && has_value) {
+			trace_path = arguments[++i];
+		} else if (!strcmp(arguments[i], "--save-levels") && has_value) {
+			save_dir = arguments[++i];
+		} else if (!strcmp(arguments[i], "--level") && has_value) {
+			Scenario 	scenario;
+			std::string error;
+			scenario.name = arguments[++i];
+			if (!scenario.world.load(scenario.name.c_str(), &error)) {
+				printf("%s\n", error.c_str());
+				return 1;
+			}
+			scenarios.push_back(scenario);
+		} else {
+			printf("Unknown argument: %s\n", arguments[i]);
+			return 1;
+		}
+	}
+
+	if (save_dir) {
+		for (const Scenario &scenario : scenarios) {
+			std::string path = std::string(save_dir) + "/" + scenario.name + ".level";
+			if (!scenario.world.save(path.c_str())) {
+				printf("Can't save %s\n", path.c_str());
+			}
+		}
+	}
+
+	FILE *csv = csv_path ? fopen(csv_path, "w") : nullptr;
+	if (csv) {
+		fprintf(csv, "scenario,runs,failure_rate,steps_per_path,traces_per_path,microseconds_per_path,length_to_optimal,clipped_segments\n");
+	}
+
+	if (trace_path) {
+		trace_recorder_set_thread_name("Benchmark");
+		trace_recorder_start();
+	}
+
+	printf("%-14s %5s %8s %10s %12s %12s %10s %8s\n", "scenario", "runs", "failed", "steps", "traces", "us/path", "length", "clipped");
+	for (const Scenario &scenario : scenarios) {
+		Scenario_Result result;
+		{
+			trace_scope("run_scenario");
+			run_scenario(scenario, config, runs, seed, &result);
+		}
+		if (result.runs == 0) {
+			continue;
+		}
+
+		double failure_rate = (double)result.failures / result.runs;
+		double length_ratio = result.length_ratio_count > 0 ? result.length_ratio / result.length_ratio_count : 0.0;
+
+		printf("%-14s %5d %7.1f%% %10.1f %12.1f %12.1f %9.2fx %8d\n", scenario.name.c_str(), result.runs, failure_rate * 100,
+			result.steps / result.runs, result.traces / result.runs, result.microseconds / result.runs, length_ratio, result.clipped_segments);
+
+		if (csv) {
+			fprintf(csv, "%s,%d,%.4f,%.2f,%.2f,%.2f,%.4f,%d\n", scenario.name.c_str(), result.runs, failure_rate,
+				result.steps / result.runs, result.traces / result.runs, result.microseconds / result.runs, length_ratio, result.clipped_segments);
+		}
+	}
+
+	if (csv) {
+		fclose(csv);
+	}
+
+	if (max_threads > 0) {
+		printf("\n%-14s %7s %12s %8s %8s %16s\n", "scenario", "threads", "paths/s", "speedup", "frames", "max traces/frame");
+		for (const Scenario &scenario : scenarios) {
+			double one_thread_rate = 0;
+			for (int threads = 1; threads <= max_threads; threads *= 2) {
+				Planner_Result planner_result = run_scenario_planner(scenario, config, runs, seed, threads, budget);
+				double rate = planner_result.paths_per_second;
+				if (rate <= 0) {
+					break;
+				}
+				if (threads == 1) {
+					one_thread_rate = rate;
+				}
+				printf("%-14s %7d %12.1f %7.2fx %8d %16llu\n", scenario.name.c_str(), threads, rate, rate / one_thread_rate,
+					planner_result.frames, (unsigned long long)planner_result.max_traces_per_frame);
+			}
+		}
+	}
+
+	if (trace_path) {
+		trace_recorder_stop();
+		if (!trace_recorder_write_chrome_json(trace_path)) {
+			printf("Can't write %s\n", trace_path);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,51 @@
+#include "query_budget.h"
+
+#include <algorithm>
+
+float query_budget_priority(const Query_Budget_Params &params, float distance_to_player, bool visible, float seconds_waiting) {
+	float priority = 1.0f / (1.0f + distance_to_player / params.distance_falloff);
+	if (visible) {
+		priority += params.visible_bonus;
+	}
+	priority += seconds_waiting * params.waiting_weight;
+	return priority;
+}
+
+int query_budget_distribute(const Query_Budget_Params &params, std::vector<Query_Budget_Candidate> *candidates) {
+	std::vector<Query_Budget_Candidate> &list = *candidates;
+	std::stable_sort(list.begin(), list.end(), [](const Query_Budget_Candidate &a, const Query_Budget_Candidate &b) {
+		return a.priority > b.priority;
+	});
+
+	float priority_left = 0;
+	for (const Query_Budget_Candidate &candidate : list) {
+		priority_left += std::max(candidate.priority, 0.0f);
+	}
+
+	int budget_left = params.traces_per_frame;
+	int given 		= 0;
+	for (Query_Budget_Candidate &candidate : list) {
+		// Whoever doesn't fit waits, smaller requests after it can still fit.
+		float priority 	= std::max(candidate.priority, 0.0f);
+		int   minimum 	= std::max(std::max(params.min_share, candidate.min_share), 1);
+		candidate.share = 0;
+		if (budget_left < minimum) {
+			priority_left -= priority;
+			continue;
+		}
+
+		int share = priority_left > 0 ? (int)(budget_left * (priority / priority_left)) : budget_left;
+		share = std::min(std::max(share, minimum), budget_left);
+
+		candidate.share = share;
+		budget_left 	-= share;
+		priority_left 	-= priority;
+		++given;
+	}
+
+	// Those who got a share go first, in priority order, so callers can take the first given ones.
+	std::stable_partition(list.begin(), list.end(), [](const Query_Budget_Candidate &candidate) {
+		return candidate.share > 0;
+	});
+	return given;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// One trace budget per frame for all bots. Every frame bots that wait for a path are ordered by priority
+// (near the player, on screen, waiting long) and each gets a share of the budget, the rest wait for next frame.
+// Share is proportional to priority, but never smaller than min_share, so a share is always worth a step.
+// Waiting time is in priority, so far away bots still get their turn.
+
+#include <vector>
+
+struct Query_Budget_Params {
+	int 	traces_per_frame 	= 0; 		// Zero means no budget.
+	int 	min_share 			= 64;
+	float 	distance_falloff 	= 3000.0f; 	// Priority from distance is halved at this distance.
+	float 	visible_bonus 		= 1.0f;
+	float 	waiting_weight 		= 4.0f; 	// Priority per second of waiting.
+};
+
+struct Query_Budget_Candidate {
+	int 	index 		= 0; // Whatever caller needs to find its request again.
+	float 	priority 	= 0;
+	int 	min_share 	= 0; // If this candidate can't do anything with less than params.min_share.
+	int 	share 		= 0; // Traces for this frame, filled by query_budget_distribute().
+};
+
+float query_budget_priority(const Query_Budget_Params &params, float distance_to_player, bool visible, float seconds_waiting);
+
+// Sorts candidates by priority and fills their shares. Returns how many got a share, they are at the start
+// in priority order, the rest follow. Candidate that doesn't fit is skipped, smaller ones after it still can fit.
+// Sum of shares is never more than traces_per_frame.
+int query_budget_distribute(const Query_Budget_Params &params, std::vector<Query_Budget_Candidate> *candidates);
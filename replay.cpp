@@ -0,0 +1,282 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+Replay replay;
+
+namespace {
+	template <typename T>
+	void put(std::vector<uint8_t> *bytes, T value) {
+		size_t at = bytes->size();
+		bytes->resize(at + sizeof(T));
+		memcpy(bytes->data() + at, &value, sizeof(T));
+	}
+
+	struct Reader {
+		const uint8_t 	*bytes;
+		size_t 			size;
+		size_t 			at = 0;
+
+		template <typename T>
+		bool get(T *value) {
+			if (size - at < sizeof(T)) {
+				return false;
+			}
+			memcpy(value, bytes + at, sizeof(T));
+			at += sizeof(T);
+			return true;
+		}
+	};
+
+	double percentile(const std::vector<double> &sorted, double fraction) {
+		if (sorted.empty()) {
+			return 0;
+		}
+		return sorted[std::min(sorted.size() - 1, (size_t)(fraction * sorted.size()))];
+	}
+}
+
+void replay_recorder_start(Replay_Recorder *recorder, float step_dt, uint64_t start_step, uint64_t seed, uint32_t flags) {
+	*recorder = Replay_Recorder();
+	recorder->recording 		= true;
+	recorder->header.step_dt 	= step_dt;
+	recorder->header.start_step = start_step;
+	recorder->header.seed 		= seed;
+	recorder->header.flags 		= flags;
+	recorder->bytes.reserve(1 << 20);
+}
+
+void replay_record_action(Replay_Recorder *recorder, Replay_Input input, bool pressed) {
+	if (!recorder->recording) {
+		return;
+	}
+	put<uint8_t>(&recorder->bytes, REPLAY_TAG_ACTION);
+	put<uint8_t>(&recorder->bytes, input);
+	put<uint8_t>(&recorder->bytes, pressed ? 1 : 0);
+}
+
+void replay_record_axis(Replay_Recorder *recorder, Replay_Input input, float value) {
+	if (!recorder->recording || value == 0) {
+		return;
+	}
+	put<uint8_t>(&recorder->bytes, REPLAY_TAG_AXIS);
+	put<uint8_t>(&recorder->bytes, input);
+	put<float>(&recorder->bytes, value);
+}
+
+void replay_record_objective(Replay_Recorder *recorder, uint64_t step, uint64_t pawn_id, Vec3 position) {
+	if (!recorder->recording) {
+		return;
+	}
+	put<uint8_t>(&recorder->bytes, REPLAY_TAG_OBJECTIVE);
+	put<uint64_t>(&recorder->bytes, step);
+	put<uint64_t>(&recorder->bytes, pawn_id);
+	put<float>(&recorder->bytes, position.x);
+	put<float>(&recorder->bytes, position.y);
+	put<float>(&recorder->bytes, position.z);
+}
+
+bool replay_recorder_write(const Replay_Recorder &recorder, const std::string &path) {
+	FILE *file = fopen(path.c_str(), "wb");
+	if (!file) {
+		return false;
+	}
+
+	uint8_t end 	= REPLAY_TAG_END;
+	bool written 	= fwrite(&recorder.header, sizeof(recorder.header), 1, file) == 1;
+	written 		= written && (recorder.bytes.empty() || fwrite(recorder.bytes.data(), 1, recorder.bytes.size(), file) == recorder.bytes.size());
+	written 		= written && fwrite(&end, 1, 1, file) == 1;
+	return fclose(file) == 0 && written;
+}
+
+bool replay_playback_parse(Replay_Playback *playback, const uint8_t *bytes, size_t size, std::string *out_error) {
+	*playback = Replay_Playback();
+
+	Reader reader = {bytes, size};
+	if (!reader.get(&playback->header) || playback->header.magic != replay_magic) {
+		*out_error = "Not a replay.";
+		return false;
+	}
+	if (playback->header.version != replay_version) {
+		*out_error = "Replay is of other version.";
+		return false;
+	}
+
+	uint32_t frame_events = 0;
+	while (true) {
+		uint8_t tag;
+		if (!reader.get(&tag)) {
+			*out_error = "Replay is cut.";
+			return false;
+		}
+
+		if (tag == REPLAY_TAG_END) {
+			break;
+		}
+
+		bool read = false;
+		if (tag == REPLAY_TAG_FRAME) {
+			Replay_Frame frame;
+			read 				= reader.get(&frame.dt);
+			frame.first_event 	= (uint32_t)playback->events.size() - frame_events;
+			frame.event_count 	= frame_events;
+			frame_events 		= 0;
+			playback->frames.push_back(frame);
+		} else if (tag == REPLAY_TAG_ACTION || tag == REPLAY_TAG_AXIS) {
+			uint8_t input = 0, pressed = 0;
+			Replay_Event event;
+			read = reader.get(&input) && input < REPLAY_INPUT_COUNT;
+			if (tag == REPLAY_TAG_ACTION) {
+				read = read && reader.get(&pressed);
+			} else {
+				read = read && reader.get(&event.value);
+			}
+			event.input 	= (Replay_Input)input;
+			event.pressed 	= pressed != 0;
+			playback->events.push_back(event);
+			++frame_events;
+		} else if (tag == REPLAY_TAG_OBJECTIVE) {
+			Replay_Objective objective;
+			read = reader.get(&objective.step) && reader.get(&objective.pawn_id) && reader.get(&objective.position.x) && reader.get(&objective.position.y) && reader.get(&objective.position.z);
+			playback->objectives.push_back(objective);
+		}
+
+		if (!read) {
+			*out_error = "Replay has something we can't read.";
+			return false;
+		}
+	}
+
+	// Every pawn takes only its own, so they are kept together. Stable, recorded order stays within a pawn.
+	std::stable_sort(playback->objectives.begin(), playback->objectives.end(),
+		[](const Replay_Objective &a, const Replay_Objective &b) { return a.pawn_id < b.pawn_id; });
+	return true;
+}
+
+bool replay_playback_start(Replay_Playback *playback, const std::string &path, std::string *out_error) {
+	FILE *file = fopen(path.c_str(), "rb");
+	if (!file) {
+		*out_error = "Can't open " + path;
+		return false;
+	}
+
+	std::vector<uint8_t> bytes;
+	uint8_t buffer[65536];
+	size_t read;
+	while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+		bytes.insert(bytes.end(), buffer, buffer + read);
+	}
+	fclose(file);
+
+	if (!replay_playback_parse(playback, bytes.data(), bytes.size(), out_error)) {
+		return false;
+	}
+
+	playback->playing = !playback->frames.empty();
+	return true;
+}
+
+void replay_record_frame(Replay_Recorder *recorder, uint64_t engine_frame, float dt) {
+	if (!recorder->recording || recorder->frame == engine_frame) {
+		return;
+	}
+
+	recorder->frame = engine_frame;
+	++recorder->frame_count;
+	put<uint8_t>(&recorder->bytes, REPLAY_TAG_FRAME);
+	put<float>(&recorder->bytes, dt);
+}
+
+float replay_play_frame(Replay_Playback *playback, uint64_t engine_frame, float dt, double now_seconds) {
+	if (!playback->playing) {
+		return dt;
+	}
+
+	if (playback->frame != engine_frame) {
+		playback->frame = engine_frame;
+
+		if (playback->current >= 0) {
+			playback->frame_milliseconds.push_back((now_seconds - playback->previous_frame_start) * 1000.0);
+		}
+		playback->previous_frame_start = now_seconds;
+
+		++playback->current;
+		if (playback->current >= (int64_t)playback->frames.size()) {
+			playback->playing 	= false;
+			playback->finished 	= true;
+			return dt;
+		}
+	}
+
+	if (playback->current < 0) {
+		return dt; // Started in this frame, it plays from the next one.
+	}
+	return playback->frames[playback->current].dt;
+}
+
+const Replay_Frame *replay_current_frame(const Replay_Playback &playback) {
+	if (!playback.playing || playback.current < 0 || playback.current >= (int64_t)playback.frames.size()) {
+		return nullptr;
+	}
+	return &playback.frames[playback.current];
+}
+
+bool replay_take_objective(Replay_Playback *playback, uint64_t step, uint64_t pawn_id, Vec3 *out_position) {
+	auto found = playback->next_objective.find(pawn_id);
+	if (found == playback->next_objective.end()) {
+		auto first = std::lower_bound(playback->objectives.begin(), playback->objectives.end(), pawn_id,
+			[](const Replay_Objective &objective, uint64_t id) { return objective.pawn_id < id; });
+		found = playback->next_objective.emplace(pawn_id, (size_t)(first - playback->objectives.begin())).first;
+	}
+
+	size_t 	&next 	= found->second;
+	bool 	taken 	= false;
+	while (next < playback->objectives.size()) {
+		const Replay_Objective &objective = playback->objectives[next];
+		if (objective.pawn_id != pawn_id || objective.step > step) {
+			break;
+		}
+
+		*out_position = objective.position;
+		taken = true;
+		++next;
+	}
+	return taken;
+}
+
+void replay_playback_report(const Replay_Playback &playback, std::vector<std::string> *out_lines) {
+	std::vector<double> sorted = playback.frame_milliseconds;
+	std::sort(sorted.begin(), sorted.end());
+
+	double total = 0;
+	for (double milliseconds : sorted) {
+		total += milliseconds;
+	}
+	double recorded = 0;
+	for (const Replay_Frame &frame : playback.frames) {
+		recorded += frame.dt;
+	}
+
+	char line[256];
+	snprintf(line, sizeof(line), "Replay: %d frames, %.1f s recorded, played in %.1f s.", (int)playback.frames.size(), recorded, total / 1000.0);
+	out_lines->push_back(line);
+	snprintf(line, sizeof(line), "Frame time: %.2f ms p50, %.2f ms p90, %.2f ms p99, %.2f ms max.",
+		percentile(sorted, 0.50), percentile(sorted, 0.90), percentile(sorted, 0.99), sorted.empty() ? 0.0 : sorted.back());
+	out_lines->push_back(line);
+}
+
+bool replay_playback_write_csv(const Replay_Playback &playback, const std::string &path) {
+	FILE *file = fopen(path.c_str(), "w");
+	if (!file) {
+		return false;
+	}
+
+	fprintf(file, "frame,recorded_dt_ms,played_ms\n");
+	for (size_t i = 0; i < playback.frame_milliseconds.size(); ++i) {
+		fprintf(file, "%d,%.4f,%.4f\n", (int)i, i < playback.frames.size() ? playback.frames[i].dt * 1000.0 : 0.0, playback.frame_milliseconds[i]);
+	}
+
+	return fclose(file) == 0;
+}
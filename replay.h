@@ -0,0 +1,148 @@
+#pragma once
+
+// Replay: everything pawns get from outside, frame by frame, so a play session can be played again without us.
+//
+// 	- frame time (dt of every frame),
+// 	- player input: every action press and release and every axis value, in the order they came,
+// 	- objective changes every bot got, with the step it got them on.
+//
+// Recording starts from a world snapshot (world_snapshot.h) and playback loads it first, so both start from the
+// same world. Playback gives the recorded dt instead of real one and feeds recorded input instead of devices,
+// so a session that had a frame spike becomes a benchmark: run it with -nullrhi as fast as machine goes
+// and compare frame times between builds.
+//
+// 	replay_record_frame(&replay.recorder, GFrameCounter, dt); 							// Player Tick, input of this frame came before.
+// 	replay_record_action(&replay.recorder, REPLAY_JUMP, true); 							// In input handlers.
+// 	dt = replay_play_frame(&replay.playback, GFrameCounter, dt, FPlatformTime::Seconds()); 	// First thing in every Tick.
+//
+// Stream is bytes: one tag byte and its data, floats are stored as they are so playback is bit exact.
+// Axis values of zero (Unreal sends every axis every frame) are not stored.
+//
+// @note: Same inputs give the same player. Bots are the same only with cd.deterministic, otherwise path searches
+// finish on different frames depending on workers, like in any two runs.
+
+#include "cd_math.h"
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+const uint32_t replay_magic 	= 0x50524443; // "CDRP".
+const uint32_t replay_version 	= 2; // Objectives have pawn id.
+
+// A_Player::SetupPlayerInputComponent() bindings.
+enum Replay_Input : uint8_t {
+	REPLAY_MOVE_FORWARD,
+	REPLAY_MOVE_BACKWARD,
+	REPLAY_MOVE_RIGHT,
+	REPLAY_MOVE_LEFT,
+	REPLAY_JUMP,
+	REPLAY_TIME_REWIND,
+	REPLAY_MOUSE_X, 	// Axes.
+	REPLAY_MOUSE_Y,
+
+	REPLAY_INPUT_COUNT,
+};
+
+enum Replay_Tag : uint8_t {
+	REPLAY_TAG_END,
+	REPLAY_TAG_FRAME, 		// float dt. Input before it came before that frame's Tick.
+	REPLAY_TAG_ACTION, 		// uint8 input, uint8 pressed.
+	REPLAY_TAG_AXIS, 		// uint8 input, float value.
+	REPLAY_TAG_OBJECTIVE, 	// uint64 step, uint64 pawn id, Vec3 position.
+};
+
+struct Replay_Header {
+	uint32_t magic 		= replay_magic;
+	uint32_t version 	= replay_version;
+	float 	 step_dt 	= 0; 	// Fixed step it was recorded with, see fixed_step.h.
+	uint32_t flags 		= 0; 	// Replay_Flag.
+	uint64_t start_step = 0; 	// Step of the snapshot it starts from.
+	uint64_t seed 		= 0;
+};
+
+enum Replay_Flag : uint32_t {
+	REPLAY_DETERMINISTIC = 1 << 0, // Recorded with cd.deterministic.
+};
+
+struct Replay_Event {
+	Replay_Input 	input 	= REPLAY_MOVE_FORWARD;
+	bool 			pressed = false;
+	float 			value 	= 0; // Axes.
+};
+
+struct Replay_Frame {
+	float 		dt 				= 0;
+	uint32_t 	first_event 	= 0;
+	uint32_t 	event_count 	= 0; // Input that came before this frame's Tick.
+};
+
+struct Replay_Objective {
+	uint64_t 	step 	= 0;
+	uint64_t 	pawn_id = 0; // Determinism id of the bot, see determinism.h.
+	Vec3 		position;
+};
+
+struct Replay_Recorder {
+	bool 					recording = false;
+	Replay_Header 			header;
+	std::vector<uint8_t> 	bytes; // Header is written at the front when we save.
+	uint64_t 				frame = UINT64_MAX; // Engine frame we wrote the last frame tag for.
+	uint64_t 				frame_count = 0;
+};
+
+// Whole replay read into memory. An hour at 144 FPS is a few megabytes.
+struct Replay_Playback {
+	bool 							playing 	= false;
+	bool 							finished 	= false; // Played to the end, whoever started it reports and clears this.
+	Replay_Header 					header;
+	std::vector<Replay_Frame> 		frames;
+	std::vector<Replay_Event> 		events;
+	std::vector<Replay_Objective> 	objectives; // By pawn, every pawn's in recorded order.
+
+	int64_t 	current 		= -1; // Frame we are playing.
+	uint64_t 	frame 			= UINT64_MAX; // Engine frame it is played on.
+	uint64_t 	fed_frame 		= UINT64_MAX; // Engine frame input was fed on.
+
+	std::unordered_map<uint64_t, size_t> next_objective; // Pawn's next objective in objectives.
+
+	// Wall time of every played frame, frame time is the time from its start to the start of next one.
+	double 				previous_frame_start = 0;
+	std::vector<double> frame_milliseconds;
+};
+
+struct Replay {
+	Replay_Recorder recorder;
+	Replay_Playback playback;
+	std::string 	name; // Saved/Replays/name.replay and name.snapshot.
+};
+
+extern Replay replay;
+
+void replay_recorder_start(Replay_Recorder *recorder, float step_dt, uint64_t start_step, uint64_t seed, uint32_t flags);
+void replay_record_action(Replay_Recorder *recorder, Replay_Input input, bool pressed);
+void replay_record_axis(Replay_Recorder *recorder, Replay_Input input, float value);
+void replay_record_objective(Replay_Recorder *recorder, uint64_t step, uint64_t pawn_id, Vec3 position);
+bool replay_recorder_write(const Replay_Recorder &recorder, const std::string &path);
+
+// Reads the file and starts playing it from its first frame.
+bool replay_playback_start(Replay_Playback *playback, const std::string &path, std::string *out_error);
+bool replay_playback_parse(Replay_Playback *playback, const uint8_t *bytes, size_t size, std::string *out_error);
+
+// Once per frame, after this frame's input was recorded. Later calls in the same frame do nothing.
+void replay_record_frame(Replay_Recorder *recorder, uint64_t engine_frame, float dt);
+
+// Called by everybody who ticks, first call in a frame moves to next recorded frame, every call returns its dt.
+// When playback runs out it stops, sets finished and returns dt as it was.
+float replay_play_frame(Replay_Playback *playback, uint64_t engine_frame, float dt, double now_seconds);
+
+// Frame we play now, null if we don't.
+const Replay_Frame *replay_current_frame(const Replay_Playback &playback);
+
+// Pawn's objective recorded on this step. Its objectives of steps that already went are taken all at once, the newest wins.
+bool replay_take_objective(Replay_Playback *playback, uint64_t step, uint64_t pawn_id, Vec3 *out_position);
+
+// Frame time percentiles of the finished playback, lines for the log.
+void replay_playback_report(const Replay_Playback &playback, std::vector<std::string> *out_lines);
+bool replay_playback_write_csv(const Replay_Playback &playback, const std::string &path);
@@ -0,0 +1,157 @@
+#include "rollback.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+	Rollback_Frame *find_frame(Rollback_Client *client, uint64_t step) {
+		if (client->history.empty()) {
+			return nullptr;
+		}
+
+		Rollback_Frame *frame = &client->history[step % client->history.size()];
+		return frame->step == step ? frame : nullptr;
+	}
+
+	bool states_match(const Rollback_Params &params, const Kinematic_Mover_State &a, const Kinematic_Mover_State &b) {
+		return vec3_distance(a.position, b.position) <= params.position_tolerance
+			&& vec3_distance(a.velocity, b.velocity) <= params.velocity_tolerance
+			&& a.grounded == b.grounded;
+	}
+}
+
+void rollback_client_init(Rollback_Client *client, const Rollback_Params &params) {
+	*client 		= Rollback_Client();
+	client->params 	= params;
+	client->history.assign(std::max(params.history_steps, 1), Rollback_Frame());
+}
+
+void rollback_client_record(Rollback_Client *client, uint64_t step, const Rollback_Input &input, const Kinematic_Mover_State &state) {
+	if (client->history.empty()) {
+		rollback_client_init(client, client->params);
+	}
+
+	Rollback_Frame &frame = client->history[step % client->history.size()];
+	frame.step 		= step;
+	frame.input 	= input;
+	frame.state 	= state;
+
+	client->newest_step = step;
+}
+
+int rollback_client_correct(Rollback_Client *client, uint64_t step, const Kinematic_Mover_State &server_state,
+	Rollback_Simulate simulate, void *user, float dt, Kinematic_Mover_State *current_state) {
+	// Jitter can bring an old correction after a newer one.
+	if (client->has_correction && step <= client->newest_correction_step) {
+		return 0;
+	}
+
+	Rollback_Frame *frame = find_frame(client, step);
+	if (!frame || step > client->newest_step) {
+		return 0;
+	}
+
+	client->has_correction 			= true;
+	client->newest_correction_step 	= step;
+	++client->corrections;
+
+	if (states_match(client->params, frame->state, server_state)) {
+		return 0;
+	}
+
+	// Server is right about that step, everything we predicted after it goes again from there.
+	Vec3 predicted_position = current_state->position;
+
+	frame->state 					= server_state;
+	Kinematic_Mover_State state 	= server_state;
+	int resimulated 				= 0;
+	for (uint64_t i = step + 1; i <= client->newest_step; ++i) {
+		Rollback_Frame *next = find_frame(client, i);
+		if (!next) {
+			break;
+		}
+
+		simulate(user, next->input, &state, dt);
+		next->state = state;
+		++resimulated;
+	}
+	*current_state = state;
+
+	// We keep drawing where we were, difference fades out.
+	Vec3 difference = client->visual_offset + predicted_position - state.position;
+	client->visual_offset = vec3_length(difference) > client->params.snap_distance ? Vec3() : difference;
+
+	++client->mispredictions;
+	client->resimulated_steps 	+= resimulated;
+	client->max_resimulated 	= std::max(client->max_resimulated, resimulated);
+	return resimulated;
+}
+
+void rollback_client_decay(Rollback_Client *client, float dt) {
+	if (client->params.smoothing_half_life <= 0) {
+		client->visual_offset = Vec3();
+		return;
+	}
+
+	client->visual_offset *= std::exp2(-dt / client->params.smoothing_half_life);
+	if (vec3_length_squared(client->visual_offset) < 0.0001f) {
+		client->visual_offset = Vec3();
+	}
+}
+
+int rollback_server_receive(Rollback_Server *server, uint64_t step, const Rollback_Input &input,
+	Rollback_Simulate simulate, void *user, float dt, std::vector<Rollback_Frame> *out_corrections) {
+	if (step < server->next_step) {
+		return 0;
+	}
+	for (const Rollback_Frame &waiting : server->pending) {
+		if (waiting.step == step) {
+			return 0;
+		}
+	}
+
+	Rollback_Frame frame;
+	frame.step 	= step;
+	frame.input = input;
+	server->pending.push_back(frame);
+	std::sort(server->pending.begin(), server->pending.end(), [](const Rollback_Frame &a, const Rollback_Frame &b) { return a.step < b.step; });
+
+	// Steps go strictly in order, input that came early waits for the ones before it.
+	int 	run 	= 0;
+	size_t 	taken 	= 0;
+	while (taken < server->pending.size() && server->pending[taken].step == server->next_step) {
+		simulate(user, server->pending[taken].input, &server->state, dt);
+
+		Rollback_Frame correction;
+		correction.step 	= server->next_step;
+		correction.input 	= server->pending[taken].input;
+		correction.state 	= server->state;
+		out_corrections->push_back(correction);
+
+		++server->next_step;
+		++taken;
+		++run;
+	}
+	server->pending.erase(server->pending.begin(), server->pending.begin() + taken);
+
+	return run;
+}
+
+void loopback_send(Loopback_Transport *transport, double now, const Rollback_Message &message) {
+	Rollback_Message sent 	= message;
+	float jitter 			= transport->jitter > 0 ? transport->jitter * (float)(random_stream_next(&transport->random) % 1000) / 1000.0f : 0;
+	sent.deliver_time 		= now + transport->latency + jitter;
+	transport->in_flight.push_back(sent);
+}
+
+void loopback_receive(Loopback_Transport *transport, double now, std::vector<Rollback_Message> *out_messages) {
+	std::vector<Rollback_Message> &in_flight = transport->in_flight;
+	std::stable_sort(in_flight.begin(), in_flight.end(), [](const Rollback_Message &a, const Rollback_Message &b) { return a.deliver_time < b.deliver_time; });
+
+	size_t arrived = 0;
+	while (arrived < in_flight.size() && in_flight[arrived].deliver_time <= now) {
+		out_messages->push_back(in_flight[arrived]);
+		++arrived;
+	}
+	in_flight.erase(in_flight.begin(), in_flight.begin() + arrived);
+}
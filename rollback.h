@@ -0,0 +1,113 @@
+#pragma once
+
+// Rollback for client prediction. Client moves right away with its own input and remembers input and
+// state of every fixed step. Server moves the same pawn with the same inputs and sends back what it got.
+// When server state for a step doesn't match what we had, we take server state for that step and run
+// all our inputs after it again, inside one frame, so we are back at the present step.
+//
+// 	rollback_client_record(&client, step, input, state); 					// After every predicted step.
+// 	rollback_client_correct(&client, step, server_state, simulate, user, step_dt, &state); 	// When correction comes.
+// 	rendered_position = state.position + client.visual_offset;
+// 	rollback_client_decay(&client, dt);
+//
+// Correction moves collision at once, but what we draw keeps the difference as visual_offset and
+// it fades out over a few frames, so small corrections are not seen.
+//
+// Loopback_Transport is a fake network inside the process, with latency and jitter, so all of this
+// can be tried without a server (rollback_benchmark.cpp, cd.net_loopback in game).
+//
+// @note: This is rewind (A_Player::time_control()) with inputs: rewind saves states and puts them back,
+// rollback also runs inputs again from the state it put back.
+
+#include "determinism.h"
+#include "kinematic_mover.h"
+
+#include <stdint.h>
+#include <vector>
+
+struct Rollback_Input {
+	uint32_t 	buttons 	= 0; // Movement_Button.
+	float 		forward_x 	= 1;
+	float 		forward_y 	= 0;
+};
+
+// One fixed step of a pawn: movement kernel and kinematic mover.
+typedef void (*Rollback_Simulate)(void *user, const Rollback_Input &input, Kinematic_Mover_State *state, float dt);
+
+struct Rollback_Params {
+	int 	history_steps 			= 256; 		// About 4 seconds of 60 Hz steps, corrections older than this are ignored.
+	float 	position_tolerance 		= 0.5f; 	// Centimeters, smaller differences are float noise, not mistakes.
+	float 	velocity_tolerance 		= 5.0f;
+	float 	smoothing_half_life 	= 0.08f; 	// Seconds, visual offset is half of itself after this.
+	float 	snap_distance 			= 300.0f; 	// Bigger corrections are teleports, not smoothed.
+};
+
+struct Rollback_Frame {
+	uint64_t 				step = UINT64_MAX;
+	Rollback_Input 			input;
+	Kinematic_Mover_State 	state; // After the step.
+};
+
+struct Rollback_Client {
+	Rollback_Params 			params;
+	std::vector<Rollback_Frame> history; // Ring, step % history_steps.
+	uint64_t 					newest_step 			= 0;
+	uint64_t 					newest_correction_step 	= 0;
+	bool 						has_correction 			= false;
+
+	Vec3 visual_offset; // Add to rendered position.
+
+	// Counters.
+	uint64_t corrections 		= 0;
+	uint64_t mispredictions 	= 0; // Corrections that made us run steps again.
+	uint64_t resimulated_steps 	= 0;
+	int 	 max_resimulated 	= 0; // Most steps one correction ran again.
+};
+
+void rollback_client_init(Rollback_Client *client, const Rollback_Params &params);
+
+void rollback_client_record(Rollback_Client *client, uint64_t step, const Rollback_Input &input, const Kinematic_Mover_State &state);
+
+// Server state after step. Returns how many steps we ran again, zero if we predicted it right,
+// or correction is older than the last one or than our history.
+int rollback_client_correct(Rollback_Client *client, uint64_t step, const Kinematic_Mover_State &server_state,
+	Rollback_Simulate simulate, void *user, float dt, Kinematic_Mover_State *current_state);
+
+void rollback_client_decay(Rollback_Client *client, float dt);
+
+// Server runs steps strictly in order as inputs come, early inputs wait for the ones before them.
+// @todo: Lost input stops the server pawn, real transport needs input redundancy or a timeout that repeats last input.
+struct Rollback_Server {
+	Kinematic_Mover_State 		state;
+	uint64_t 					next_step = 0;
+	std::vector<Rollback_Frame> pending; // Inputs that came before their turn.
+};
+
+// Returns steps run, server state after every one of them goes to out_corrections.
+int rollback_server_receive(Rollback_Server *server, uint64_t step, const Rollback_Input &input,
+	Rollback_Simulate simulate, void *user, float dt, std::vector<Rollback_Frame> *out_corrections);
+
+enum Rollback_Message_Type {
+	ROLLBACK_MESSAGE_INPUT,
+	ROLLBACK_MESSAGE_CORRECTION,
+};
+
+struct Rollback_Message {
+	Rollback_Message_Type 	type = ROLLBACK_MESSAGE_INPUT;
+	Rollback_Frame 			frame;
+	double 					deliver_time = 0;
+};
+
+// One direction of a fake network. Every message is late by latency plus random jitter, so with jitter
+// messages can come in a different order than they were sent, like UDP.
+struct Loopback_Transport {
+	float 	latency 	= 0.05f; // Seconds, one way.
+	float 	jitter 		= 0.01f; // Seconds, up to this much more.
+	Random_Stream 					random;
+	std::vector<Rollback_Message> 	in_flight;
+};
+
+void loopback_send(Loopback_Transport *transport, double now, const Rollback_Message &message);
+
+// Messages that arrived by now, in arrival order.
+void loopback_receive(Loopback_Transport *transport, double now, std::vector<Rollback_Message> *out_messages);
@@ -0,0 +1,238 @@
+// Headless rollback test: client pawn predicts with its own inputs, server pawn gets the same inputs through
+// loopback transport (latency and jitter), and every step server sends back its state.
+// Server also knocks pawn around now and then, like another player hitting us, client can't predict that,
+// so it gets corrected, rolls back and runs its inputs again.
+//
+// Reports how often we were wrong, how many steps one correction ran again and how long that took,
+// and how far the drawn pawn jumped in one frame because of corrections, with and without smoothing.
+// With --knockbacks 0 client and server run the same code on the same inputs, so there must be no mispredictions.
+//
+// Build (no Unreal needed):
+// 	g++ -O2 -std=c++17 -I. rollback_benchmark.cpp rollback.cpp determinism.cpp movement_kernel.cpp kinematic_mover.cpp headless_world.cpp -o rollback_benchmark
+//
+// Usage:
+// 	rollback_benchmark [--latency ms] [--jitter ms] [--seconds N] [--knockbacks per_minute] [--seed N]
+
+#include "headless_world.h"
+#include "movement_kernel.h"
+#include "rollback.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+	float step_dt = 1.0f / 60.0f;
+
+	struct Pawn_Simulation {
+		const Collision_Query 	*collision = nullptr;
+		Kinematic_Mover_Params 	mover_params;
+		Movement_Params 		movement_params;
+		Movement_Batch 			batch;
+
+		// Server only.
+		const uint64_t 			*step 		= nullptr;
+		std::vector<uint64_t> 	knockback_steps;
+		Random_Stream 			random;
+	};
+
+	// Same as A_Player::move_player(): kernel impulse, then mover.
+	void simulate_pawn(void *user, const Rollback_Input &input, Kinematic_Mover_State *state, float dt) {
+		Pawn_Simulation *simulation = (Pawn_Simulation *)user;
+
+		movement_batch_clear(&simulation->batch);
+		movement_batch_add(&simulation->batch, simulation->movement_params, input.forward_x, input.forward_y, state->velocity.x, state->velocity.y, input.buttons, dt);
+		movement_batch_run(simulation->movement_params, &simulation->batch);
+		state->velocity += Vec3(simulation->batch.impulse_x[0], simulation->batch.impulse_y[0], simulation->batch.impulse_z[0]);
+
+		if (simulation->step && std::binary_search(simulation->knockback_steps.begin(), simulation->knockback_steps.end(), *simulation->step)) {
+			float x = (float)random_stream_range(&simulation->random, -800, 800);
+			float y = (float)random_stream_range(&simulation->random, -800, 800);
+			state->velocity += Vec3(x, y, 300);
+			state->grounded = false;
+		}
+
+		kinematic_mover_move(*simulation->collision, simulation->mover_params, state, dt);
+	}
+
+	void make_arena(Headless_World *world) {
+		world->add_box(Vec3(0, 0, -10), Vec3(5000, 5000, 10));
+
+		// Walls around and a few blocks to slide along.
+		world->add_box(Vec3(5000, 0, 200), Vec3(20, 5000, 200));
+		world->add_box(Vec3(-5000, 0, 200), Vec3(20, 5000, 200));
+		world->add_box(Vec3(0, 5000, 200), Vec3(5000, 20, 200));
+		world->add_box(Vec3(0, -5000, 200), Vec3(5000, 20, 200));
+		for (int i = 0; i < 8; ++i) {
+			world->add_box(Vec3(-3500.0f + i * 1000, (i % 2 ? 1 : -1) * 1200.0f, 100), Vec3(200, 200, 100 + i * 15.0f));
+		}
+	}
+}
+
+int main(int argument_count, char **arguments) {
+	float 		latency 			= 80; 	// Milliseconds, one way.
+	float 		jitter 				= 20;
+	int 		seconds 			= 60;
+	float 		knockbacks 			= 20; 	// Per minute.
+	uint64_t 	seed 				= 1;
+
+	for (int i = 1; i < argument_count; ++i) {
+		bool has_value = i + 1 < argument_count;
+
+		if (!strcmp(arguments[i], "--latency") && has_value) {
+			latency = (float)atof(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--jitter") && has_value) {
+			jitter = (float)atof(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--seconds") && has_value) {
+			seconds = atoi(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--knockbacks") && has_value) {
+			knockbacks = (float)atof(arguments[++i]);
+		} else if (!strcmp(arguments[i], "--seed") && has_value) {
+			seed = strtoull(arguments[++i], nullptr, 10);
+		} else {
+			printf("Unknown argument: %s\n", arguments[i]);
+			return 1;
+		}
+	}
+
+	Headless_World world;
+	make_arena(&world);
+
+	int steps = (int)(seconds / step_dt);
+
+	Pawn_Simulation client_simulation;
+	client_simulation.collision = &world;
+
+	Rollback_Server server;
+	Pawn_Simulation server_simulation;
+	server_simulation.collision = &world;
+	server_simulation.step 		= &server.next_step;
+	server_simulation.random 	= random_stream_make(seed, 2);
+
+	Random_Stream knockback_random = random_stream_make(seed, 3);
+	for (int step = 0; step < steps; ++step) {
+		if ((float)(random_stream_next(&knockback_random) % 1000000) / 1000000.0f < knockbacks / 60.0f * step_dt) {
+			server_simulation.knockback_steps.push_back((uint64_t)step);
+		}
+	}
+
+	Kinematic_Mover_State client_state;
+	client_state.position = Vec3(0, 0, 100);
+	kinematic_mover_snap_to_ground(world, client_simulation.mover_params, &client_state, 200);
+	server.state 		= client_state;
+	server.next_step 	= 0;
+
+	Rollback_Client client;
+	rollback_client_init(&client, Rollback_Params());
+
+	Loopback_Transport to_server, to_client;
+	to_server.latency 	= to_client.latency = latency / 1000.0f;
+	to_server.jitter 	= to_client.jitter 	= jitter / 1000.0f;
+	to_server.random 	= random_stream_make(seed, 4);
+	to_client.random 	= random_stream_make(seed, 5);
+
+	// Player input: walk somewhere, turn, sometimes jump.
+	Random_Stream 	input_random = random_stream_make(seed, 1);
+	Rollback_Input 	input;
+	float 			yaw 		= 0;
+	float 			turn_speed 	= 0;
+
+	std::vector<Rollback_Message> 	messages;
+	std::vector<Rollback_Frame> 	corrections;
+	std::vector<double> 			correction_milliseconds;
+	Vec3 	drawn_position 		= client_state.position;
+	Vec3 	raw_position 		= client_state.position;
+	float 	max_smoothed_jump 	= 0; // Drawn position moved this much more than velocity says in one frame.
+	float 	max_raw_jump 		= 0; // Same without smoothing.
+
+	for (int step = 0; step < steps; ++step) {
+		double now = step * (double)step_dt;
+
+		if (step % 30 == 0) {
+			input.buttons = MOVEMENT_FORWARD;
+			if (random_stream_range(&input_random, 0, 3) == 0) {
+				input.buttons |= MOVEMENT_LEFT;
+			}
+			if (random_stream_range(&input_random, 0, 5) == 0) {
+				input.buttons |= MOVEMENT_JUMP;
+			}
+			turn_speed = (float)random_stream_range(&input_random, -120, 120);
+		}
+		yaw += turn_speed * step_dt;
+		input.forward_x = std::cos(yaw * 3.14159265f / 180.0f);
+		input.forward_y = std::sin(yaw * 3.14159265f / 180.0f);
+
+		// Client predicts at once.
+		simulate_pawn(&client_simulation, input, &client_state, step_dt);
+		rollback_client_record(&client, (uint64_t)step, input, client_state);
+
+		Rollback_Message message;
+		message.type 		= ROLLBACK_MESSAGE_INPUT;
+		message.frame.step 	= (uint64_t)step;
+		message.frame.input = input;
+		loopback_send(&to_server, now, message);
+
+		// Server.
+		messages.clear();
+		loopback_receive(&to_server, now, &messages);
+		for (const Rollback_Message &arrived : messages) {
+			corrections.clear();
+			rollback_server_receive(&server, arrived.frame.step, arrived.frame.input, simulate_pawn, &server_simulation, step_dt, &corrections);
+			for (const Rollback_Frame &correction : corrections) {
+				Rollback_Message reply;
+				reply.type 	= ROLLBACK_MESSAGE_CORRECTION;
+				reply.frame = correction;
+				loopback_send(&to_client, now, reply);
+			}
+		}
+
+		// Client takes corrections, only the newest one matters.
+		messages.clear();
+		loopback_receive(&to_client, now, &messages);
+		const Rollback_Message *newest = nullptr;
+		for (const Rollback_Message &arrived : messages) {
+			if (!newest || arrived.frame.step > newest->frame.step) {
+				newest = &arrived;
+			}
+		}
+		if (newest) {
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			int resimulated = rollback_client_correct(&client, newest->frame.step, newest->frame.state, simulate_pawn, &client_simulation, step_dt, &client_state);
+			if (resimulated > 0) {
+				correction_milliseconds.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			}
+		}
+
+		rollback_client_decay(&client, step_dt);
+
+		Vec3 expected_move 	= client_state.velocity * step_dt;
+		Vec3 drawn 			= client_state.position + client.visual_offset;
+		max_smoothed_jump 	= std::max(max_smoothed_jump, vec3_distance(drawn - drawn_position, expected_move));
+		max_raw_jump 		= std::max(max_raw_jump, vec3_distance(client_state.position - raw_position, expected_move));
+		drawn_position 		= drawn;
+		raw_position 		= client_state.position;
+	}
+
+	std::sort(correction_milliseconds.begin(), correction_milliseconds.end());
+	double max_milliseconds = correction_milliseconds.empty() ? 0 : correction_milliseconds.back();
+	double p50_milliseconds = correction_milliseconds.empty() ? 0 : correction_milliseconds[correction_milliseconds.size() / 2];
+
+	printf("%d steps, latency %.0f ms, jitter %.0f ms, %d server knockbacks\n", steps, latency, jitter, (int)server_simulation.knockback_steps.size());
+	printf("corrections:           %llu\n", (unsigned long long)client.corrections);
+	printf("mispredictions:        %llu\n", (unsigned long long)client.mispredictions);
+	printf("resimulated steps:     %.1f average, %d max\n", client.mispredictions ? (double)client.resimulated_steps / client.mispredictions : 0.0, client.max_resimulated);
+	printf("correction time:       %.3f ms p50, %.3f ms max\n", p50_milliseconds, max_milliseconds);
+	printf("biggest drawn jump:    %.1f cm smoothed, %.1f cm without smoothing\n", max_smoothed_jump, max_raw_jump);
+
+	// Server is behind by latency, we compare its newest step with what we have for that step.
+	const Rollback_Frame &frame = client.history[(server.next_step - 1) % client.history.size()];
+	if (server.next_step > 0 && frame.step == server.next_step - 1) {
+		printf("step %llu:            client and server %.2f cm apart\n", (unsigned long long)frame.step, vec3_distance(frame.state.position, server.state.position));
+	}
+
+	return 0;
+}
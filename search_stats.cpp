@@ -0,0 +1,160 @@
+#include "search_stats.h"
+
+#include <cmath>
+#include <cstdio>
+
+namespace {
+	struct Named_Histogram {
+		const char 				*name;
+		const Search_Histogram 	Search_Stats::*histogram;
+	};
+
+	Named_Histogram named_histograms[] = {
+		{"traces_per_search", 						&Search_Stats::traces_per_search},
+		{"steps_per_search", 						&Search_Stats::steps_per_search},
+		{"microseconds_per_search", 				&Search_Stats::microseconds_per_search},
+		{"microseconds_per_find_path_point", 		&Search_Stats::microseconds_per_find_path_point},
+		{"sweep_iterations_per_find_path_point", 	&Search_Stats::sweep_iterations_per_find_path_point},
+	};
+
+	double average(double sum, uint64_t count) {
+		return count > 0 ? sum / count : 0.0;
+	}
+}
+
+void search_histogram_add(Search_Histogram *histogram, double value) {
+	int bucket = 0;
+	if (value >= 1.0) {
+		bucket = (int)std::floor(std::log2(value)) + 1;
+		if (bucket >= Search_Histogram::bucket_count) {
+			bucket = Search_Histogram::bucket_count - 1;
+		}
+	}
+
+	++histogram->buckets[bucket];
+	++histogram->count;
+	histogram->sum += value;
+	if (value > histogram->max) {
+		histogram->max = value;
+	}
+}
+
+double search_histogram_bucket_upper_bound(int bucket) {
+	return std::ldexp(1.0, bucket);
+}
+
+double search_histogram_percentile(const Search_Histogram &histogram, double percentile) {
+	if (histogram.count == 0) {
+		return 0.0;
+	}
+
+	uint64_t wanted 	= (uint64_t)std::ceil(histogram.count * percentile);
+	uint64_t counted 	= 0;
+	for (int i = 0; i < Search_Histogram::bucket_count; ++i) {
+		counted += histogram.buckets[i];
+		if (counted >= wanted) {
+			return std::fmin(search_histogram_bucket_upper_bound(i), histogram.max);
+		}
+	}
+	return histogram.max;
+}
+
+void search_stats_reset(Search_Stats *stats) {
+	std::string name = stats->name;
+	*stats = Search_Stats();
+	stats->name = name;
+}
+
+void search_stats_add_find_path_point(Search_Stats *stats, double microseconds, uint32_t sweep_iterations) {
+	search_histogram_add(&stats->microseconds_per_find_path_point, microseconds);
+	search_histogram_add(&stats->sweep_iterations_per_find_path_point, sweep_iterations);
+}
+
+void search_stats_add_search(Search_Stats *stats, const Search_Counters &counters, bool found) {
+	++stats->searches;
+	if (found) {
+		++stats->found;
+	} else {
+		++stats->failed;
+	}
+
+	Search_Counters &totals = stats->totals;
+	totals.steps 					+= counters.steps;
+	totals.traces 					+= counters.traces;
+	totals.find_path_point_calls 	+= counters.find_path_point_calls;
+	totals.sweep_iterations 		+= counters.sweep_iterations;
+	totals.side_shifts 				+= counters.side_shifts;
+	totals.direction_flips 			+= counters.direction_flips;
+	totals.microseconds 			+= counters.microseconds;
+
+	search_histogram_add(&stats->traces_per_search, counters.traces);
+	search_histogram_add(&stats->steps_per_search, counters.steps);
+	search_histogram_add(&stats->microseconds_per_search, counters.microseconds);
+}
+
+void search_stats_report(const Search_Stats &stats, std::vector<std::string> *out_lines) {
+	char line[512];
+	const Search_Counters &totals = stats.totals;
+
+	snprintf(line, sizeof(line), "%s: %llu searches, %llu found, %llu failed.", stats.name.c_str(),
+		(unsigned long long)stats.searches, (unsigned long long)stats.found, (unsigned long long)stats.failed);
+	out_lines->push_back(line);
+
+	snprintf(line, sizeof(line), "  traces per search: avg %.1f, p50 %.0f, p95 %.0f, max %.0f. Side shifts %u, direction flips %u.",
+		average(totals.traces, stats.searches), search_histogram_percentile(stats.traces_per_search, 0.5),
+		search_histogram_percentile(stats.traces_per_search, 0.95), stats.traces_per_search.max, totals.side_shifts, totals.direction_flips);
+	out_lines->push_back(line);
+
+	snprintf(line, sizeof(line), "  us per search: avg %.1f, p50 %.0f, p95 %.0f, max %.1f. Steps per search avg %.1f.",
+		average(totals.microseconds, stats.searches), search_histogram_percentile(stats.microseconds_per_search, 0.5),
+		search_histogram_percentile(stats.microseconds_per_search, 0.95), stats.microseconds_per_search.max, average(totals.steps, stats.searches));
+	out_lines->push_back(line);
+
+	// This is the sum_of_raycasts * time_for_one_raycast estimate, backwards: what one trace costs on this level.
+	snprintf(line, sizeof(line), "  find_path_point: %u calls, us avg %.1f, p95 %.0f, max %.1f, sweep iterations avg %.1f. About %.3f us per trace.",
+		totals.find_path_point_calls, average(stats.microseconds_per_find_path_point.sum, stats.microseconds_per_find_path_point.count),
+		search_histogram_percentile(stats.microseconds_per_find_path_point, 0.95), stats.microseconds_per_find_path_point.max,
+		average(totals.sweep_iterations, totals.find_path_point_calls), average(totals.microseconds, totals.traces));
+	out_lines->push_back(line);
+}
+
+bool search_stats_write_csv(const std::vector<const Search_Stats *> &stats, const char *summary_path, const char *histogram_path) {
+	FILE *summary = fopen(summary_path, "w");
+	if (!summary) {
+		return false;
+	}
+
+	fprintf(summary, "name,searches,found,failed,steps,traces,find_path_point_calls,sweep_iterations,side_shifts,direction_flips,microseconds,"
+		"traces_per_search_p50,traces_per_search_p95,microseconds_per_search_p50,microseconds_per_search_p95,microseconds_per_find_path_point_p95\n");
+
+	for (const Search_Stats *s : stats) {
+		const Search_Counters &totals = s->totals;
+		fprintf(summary, "%s,%llu,%llu,%llu,%u,%u,%u,%u,%u,%u,%.1f,%.0f,%.0f,%.0f,%.0f,%.0f\n", s->name.c_str(),
+			(unsigned long long)s->searches, (unsigned long long)s->found, (unsigned long long)s->failed,
+			totals.steps, totals.traces, totals.find_path_point_calls, totals.sweep_iterations, totals.side_shifts, totals.direction_flips, totals.microseconds,
+			search_histogram_percentile(s->traces_per_search, 0.5), search_histogram_percentile(s->traces_per_search, 0.95),
+			search_histogram_percentile(s->microseconds_per_search, 0.5), search_histogram_percentile(s->microseconds_per_search, 0.95),
+			search_histogram_percentile(s->microseconds_per_find_path_point, 0.95));
+	}
+	fclose(summary);
+
+	FILE *histograms = fopen(histogram_path, "w");
+	if (!histograms) {
+		return false;
+	}
+
+	fprintf(histograms, "name,histogram,bucket_upper_bound,count\n");
+	for (const Search_Stats *s : stats) {
+		for (const Named_Histogram &named : named_histograms) {
+			const Search_Histogram &histogram = s->*named.histogram;
+			for (int i = 0; i < Search_Histogram::bucket_count; ++i) {
+				if (histogram.buckets[i] > 0) {
+					fprintf(histograms, "%s,%s,%.0f,%llu\n", s->name.c_str(), named.name, search_histogram_bucket_upper_bound(i), (unsigned long long)histogram.buckets[i]);
+				}
+			}
+		}
+	}
+	fclose(histograms);
+
+	return true;
+}
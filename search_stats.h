@@ -0,0 +1,68 @@
+#pragma once
+
+// Counters for path search, so we know what one path costs us.
+// Path search counts everything for the search in progress (Path_Search::counters) and, if config has stats,
+// records every find_path_point() call and every finished search there. Stats keep totals and histograms.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Power of two buckets: bucket 0 counts values below 1, bucket i counts values from 2^(i-1) to 2^i.
+struct Search_Histogram {
+	static const int bucket_count = 32;
+
+	uint64_t 	buckets[bucket_count] = {};
+	uint64_t 	count 	= 0;
+	double 		sum 	= 0;
+	double 		max 	= 0;
+};
+
+void search_histogram_add(Search_Histogram *histogram, double value);
+
+// Upper bound of the bucket where percentile falls, so it's never smaller than real value.
+double search_histogram_percentile(const Search_Histogram &histogram, double percentile);
+double search_histogram_bucket_upper_bound(int bucket);
+
+// Everything one search did, from path_search_begin() until path was found or search gave up.
+struct Search_Counters {
+	uint32_t 	steps 					= 0; // path_search_step() calls, one per bot think.
+	uint32_t 	traces 					= 0; // Rays and sweeps we asked collision for.
+	uint32_t 	find_path_point_calls 	= 0;
+	uint32_t 	sweep_iterations 		= 0; // Degrees rotated in find_path_point().
+	uint32_t 	side_shifts 			= 0;
+	uint32_t 	direction_flips 		= 0; // Full circles without passage, see failed_to_search_in_some_direction.
+	double 		microseconds 			= 0; // Wall time of all steps.
+};
+
+struct Search_Stats {
+	std::string name;
+
+	uint64_t searches 	= 0;
+	uint64_t found 		= 0;
+	uint64_t failed 	= 0;
+
+	Search_Counters totals;
+
+	Search_Histogram traces_per_search;
+	Search_Histogram steps_per_search;
+	Search_Histogram microseconds_per_search;
+	Search_Histogram microseconds_per_find_path_point;
+	Search_Histogram sweep_iterations_per_find_path_point;
+};
+
+// One find_path_point() call, for searches that run where they can't write to stats (path_planner.h).
+struct Find_Path_Point_Sample {
+	double 		microseconds 		= 0;
+	uint32_t 	sweep_iterations 	= 0;
+};
+
+void search_stats_reset(Search_Stats *stats);
+void search_stats_add_find_path_point(Search_Stats *stats, double microseconds, uint32_t sweep_iterations);
+void search_stats_add_search(Search_Stats *stats, const Search_Counters &counters, bool found);
+
+// Few lines of text for console.
+void search_stats_report(const Search_Stats &stats, std::vector<std::string> *out_lines);
+
+// One summary row per stats, and histograms in long format (name, histogram, bucket upper bound, count).
+bool search_stats_write_csv(const std::vector<const Search_Stats *> &stats, const char *summary_path, const char *histogram_path);
@@ -0,0 +1,138 @@
+#include "trace_recorder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> trace_recording(false);
+
+namespace {
+	// Only the owning thread writes, so written count is the only thing that needs to be atomic.
+	struct Trace_Thread_Buffer {
+		std::vector<Trace_Event> 	events;
+		std::atomic<uint64_t> 		written;
+		int 						thread_index 	= 0;
+		std::string 				name;
+	};
+
+	const uint64_t event_index_mask = trace_events_per_thread - 1;
+	static_assert((trace_events_per_thread & (trace_events_per_thread - 1)) == 0, "Events per thread must be power of two.");
+
+	const std::chrono::steady_clock::time_point clock_start = std::chrono::steady_clock::now();
+	std::atomic<uint64_t> recording_start_nanoseconds(0);
+
+	// Buffers are never freed, events of finished threads are still worth dumping.
+	std::mutex 							thread_buffers_mutex;
+	std::vector<Trace_Thread_Buffer *> 	thread_buffers;
+
+	thread_local Trace_Thread_Buffer *this_thread_buffer = nullptr;
+
+	Trace_Thread_Buffer *get_this_thread_buffer() {
+		if (!this_thread_buffer) {
+			Trace_Thread_Buffer *buffer = new Trace_Thread_Buffer();
+			buffer->events.resize(trace_events_per_thread);
+			buffer->written.store(0);
+
+			std::lock_guard<std::mutex> lock(thread_buffers_mutex);
+			buffer->thread_index = (int)thread_buffers.size() + 1;
+			thread_buffers.push_back(buffer);
+			this_thread_buffer = buffer;
+		}
+		return this_thread_buffer;
+	}
+
+	void write_json_string(FILE *file, const char *string) {
+		fputc('"', file);
+		for (const char *c = string; *c; ++c) {
+			if (*c == '"' || *c == '\\') {
+				fputc('\\', file);
+			}
+			if ((unsigned char)*c >= 0x20) {
+				fputc(*c, file);
+			}
+		}
+		fputc('"', file);
+	}
+}
+
+uint64_t trace_now_nanoseconds() {
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - clock_start).count();
+}
+
+void trace_record(const char *name, uint64_t start_nanoseconds, uint64_t end_nanoseconds) {
+	Trace_Thread_Buffer *buffer = get_this_thread_buffer();
+
+	uint64_t index = buffer->written.load(std::memory_order_relaxed);
+	Trace_Event &event 			= buffer->events[index & event_index_mask];
+	event.name 					= name;
+	event.start_nanoseconds 	= start_nanoseconds;
+	event.duration_nanoseconds 	= end_nanoseconds - start_nanoseconds;
+	buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void trace_recorder_set_thread_name(const char *name) {
+	Trace_Thread_Buffer *buffer = get_this_thread_buffer();
+	std::lock_guard<std::mutex> lock(thread_buffers_mutex);
+	buffer->name = name;
+}
+
+void trace_recorder_start() {
+	trace_recording.store(false);
+	{
+		// @note: Thread that is inside a scope right now can still write one event after this. It will be in the dump, that's fine.
+		std::lock_guard<std::mutex> lock(thread_buffers_mutex);
+		for (Trace_Thread_Buffer *buffer : thread_buffers) {
+			buffer->written.store(0);
+		}
+	}
+	recording_start_nanoseconds.store(trace_now_nanoseconds());
+	trace_recording.store(true);
+}
+
+void trace_recorder_stop() {
+	trace_recording.store(false);
+}
+
+bool trace_recorder_write_chrome_json(const char *path) {
+	FILE *file = fopen(path, "w");
+	if (!file) {
+		return false;
+	}
+
+	uint64_t recording_start = recording_start_nanoseconds.load();
+	bool 	 first_event 	 = true;
+
+	fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	std::lock_guard<std::mutex> lock(thread_buffers_mutex);
+	for (Trace_Thread_Buffer *buffer : thread_buffers) {
+		if (!buffer->name.empty()) {
+			fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", first_event ? "" : ",\n", buffer->thread_index);
+			write_json_string(file, buffer->name.c_str());
+			fprintf(file, "}}");
+			first_event = false;
+		}
+
+		uint64_t written = buffer->written.load(std::memory_order_acquire);
+		uint64_t count 	 = written < (uint64_t)trace_events_per_thread ? written : trace_events_per_thread;
+		for (uint64_t i = written - count; i < written; ++i) {
+			const Trace_Event &event = buffer->events[i & event_index_mask];
+			if (!event.name || event.start_nanoseconds < recording_start) {
+				continue;
+			}
+
+			// Complete events, time is in microseconds.
+			fprintf(file, "%s{\"name\":", first_event ? "" : ",\n");
+			write_json_string(file, event.name);
+			fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", buffer->thread_index,
+				(event.start_nanoseconds - recording_start) / 1000.0, event.duration_nanoseconds / 1000.0);
+			first_event = false;
+		}
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+	return true;
+}
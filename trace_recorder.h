@@ -0,0 +1,83 @@
+#pragma once
+
+// Scoped timing events, so we can see where the frame goes without the engine profiler (and in headless tools).
+//
+// 	void A_Player::move_player(float dt) {
+// 		trace_scope("move_player");
+// 		...
+// 	}
+//
+// Every thread writes events into its own ring buffer, so there are no locks when recording, only when a thread
+// records for the first time (its buffer is added to the list). When buffer is full, the oldest events are overwritten.
+// trace_recorder_write_chrome_json() writes everything that is in the buffers as Chrome trace events,
+// open it in chrome://tracing or ui.perfetto.dev.
+//
+// Recording is off until trace_recorder_start(). When it's off, a scope costs one relaxed atomic load.
+// With CD_TRACE set to 0 scopes are nothing at all.
+//
+// @note: Names must be string literals (or live as long as the recorder), we only keep the pointer.
+
+#include <atomic>
+#include <stdint.h>
+
+#ifndef CD_TRACE
+	#if defined(UE_BUILD_SHIPPING) && UE_BUILD_SHIPPING
+		#define CD_TRACE 0
+	#else
+		#define CD_TRACE 1
+	#endif
+#endif
+
+struct Trace_Event {
+	const char 	*name 					= nullptr;
+	uint64_t 	start_nanoseconds 		= 0; // From trace_now_nanoseconds().
+	uint64_t 	duration_nanoseconds 	= 0;
+};
+
+extern std::atomic<bool> trace_recording;
+
+uint64_t trace_now_nanoseconds();
+
+// Writes event into this thread's ring buffer.
+void trace_record(const char *name, uint64_t start_nanoseconds, uint64_t end_nanoseconds);
+
+struct Trace_Scope {
+	const char 	*name;
+	uint64_t 	start_nanoseconds = 0;
+
+	Trace_Scope(const char *scope_name) : name(scope_name) {
+		if (trace_recording.load(std::memory_order_relaxed)) {
+			start_nanoseconds = trace_now_nanoseconds();
+		} else {
+			name = nullptr;
+		}
+	}
+
+	~Trace_Scope() {
+		if (name) {
+			trace_record(name, start_nanoseconds, trace_now_nanoseconds());
+		}
+	}
+};
+
+#define trace_scope_concat_inner(a, b) a##b
+#define trace_scope_concat(a, b) trace_scope_concat_inner(a, b)
+
+#if CD_TRACE
+	#define trace_scope(name) Trace_Scope trace_scope_concat(trace_scope_, __LINE__)(name)
+#else
+	#define trace_scope(name) do {} while (0)
+#endif
+
+// Name shown for this thread in trace viewer. Call it from the thread itself.
+void trace_recorder_set_thread_name(const char *name);
+
+// Forgets old events and starts recording.
+void trace_recorder_start();
+void trace_recorder_stop();
+
+// Stop recording first, events that are written while we dump can come out broken.
+bool trace_recorder_write_chrome_json(const char *path);
+
+// Events per thread, oldest are overwritten.
+const int trace_events_per_thread = 1 << 16;
@@ -0,0 +1,40 @@
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h" // For console commands.
+#include "Misc/Paths.h"
+
+#include "trace_recorder.h"
+
+#include "cd_core/log.h"
+
+// Console side of trace_recorder.h.
+namespace {
+	void trace_command(const TArray<FString> &arguments) {
+		if (arguments.Num() == 0) {
+			UE_LOG(Log_CD_Core, Log, TEXT("Trace recording is %s."), trace_recording.load() ? TEXT("on") : TEXT("off"));
+			return;
+		}
+
+		if (arguments[0] == TEXT("start")) {
+			trace_recorder_start();
+			UE_LOG(Log_CD_Core, Log, TEXT("Trace recording started."));
+		} else if (arguments[0] == TEXT("stop")) {
+			trace_recorder_stop();
+			UE_LOG(Log_CD_Core, Log, TEXT("Trace recording stopped."));
+		} else if (arguments[0] == TEXT("dump")) {
+			trace_recorder_stop();
+
+			FString file_name = arguments.Num() > 1 ? arguments[1] : TEXT("cd_trace.json");
+			FString path 	  = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / file_name);
+			if (trace_recorder_write_chrome_json(TCHAR_TO_UTF8(*path))) {
+				UE_LOG(Log_CD_Core, Log, TEXT("Trace written to %s."), *path);
+			} else {
+				UE_LOG(Log_CD_Core, Warning, TEXT("Couldn't write trace to %s."), *path);
+			}
+		}
+	}
+
+	FAutoConsoleCommand trace_console_command(
+		TEXT("cd.trace"),
+		TEXT("Scoped timing events. \"start\" starts recording, \"stop\" stops it, \"dump [file]\" stops and writes Chrome trace JSON to Saved folder."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&trace_command));
+}
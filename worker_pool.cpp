@@ -0,0 +1,134 @@
+#include "worker_pool.h"
+#include "trace_recorder.h"
+
+#include <string>
+
+namespace {
+	// So tasks pushed from a worker go to its own deque.
+	thread_local Worker_Pool 	*this_thread_pool 	= nullptr;
+	thread_local int 			this_thread_queue 	= -1;
+
+	bool pop_own_task(Worker_Queue *queue, std::function<void()> *task) {
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (queue->tasks.empty()) {
+			return false;
+		}
+		*task = std::move(queue->tasks.back());
+		queue->tasks.pop_back();
+		return true;
+	}
+
+	bool steal_task(Worker_Queue *queue, std::function<void()> *task) {
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		if (queue->tasks.empty()) {
+			return false;
+		}
+		*task = std::move(queue->tasks.front());
+		queue->tasks.pop_front();
+		return true;
+	}
+
+	bool find_task(Worker_Pool *pool, int queue_index, std::function<void()> *task) {
+		if (pop_own_task(pool->queues[queue_index].get(), task)) {
+			return true;
+		}
+
+		int queue_count = (int)pool->queues.size();
+		for (int i = 1; i < queue_count; ++i) {
+			if (steal_task(pool->queues[(queue_index + i) % queue_count].get(), task)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void worker_loop(Worker_Pool *pool, int queue_index, std::string thread_name) {
+		this_thread_pool 	= pool;
+		this_thread_queue 	= queue_index;
+		trace_recorder_set_thread_name(thread_name.c_str());
+
+		std::function<void()> task;
+		while (true) {
+			if (find_task(pool, queue_index, &task)) {
+				--pool->queued_count;
+				task();
+				task = nullptr;
+
+				if (--pool->unfinished_count == 0) {
+					std::lock_guard<std::mutex> lock(pool->sleep_mutex);
+					pool->became_idle.notify_all();
+				}
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(pool->sleep_mutex);
+			pool->wake_up.wait(lock, [pool] { return pool->stopping || pool->queued_count.load() > 0; });
+			if (pool->stopping && pool->queued_count.load() == 0) {
+				return;
+			}
+		}
+	}
+}
+
+void worker_pool_start(Worker_Pool *pool, int worker_count, const char *thread_name) {
+	if (worker_count <= 0) {
+		worker_count = (int)std::thread::hardware_concurrency() - 1;
+		if (worker_count < 1) {
+			worker_count = 1;
+		}
+	}
+
+	pool->stopping = false;
+	pool->queues.clear();
+	for (int i = 0; i < worker_count; ++i) {
+		pool->queues.push_back(std::unique_ptr<Worker_Queue>(new Worker_Queue()));
+	}
+	for (int i = 0; i < worker_count; ++i) {
+		pool->threads.push_back(std::thread(worker_loop, pool, i, std::string(thread_name) + " " + std::to_string(i + 1)));
+	}
+}
+
+void worker_pool_stop(Worker_Pool *pool) {
+	{
+		std::lock_guard<std::mutex> lock(pool->sleep_mutex);
+		pool->stopping = true;
+	}
+	pool->wake_up.notify_all();
+
+	for (std::thread &thread : pool->threads) {
+		thread.join();
+	}
+	pool->threads.clear();
+	pool->queues.clear();
+}
+
+bool worker_pool_running(const Worker_Pool &pool) {
+	return !pool.threads.empty();
+}
+
+bool worker_pool_push(Worker_Pool *pool, std::function<void()> task) {
+	if (pool->queues.empty()) {
+		return false; // Stopped or never started.
+	}
+
+	int queue_index = this_thread_pool == pool ? this_thread_queue : (int)(pool->next_queue++ % pool->queues.size());
+
+	++pool->unfinished_count;
+	{
+		Worker_Queue *queue = pool->queues[queue_index].get();
+		std::lock_guard<std::mutex> lock(queue->mutex);
+		queue->tasks.push_back(std::move(task));
+	}
+	{
+		// Under sleep mutex, so worker can't check for work and fall asleep in between.
+		std::lock_guard<std::mutex> lock(pool->sleep_mutex);
+		++pool->queued_count;
+	}
+	pool->wake_up.notify_one();
+	return true;
+}
+
+void worker_pool_wait_idle(Worker_Pool *pool) {
+	std::unique_lock<std::mutex> lock(pool->sleep_mutex);
+	pool->became_idle.wait(lock, [pool] { return pool->unfinished_count.load() == 0; });
+}
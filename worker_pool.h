@@ -0,0 +1,51 @@
+#pragma once
+
+// Worker threads with work stealing. Every worker has its own task deque: it takes newest tasks from its own
+// deque and, when it's empty, steals oldest tasks from other workers. Tasks pushed from outside are spread
+// round robin, tasks pushed from a worker go to that worker's deque.
+//
+// @note: Deques are locked, but every worker has its own lock, so workers only meet when somebody steals.
+// We have tens of tasks, each a whole path search, lock free deque wouldn't show up anywhere.
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Worker_Queue {
+	std::mutex 							mutex;
+	std::deque<std::function<void()>> 	tasks;
+};
+
+struct Worker_Pool {
+	std::vector<std::thread> 					threads;
+	std::vector<std::unique_ptr<Worker_Queue>> 	queues; // One per worker.
+
+	// Workers sleep on this when there is nothing to do or steal.
+	std::mutex 				sleep_mutex;
+	std::condition_variable wake_up;
+	std::condition_variable became_idle;
+
+	std::atomic<int> 		queued_count 	{0}; // Pushed, but nobody took them yet.
+	std::atomic<int> 		unfinished_count{0}; // Queued and running.
+	std::atomic<uint32_t> 	next_queue 		{0};
+	bool 					stopping 		= false;
+};
+
+// Zero workers means one less than hardware threads (game thread is busy too), but at least one.
+void worker_pool_start(Worker_Pool *pool, int worker_count, const char *thread_name);
+
+// Runs what is already queued and joins the workers.
+void worker_pool_stop(Worker_Pool *pool);
+
+bool worker_pool_running(const Worker_Pool &pool);
+
+// False if the pool isn't running, task is dropped then.
+bool worker_pool_push(Worker_Pool *pool, std::function<void()> task);
+
+// Blocks until every pushed task has finished.
+void worker_pool_wait_idle(Worker_Pool *pool);
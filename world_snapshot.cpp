@@ -0,0 +1,311 @@
+#include "world_snapshot.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <type_traits>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+// Record sizes are part of the format, padding is written out so it's the same everywhere.
+static_assert(sizeof(Vec3) == 12 && sizeof(Quat) == 16, "Snapshot records store math types as they are.");
+static_assert(sizeof(Snapshot_Player) == 88, "Snapshot_Player changed, bump world_snapshot_version.");
+static_assert(sizeof(Snapshot_Pawn) == 88, "Snapshot_Pawn changed, bump world_snapshot_version.");
+static_assert(sizeof(Snapshot_Path) == 64, "Snapshot_Path changed, bump world_snapshot_version.");
+static_assert(sizeof(Snapshot_Path_Jump) == 8, "Snapshot_Path_Jump changed, bump world_snapshot_version.");
+static_assert(sizeof(Snapshot_Objective) == 24, "Snapshot_Objective changed, bump world_snapshot_version.");
+static_assert(sizeof(Snapshot_Prop) == 64, "Snapshot_Prop changed, bump world_snapshot_version.");
+static_assert(std::is_trivially_copyable<Snapshot_Pawn>::value && std::is_trivially_copyable<Snapshot_Prop>::value, "Records are read in place.");
+
+namespace {
+	const uint64_t section_alignment = 16;
+
+	uint64_t align_up(uint64_t value) {
+		return (value + section_alignment - 1) & ~(section_alignment - 1);
+	}
+
+	struct Section_Source {
+		const void 	*data;
+		size_t 		count;
+		size_t 		record_size;
+	};
+
+	// Section is in the bytes and its records are what we think they are.
+	bool section_is_valid(const World_Snapshot_Header &header, int type, size_t record_size, size_t size) {
+		const World_Snapshot_Section &section = header.sections[type];
+		if (section.count == 0) {
+			return true;
+		}
+		return section.record_size == record_size
+			&& section.offset % section_alignment == 0
+			&& section.offset >= sizeof(World_Snapshot_Header)
+			&& section.offset <= size
+			&& (uint64_t)section.count * record_size <= size - section.offset;
+	}
+
+	template <typename T>
+	const T *section_records(const uint8_t *bytes, const World_Snapshot_Header &header, int type, int *out_count) {
+		const World_Snapshot_Section &section = header.sections[type];
+		*out_count = (int)section.count;
+		return section.count ? (const T *)(bytes + section.offset) : nullptr;
+	}
+
+	bool range_is_valid(uint32_t first, uint32_t count, int total) {
+		return (uint64_t)first + count <= (uint64_t)total;
+	}
+}
+
+Snapshot_Path *world_snapshot_add_path(World_Snapshot *snapshot, const Vec3 *points, int point_count, const Vec3 *goal_points, int goal_point_count,
+	const Snapshot_Path_Jump *jumps, int jump_count) {
+	Snapshot_Path path;
+	path.first_point 		= (uint32_t)snapshot->path_points.size();
+	path.point_count 		= (uint32_t)point_count;
+	snapshot->path_points.insert(snapshot->path_points.end(), points, points + point_count);
+
+	path.first_goal_point 	= (uint32_t)snapshot->path_points.size();
+	path.goal_point_count 	= (uint32_t)goal_point_count;
+	snapshot->path_points.insert(snapshot->path_points.end(), goal_points, goal_points + goal_point_count);
+
+	path.first_jump 		= (uint32_t)snapshot->path_jumps.size();
+	path.jump_count 		= (uint32_t)jump_count;
+	snapshot->path_jumps.insert(snapshot->path_jumps.end(), jumps, jumps + jump_count);
+
+	snapshot->paths.push_back(path);
+	return &snapshot->paths.back();
+}
+
+void world_snapshot_serialize(const World_Snapshot &snapshot, std::vector<uint8_t> *out_bytes) {
+	Section_Source sources[WORLD_SNAPSHOT_SECTION_COUNT];
+	sources[WORLD_SNAPSHOT_PLAYER] 		= {&snapshot.player, snapshot.has_player ? 1u : 0u, sizeof(Snapshot_Player)};
+	sources[WORLD_SNAPSHOT_PAWNS] 		= {snapshot.pawns.data(), snapshot.pawns.size(), sizeof(Snapshot_Pawn)};
+	sources[WORLD_SNAPSHOT_PATHS] 		= {snapshot.paths.data(), snapshot.paths.size(), sizeof(Snapshot_Path)};
+	sources[WORLD_SNAPSHOT_PATH_POINTS] = {snapshot.path_points.data(), snapshot.path_points.size(), sizeof(Vec3)};
+	sources[WORLD_SNAPSHOT_PATH_JUMPS] 	= {snapshot.path_jumps.data(), snapshot.path_jumps.size(), sizeof(Snapshot_Path_Jump)};
+	sources[WORLD_SNAPSHOT_OBJECTIVES] 	= {snapshot.objectives.data(), snapshot.objectives.size(), sizeof(Snapshot_Objective)};
+	sources[WORLD_SNAPSHOT_PROPS] 		= {snapshot.props.data(), snapshot.props.size(), sizeof(Snapshot_Prop)};
+
+	World_Snapshot_Header header;
+	header.step = snapshot.step;
+	header.seed = snapshot.seed;
+
+	uint64_t offset = sizeof(World_Snapshot_Header);
+	for (int i = 0; i < WORLD_SNAPSHOT_SECTION_COUNT; ++i) {
+		offset = align_up(offset);
+		header.sections[i].offset 		= offset;
+		header.sections[i].count 		= (uint32_t)sources[i].count;
+		header.sections[i].record_size 	= (uint32_t)sources[i].record_size;
+		offset += sources[i].count * sources[i].record_size;
+	}
+	header.file_size = offset;
+
+	// Gaps between sections are zeros.
+	out_bytes->assign((size_t)offset, 0);
+	memcpy(out_bytes->data(), &header, sizeof(header));
+	for (int i = 0; i < WORLD_SNAPSHOT_SECTION_COUNT; ++i) {
+		if (sources[i].count) {
+			memcpy(out_bytes->data() + header.sections[i].offset, sources[i].data, sources[i].count * sources[i].record_size);
+		}
+	}
+}
+
+bool world_snapshot_write(const World_Snapshot &snapshot, const std::string &path) {
+	std::vector<uint8_t> bytes;
+	world_snapshot_serialize(snapshot, &bytes);
+
+	// Written next to it and renamed, so a crash while saving doesn't leave half a checkpoint.
+	std::string temporary_path = path + ".tmp";
+	FILE *file = fopen(temporary_path.c_str(), "wb");
+	if (!file) {
+		return false;
+	}
+	bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+	written = fclose(file) == 0 && written;
+	if (!written) {
+		remove(temporary_path.c_str());
+		return false;
+	}
+
+#if defined(_WIN32)
+	return MoveFileExA(temporary_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	return rename(temporary_path.c_str(), path.c_str()) == 0;
+#endif
+}
+
+bool world_snapshot_view(const void *bytes, size_t size, World_Snapshot_View *out_view) {
+	*out_view = World_Snapshot_View();
+
+	const uint8_t *data = (const uint8_t *)bytes;
+	if (size < sizeof(World_Snapshot_Header)) {
+		out_view->error = "File is smaller than snapshot header.";
+		return false;
+	}
+	if ((uintptr_t)data % section_alignment != 0) {
+		out_view->error = "Snapshot bytes are not 16 byte aligned.";
+		return false;
+	}
+
+	const World_Snapshot_Header &header = *(const World_Snapshot_Header *)data;
+	if (header.magic != world_snapshot_magic) {
+		out_view->error = "Not a world snapshot.";
+		return false;
+	}
+	if (header.byte_order != 0x01020304) {
+		out_view->error = "Snapshot was written with other byte order.";
+		return false;
+	}
+	if (header.version != world_snapshot_version || header.header_size != sizeof(World_Snapshot_Header)) {
+		out_view->error = "Snapshot is of other version.";
+		return false;
+	}
+	if (header.file_size != size) {
+		out_view->error = "Snapshot file is cut or has something after it.";
+		return false;
+	}
+
+	size_t record_sizes[WORLD_SNAPSHOT_SECTION_COUNT] = {
+		sizeof(Snapshot_Player), sizeof(Snapshot_Pawn), sizeof(Snapshot_Path), sizeof(Vec3),
+		sizeof(Snapshot_Path_Jump), sizeof(Snapshot_Objective), sizeof(Snapshot_Prop),
+	};
+	for (int i = 0; i < WORLD_SNAPSHOT_SECTION_COUNT; ++i) {
+		if (!section_is_valid(header, i, record_sizes[i], size)) {
+			out_view->error = "Snapshot section is outside of the file or has other record size.";
+			return false;
+		}
+	}
+	if (header.sections[WORLD_SNAPSHOT_PLAYER].count > 1) {
+		out_view->error = "Snapshot has more than one player.";
+		return false;
+	}
+
+	World_Snapshot_View view;
+	int player_count;
+	view.header 		= &header;
+	view.player 		= section_records<Snapshot_Player>(data, header, WORLD_SNAPSHOT_PLAYER, &player_count);
+	view.pawns 			= section_records<Snapshot_Pawn>(data, header, WORLD_SNAPSHOT_PAWNS, &view.pawn_count);
+	view.paths 			= section_records<Snapshot_Path>(data, header, WORLD_SNAPSHOT_PATHS, &view.path_count);
+	view.path_points 	= section_records<Vec3>(data, header, WORLD_SNAPSHOT_PATH_POINTS, &view.path_point_count);
+	view.path_jumps 	= section_records<Snapshot_Path_Jump>(data, header, WORLD_SNAPSHOT_PATH_JUMPS, &view.path_jump_count);
+	view.objectives 	= section_records<Snapshot_Objective>(data, header, WORLD_SNAPSHOT_OBJECTIVES, &view.objective_count);
+	view.props 			= section_records<Snapshot_Prop>(data, header, WORLD_SNAPSHOT_PROPS, &view.prop_count);
+
+	// Paths index other sections, bad index would read outside of the file.
+	for (int i = 0; i < view.path_count; ++i) {
+		const Snapshot_Path &path = view.paths[i];
+		if (!range_is_valid(path.first_point, path.point_count, view.path_point_count)
+			|| !range_is_valid(path.first_goal_point, path.goal_point_count, view.path_point_count)
+			|| !range_is_valid(path.first_jump, path.jump_count, view.path_jump_count)) {
+			out_view->error = "Snapshot path points outside of path points.";
+			return false;
+		}
+	}
+
+	*out_view = view;
+	return true;
+}
+
+const Snapshot_Pawn *world_snapshot_find_pawn(const World_Snapshot_View &view, uint64_t id) {
+	for (int i = 0; i < view.pawn_count; ++i) {
+		if (view.pawns[i].id == id) {
+			return &view.pawns[i];
+		}
+	}
+	return nullptr;
+}
+
+const Snapshot_Path *world_snapshot_find_path(const World_Snapshot_View &view, uint64_t pawn_id) {
+	for (int i = 0; i < view.path_count; ++i) {
+		if (view.paths[i].pawn_id == pawn_id) {
+			return &view.paths[i];
+		}
+	}
+	return nullptr;
+}
+
+bool world_snapshot_open(World_Snapshot_File *file, const std::string &path) {
+	*file = World_Snapshot_File();
+
+#if defined(_WIN32)
+	HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (handle == INVALID_HANDLE_VALUE) {
+		file->view.error = "Can't open snapshot file.";
+		return false;
+	}
+	file->handle = (intptr_t)handle;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+		world_snapshot_close(file);
+		file->view.error = "Snapshot file is empty.";
+		return false;
+	}
+	file->size = (size_t)size.QuadPart;
+
+	file->mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	file->data 	= file->mapping ? (const uint8_t *)MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#else
+	int descriptor = open(path.c_str(), O_RDONLY);
+	if (descriptor < 0) {
+		file->view.error = "Can't open snapshot file.";
+		return false;
+	}
+	file->handle = descriptor;
+
+	struct stat status;
+	if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+		world_snapshot_close(file);
+		file->view.error = "Snapshot file is empty.";
+		return false;
+	}
+	file->size = (size_t)status.st_size;
+
+	void *mapped = mmap(nullptr, file->size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+	file->data = mapped != MAP_FAILED ? (const uint8_t *)mapped : nullptr;
+#endif
+
+	if (!file->data) {
+		world_snapshot_close(file);
+		file->view.error = "Can't map snapshot file.";
+		return false;
+	}
+
+	// Mapping starts at a page, so sections are aligned.
+	if (!world_snapshot_view(file->data, file->size, &file->view)) {
+		const char *error = file->view.error;
+		world_snapshot_close(file);
+		file->view.error = error;
+		return false;
+	}
+	return true;
+}
+
+void world_snapshot_close(World_Snapshot_File *file) {
+#if defined(_WIN32)
+	if (file->data) {
+		UnmapViewOfFile(file->data);
+	}
+	if (file->mapping) {
+		CloseHandle(file->mapping);
+	}
+	if (file->handle != -1) {
+		CloseHandle((HANDLE)file->handle);
+	}
+#else
+	if (file->data) {
+		munmap((void *)file->data, file->size);
+	}
+	if (file->handle != -1) {
+		close((int)file->handle);
+	}
+#endif
+
+	*file = World_Snapshot_File();
+}
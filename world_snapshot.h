@@ -0,0 +1,190 @@
+#pragma once
+
+// World snapshot: player, bots with their path state and props, in one binary file.
+// It's for checkpoints and for benchmarks and tests that start in the middle of a game instead of playing there.
+//
+// 	World_Snapshot snapshot; 	... fill ...; world_snapshot_write(snapshot, path);
+//
+// 	World_Snapshot_File file;
+// 	if (world_snapshot_open(&file, path)) { file.view.pawns[i] ... } 	// Points into the mapped file.
+// 	world_snapshot_close(&file);
+//
+// File is header and sections of fixed size records, every section starts at 16 bytes. Loading maps the file
+// and checks the header, records are read where they are, nothing is parsed or copied. Records are plain
+// structs with explicit padding, little endian, so file is the same on every machine we ship to.
+//
+// Version is in the header with size of every record. Changing any record means new version, files of
+// other versions are refused, not guessed at. Snapshots are fixtures, we make them again.
+//
+// @note: Rewind history (A_Player state_array) and path searches still running on planner workers are not
+// saved, after load bots ask for paths again where they had none.
+
+#include "cd_math.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+const uint32_t world_snapshot_magic 	= 0x53574443; // "CDWS".
+const uint32_t world_snapshot_version 	= 1;
+
+enum World_Snapshot_Section_Type {
+	WORLD_SNAPSHOT_PLAYER,
+	WORLD_SNAPSHOT_PAWNS,
+	WORLD_SNAPSHOT_PATHS,
+	WORLD_SNAPSHOT_PATH_POINTS, // Vec3, paths point into it.
+	WORLD_SNAPSHOT_PATH_JUMPS,
+	WORLD_SNAPSHOT_OBJECTIVES,
+	WORLD_SNAPSHOT_PROPS,
+
+	WORLD_SNAPSHOT_SECTION_COUNT,
+};
+
+enum Snapshot_Flag : uint32_t {
+	SNAPSHOT_WALKING 		= 1 << 0,
+	SNAPSHOT_PATH_FOUND 	= 1 << 1,
+};
+
+struct Snapshot_Player {
+	uint64_t 	id 			= 0;
+	Vec3 		position;
+	Vec3 		velocity;
+	Vec3 		ground_normal;
+	uint32_t 	grounded 	= 0;
+	uint32_t 	flags 		= 0; // Snapshot_Flag.
+	Quat 		yaw; 	// Mouse look, see mouse_look.h.
+	Quat 		pitch;
+	uint32_t 	padding 	= 0;
+};
+
+struct Snapshot_Pawn {
+	uint64_t 	id 				= 0;
+	uint64_t 	random_state 	= 0;
+	Vec3 		position;
+	Vec3 		velocity;
+	Vec3 		ground_normal;
+	uint32_t 	grounded 		= 0;
+	float 		yaw 			= 0; // Degrees.
+	float 		pitch 			= 0;
+	uint32_t 	buttons 		= 0; // Movement_Button.
+	int32_t 	objective 		= 0; // Index in objectives.
+	int32_t 	lod_tier 		= 0; // AI_Lod_State.
+	int32_t 	lod_phase 		= 0;
+	float 		lod_accumulated_dt = 0;
+	uint32_t 	flags 			= 0; // Snapshot_Flag.
+};
+
+// Path a pawn follows, every bot has its own. Older snapshots of game have one path with pawn_id 0 all bots took.
+struct Snapshot_Path {
+	uint64_t 	pawn_id 			= 0;
+	uint32_t 	first_point 		= 0; // Path points.
+	uint32_t 	point_count 		= 0;
+	uint32_t 	first_goal_point 	= 0; // Points of search from goal, Path_Search::goal_points.
+	uint32_t 	goal_point_count 	= 0;
+	uint32_t 	first_jump 			= 0;
+	uint32_t 	jump_count 			= 0;
+	int32_t 	target_point 		= 1;
+	uint32_t 	flags 				= 0; // Snapshot_Flag.
+	Vec3 		goal;
+	float 		retry_time_left 	= 0;
+	float 		stuck_time_left 	= 0;
+	float 		jump_hold_time_left = 0;
+};
+
+struct Snapshot_Path_Jump {
+	int32_t 	path_point_index 	= 0;
+	float 		hold_time 			= 0;
+};
+
+struct Snapshot_Objective {
+	Vec3 position;
+	Vec3 target;
+};
+
+// Movable things bots see as dynamic obstacles.
+struct Snapshot_Prop {
+	uint64_t 	id = 0; // determinism_id_from_name() of owner and component names.
+	Vec3 		position;
+	Quat 		rotation;
+	Vec3 		linear_velocity;
+	Vec3 		angular_velocity; // Degrees per second.
+	uint32_t 	padding = 0;
+};
+
+struct World_Snapshot_Section {
+	uint64_t offset 		= 0;
+	uint32_t count 			= 0;
+	uint32_t record_size 	= 0;
+};
+
+struct World_Snapshot_Header {
+	uint32_t 	magic 		= world_snapshot_magic;
+	uint32_t 	version 	= world_snapshot_version;
+	uint32_t 	header_size = sizeof(World_Snapshot_Header);
+	uint32_t 	byte_order 	= 0x01020304;
+	uint64_t 	file_size 	= 0;
+	uint64_t 	step 		= 0; // Fixed step it was saved after.
+	uint64_t 	seed 		= 0; // Determinism seed of the run.
+	World_Snapshot_Section sections[WORLD_SNAPSHOT_SECTION_COUNT];
+};
+
+// What we save, owns its arrays.
+struct World_Snapshot {
+	uint64_t 	step = 0;
+	uint64_t 	seed = 0;
+	bool 		has_player = false;
+	Snapshot_Player 				player;
+	std::vector<Snapshot_Pawn> 		pawns;
+	std::vector<Snapshot_Path> 		paths;
+	std::vector<Vec3> 				path_points;
+	std::vector<Snapshot_Path_Jump> path_jumps;
+	std::vector<Snapshot_Objective> objectives;
+	std::vector<Snapshot_Prop> 		props;
+};
+
+// Adds path points and jumps and returns the path record, pawn_id and the rest is filled by caller.
+Snapshot_Path *world_snapshot_add_path(World_Snapshot *snapshot, const Vec3 *points, int point_count, const Vec3 *goal_points, int goal_point_count,
+	const Snapshot_Path_Jump *jumps, int jump_count);
+
+void world_snapshot_serialize(const World_Snapshot &snapshot, std::vector<uint8_t> *out_bytes);
+bool world_snapshot_write(const World_Snapshot &snapshot, const std::string &path);
+
+// What we load, points into bytes it was made from.
+struct World_Snapshot_View {
+	const World_Snapshot_Header *header 	= nullptr;
+	const Snapshot_Player 		*player 	= nullptr; // Null if there was none.
+	const Snapshot_Pawn 		*pawns 		= nullptr;
+	const Snapshot_Path 		*paths 		= nullptr;
+	const Vec3 					*path_points = nullptr;
+	const Snapshot_Path_Jump 	*path_jumps = nullptr;
+	const Snapshot_Objective 	*objectives = nullptr;
+	const Snapshot_Prop 		*props 		= nullptr;
+	int pawn_count 			= 0;
+	int path_count 			= 0;
+	int path_point_count 	= 0;
+	int path_jump_count 	= 0;
+	int objective_count 	= 0;
+	int prop_count 			= 0;
+
+	const char *error = nullptr; // Why it wasn't loaded.
+};
+
+// Bytes must be 16 byte aligned and stay alive while the view is used. Checks header and that every section and
+// every path's points are inside the bytes, records themselves are not checked.
+bool world_snapshot_view(const void *bytes, size_t size, World_Snapshot_View *out_view);
+
+const Snapshot_Pawn *world_snapshot_find_pawn(const World_Snapshot_View &view, uint64_t id);
+const Snapshot_Path *world_snapshot_find_path(const World_Snapshot_View &view, uint64_t pawn_id);
+
+// Snapshot file mapped into memory.
+struct World_Snapshot_File {
+	const uint8_t 		*data 		= nullptr;
+	size_t 				size 		= 0;
+	intptr_t 			handle 		= -1; 		// File descriptor or HANDLE.
+	void 				*mapping 	= nullptr; 	// File mapping HANDLE on Windows.
+	World_Snapshot_View view;
+};
+
+bool world_snapshot_open(World_Snapshot_File *file, const std::string &path);
+void world_snapshot_close(World_Snapshot_File *file);